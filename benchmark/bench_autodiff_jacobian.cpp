@@ -0,0 +1,90 @@
+#include <cmath>
+#include <cstdio>
+#include <Eigen/Dense>
+#include <autodiff_model.h>
+#include "benchmark_util.h"
+
+// Cost of evaluating a coordinated-turn model together with its Jacobian:
+// value only, hand-written Jacobian, forward-mode dual numbers with fixed
+// and dynamic derivative storage, and central differences.
+struct CoordinatedTurn {
+    double dt;
+    template <typename T>
+    Eigen::Matrix<T, 5, 1> operator()(const Eigen::Matrix<T, 5, 1>& s) const {
+        using std::cos;
+        using std::sin;
+        Eigen::Matrix<T, 5, 1> next;
+        next << s(0) + dt * s(2) * cos(s(3)),
+                s(1) + dt * s(2) * sin(s(3)),
+                s(2),
+                s(3) + dt * s(4),
+                s(4);
+        return next;
+    }
+};
+
+// Same model on dynamic vectors, for Eigen::Dynamic derivatives
+struct DynamicCoordinatedTurn {
+    double dt;
+    template <typename T>
+    Eigen::Matrix<T, Eigen::Dynamic, 1> operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& s) const {
+        Eigen::Matrix<T, 5, 1> fixed = s;
+        return CoordinatedTurn{dt}(fixed);
+    }
+};
+
+int main() {
+    const long iterations = 1000000;
+    const double dt = 0.1;
+    CoordinatedTurn model{dt};
+    Eigen::Matrix<double, 5, 1> s;
+    s << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::Matrix<double, 5, 1> value;
+    Eigen::Matrix<double, 5, 5> J;
+
+    double ns = nanosecondsPerIteration(iterations, [&] {
+        value = model(s);
+        doNotOptimize(value);
+    });
+    report("value only", ns);
+
+    ns = nanosecondsPerIteration(iterations, [&] {
+        value = model(s);
+        J.setIdentity();
+        J(0, 2) = dt * std::cos(s(3));
+        J(0, 3) = -dt * s(2) * std::sin(s(3));
+        J(1, 2) = dt * std::sin(s(3));
+        J(1, 3) = dt * s(2) * std::cos(s(3));
+        J(3, 4) = dt;
+        doNotOptimize(J);
+    });
+    report("value + hand-written Jacobian", ns);
+
+    AutoDiffModel<5, 5, CoordinatedTurn> fixed(model);
+    ns = nanosecondsPerIteration(iterations, [&] {
+        fixed.linearize(s, value, J);
+        doNotOptimize(J);
+    });
+    report("value + Jacobian, dual numbers, fixed size", ns);
+
+    AutoDiffModel<Eigen::Dynamic, Eigen::Dynamic, DynamicCoordinatedTurn> dynamic(DynamicCoordinatedTurn{dt});
+    Eigen::VectorXd sd = s, vd;
+    Eigen::MatrixXd Jd;
+    ns = nanosecondsPerIteration(iterations / 10, [&] {
+        dynamic.linearize(sd, vd, Jd);
+        doNotOptimize(Jd);
+    });
+    report("value + Jacobian, dual numbers, dynamic size", ns);
+
+    ns = nanosecondsPerIteration(iterations, [&] {
+        value = model(s);
+        for (int i = 0; i < 5; ++i) {
+            Eigen::Matrix<double, 5, 1> step = Eigen::Matrix<double, 5, 1>::Unit(i) * 1e-6;
+            J.col(i) = (model(Eigen::Matrix<double, 5, 1>(s + step)) -
+                        model(Eigen::Matrix<double, 5, 1>(s - step))) / 2e-6;
+        }
+        doNotOptimize(J);
+    });
+    report("value + Jacobian, central differences", ns);
+    return 0;
+}
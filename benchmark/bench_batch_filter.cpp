@@ -0,0 +1,37 @@
+#include <cstdio>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include "benchmark_util.h"
+
+// Per-step cost of replaying a recorded series through the stepwise
+// predict()/update()/state() loop and through the batch filter() call.
+int main() {
+    const int steps = 100000;
+    const int sizes[][2] = {{2, 1}, {4, 2}, {12, 6}};
+    for (const auto& size : sizes) {
+        Eigen::MatrixXd Y = Eigen::MatrixXd::Random(size[1], steps);
+        Eigen::MatrixXd means(size[0], steps);
+        char name[96];
+
+        KalmanFilter stepwise = makeKalmanFilter(size[0], size[1], {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        double ns = nanosecondsPerIteration(1, [&] {
+            for (int k = 0; k < steps; ++k) {
+                stepwise.predict();
+                stepwise.update(Y.col(k));
+                means.col(k) = stepwise.state();
+            }
+        });
+        doNotOptimize(means);
+        std::snprintf(name, sizeof(name), "n=%d m=%d stepwise loop", size[0], size[1]);
+        report(name, ns / steps);
+
+        KalmanFilter batch = makeKalmanFilter(size[0], size[1], {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        ns = nanosecondsPerIteration(1, [&] {
+            batch.filter(Y, means);
+        });
+        doNotOptimize(means);
+        std::snprintf(name, sizeof(name), "n=%d m=%d batch filter()", size[0], size[1]);
+        report(name, ns / steps);
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <Eigen/Dense>
+#include <checkpoint.h>
+#include <kalman_filter.h>
+#include "benchmark_util.h"
+
+// Checkpoint cost for a fleet of filters: a full snapshot, an incremental
+// snapshot of 1% dirty filters, and the takeover path of opening the file
+// and restoring every filter, compared with replaying measurements.
+static KalmanFilter makeFilter() {
+    const int n = 6, m = 3;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(n, n);
+    A.topRightCorner(3, 3).diagonal().setConstant(0.1);
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(m, n);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(m, m);
+    KalmanFilter kf(0.1, A, C, Q, R, Eigen::MatrixXd::Identity(n, n));
+    kf.init(Eigen::VectorXd::Zero(n));
+    kf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    return kf;
+}
+
+int main() {
+    const int filters = 10000;
+    const std::string path = "bench_checkpoint.bin";
+    std::remove(path.c_str());
+    std::vector<KalmanFilter> fleet(filters, makeFilter());
+    Eigen::VectorXd z = Eigen::VectorXd::Ones(3);
+    char name[96];
+
+    double ns = nanosecondsPerIteration(filters, [&] {
+        KalmanFilter& kf = fleet[0];
+        kf.predict();
+        kf.update(z);
+    });
+    report("replay, per filter and measurement", ns);
+    std::snprintf(name, sizeof(name), "replay of 1 h at 10 Hz, %d filters", filters);
+    report(name, ns * 36000 * filters);
+
+    CheckpointWriter writer(path);
+    ns = nanosecondsPerIteration(1, [&] {
+        for (int i = 0; i < filters; ++i) {
+            writer.write(i, fleet[i]);
+        }
+        writer.commit();
+    });
+    std::snprintf(name, sizeof(name), "full checkpoint, %d filters", filters);
+    report(name, ns);
+
+    ns = nanosecondsPerIteration(10, [&] {
+        for (int i = 0; i < filters; i += 100) {
+            writer.write(i, fleet[i]);
+        }
+        writer.commit();
+    });
+    report("incremental checkpoint, 1% dirty", ns);
+
+    ns = nanosecondsPerIteration(1, [&] {
+        CheckpointReader reader(path);
+        for (long id : reader.ids()) {
+            reader.restore(id, fleet[id]);
+        }
+    });
+    doNotOptimize(fleet);
+    std::snprintf(name, sizeof(name), "open and restore %d filters", filters);
+    report(name, ns);
+
+    std::remove(path.c_str());
+    return 0;
+}
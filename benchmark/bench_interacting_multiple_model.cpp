@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+#include <interacting_multiple_model.h>
+#include <kalman_filter.h>
+#include <thread_pool.h>
+#include "benchmark_util.h"
+
+// Per-step cost of an IMM over M constant-velocity models that differ in
+// process noise, serially and with the models spread over a pool. The
+// transition matrix is banded (each model switches to its neighbours), so
+// the cost per model should stay flat as M grows.
+static std::unique_ptr<BaseKalmanFilter> makeModel(double q) {
+    const int n = 6, m = 3;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(n, n);
+    A.topRightCorner(3, 3).diagonal().setConstant(0.1);
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(m, n);
+    Eigen::MatrixXd Q = q * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(m, m);
+    auto kf = std::make_unique<KalmanFilter>(0.1, A, C, Q, R, Eigen::MatrixXd::Identity(n, n));
+    kf->init(Eigen::VectorXd::Zero(n));
+    kf->setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    return kf;
+}
+
+static InteractingMultipleModel makeImm(int M) {
+    std::vector<std::unique_ptr<BaseKalmanFilter>> models;
+    for (int j = 0; j < M; ++j) {
+        models.push_back(makeModel(1e-4 * (j + 1)));
+    }
+    Eigen::MatrixXd transition = Eigen::MatrixXd::Zero(M, M);
+    for (int j = 0; j < M; ++j) {
+        transition(j, j) += 0.9;
+        transition(j, (j + 1) % M) += 0.05;
+        transition(j, (j + M - 1) % M) += 0.05;
+    }
+    return InteractingMultipleModel(std::move(models), transition, Eigen::VectorXd::Constant(M, 1.0 / M));
+}
+
+int main() {
+    const int steps = 2000;
+    Eigen::MatrixXd Z = Eigen::MatrixXd::Random(3, steps);
+    Eigen::VectorXd z(3);
+    ThreadPool pool(4);
+    char name[96];
+
+    for (int M : {2, 4, 8, 16, 32}) {
+        for (bool parallel : {false, true}) {
+            InteractingMultipleModel imm = makeImm(M);
+            if (parallel) {
+                imm.setThreadPool(&pool);
+            }
+            int k = 0;
+            double ns = nanosecondsPerIteration(steps, [&] {
+                z = Z.col(k++ % steps);
+                imm.predict();
+                imm.update(z);
+            });
+            doNotOptimize(imm.state());
+            std::snprintf(name, sizeof(name), "M=%2d %s step", M, parallel ? "pool(4)" : "serial ");
+            report(name, ns);
+            std::snprintf(name, sizeof(name), "M=%2d %s per model", M, parallel ? "pool(4)" : "serial ");
+            report(name, ns / M);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <kalman_filter_bank.h>
+#include "benchmark_util.h"
+
+// 50k constant velocity tracks observed in position, stepped as a loop
+// over KalmanFilter objects and as one KalmanFilterBank.
+int main() {
+    const int num_filters = 50000;
+    const int steps = 10;
+    const double dt = 0.05;
+
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd P = Eigen::MatrixXd::Identity(4, 4);
+
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(num_filters, 2);
+    KalmanFilterBank::Mask half(num_filters);
+    for (int i = 0; i < num_filters; ++i) {
+        half(i) = (i / 1024) % 2 == 0;
+    }
+
+    std::vector<KalmanFilter> filters(num_filters, KalmanFilter(dt, A, C, Q, R, P));
+    for (auto& filter : filters) {
+        filter.init(Eigen::VectorXd::Zero(4));
+    }
+    double ns = nanosecondsPerIteration(steps, [&] {
+        for (int i = 0; i < num_filters; ++i) {
+            filters[i].predict();
+            filters[i].update(Y.row(i).transpose());
+        }
+    });
+    doNotOptimize(filters.back().state());
+    report("KalmanFilter loop, 50k tracks, per frame", ns);
+
+    KalmanFilterBank bank(num_filters, A, C, Q, R, P);
+    ns = nanosecondsPerIteration(steps, [&] {
+        bank.predict();
+        bank.update(Y);
+    });
+    doNotOptimize(bank.states());
+    report("KalmanFilterBank, 50k tracks, per frame", ns);
+
+    ns = nanosecondsPerIteration(steps, [&] {
+        bank.predict();
+        bank.update(Y, half);
+    });
+    doNotOptimize(bank.states());
+    report("KalmanFilterBank, 50k tracks, half measured", ns);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <kalman_filter_n.h>
+#include "benchmark_util.h"
+
+// Constant velocity (Nx = 4) and constant acceleration (Nx = 6) tracks in
+// two dimensions, both observing position only.
+template <int Nx>
+static Eigen::Matrix<double, Nx, Nx> transition(double dt) {
+    Eigen::Matrix<double, Nx, Nx> A = Eigen::Matrix<double, Nx, Nx>::Identity();
+    for (int i = 0; i + 2 < Nx; ++i) {
+        A(i, i + 2) = dt;
+    }
+    if (Nx == 6) {
+        A(0, 4) = A(1, 5) = 0.5 * dt * dt;
+    }
+    return A;
+}
+
+template <int Nx>
+static void run(const char* dynamic_name, const char* fixed_name, long steps) {
+    const double dt = 0.01;
+    using Fixed = KalmanFilterN<Nx, 2>;
+    typename Fixed::StateMatrix A = transition<Nx>(dt);
+    typename Fixed::MeasurementMatrix C = Fixed::MeasurementMatrix::Identity();
+    typename Fixed::StateMatrix Q = 1e-3 * Fixed::StateMatrix::Identity();
+    typename Fixed::MeasurementCovariance R = 0.1 * Fixed::MeasurementCovariance::Identity();
+    typename Fixed::StateMatrix P = Fixed::StateMatrix::Identity();
+
+    KalmanFilter dynamic(dt, A, C, Q, R, P);
+    dynamic.init(Eigen::VectorXd::Zero(Nx));
+    Eigen::VectorXd z_dynamic(2);
+    long k = 0;
+    double ns = nanosecondsPerIteration(steps, [&] {
+        z_dynamic << 0.01 * k, -0.01 * k;
+        ++k;
+        dynamic.predict();
+        dynamic.update(z_dynamic);
+    });
+    doNotOptimize(dynamic.state());
+    report(dynamic_name, ns);
+
+    Fixed fixed(A, C, Q, R, P);
+    fixed.init(Fixed::StateVector::Zero());
+    typename Fixed::MeasurementVector z_fixed;
+    k = 0;
+    ns = nanosecondsPerIteration(steps, [&] {
+        z_fixed << 0.01 * k, -0.01 * k;
+        ++k;
+        fixed.predict();
+        fixed.update(z_fixed);
+    });
+    doNotOptimize(fixed.state());
+    report(fixed_name, ns);
+}
+
+int main() {
+    const long steps = 1000000;
+    run<4>("KalmanFilter (4 states) predict+update", "KalmanFilterN<4, 2> predict+update", steps);
+    run<6>("KalmanFilter (6 states) predict+update", "KalmanFilterN<6, 2> predict+update", steps);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <thread>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <parallel_kalman_filter.h>
+#include <rts_smoother.h>
+#include <thread_pool.h>
+#include "benchmark_util.h"
+
+// Per-step cost of filtering and smoothing one long series sequentially
+// and with ParallelKalmanFilter over increasing thread counts.
+int main() {
+    const int steps = 200000;
+    const int n = 4, m = 2;
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Random(m, steps);
+    char name[96];
+
+    KalmanFilter kf = makeKalmanFilter(n, m, {GainSolver::LLT, CovarianceUpdate::Symmetric});
+    RtsSmoother smoother(kf.transitionMatrix());
+    smoother.reserve(n, steps);
+    double ns = nanosecondsPerIteration(1, [&] {
+        smoother.filter(kf, Y);
+        smoother.smooth();
+    });
+    doNotOptimize(smoother.states());
+    std::snprintf(name, sizeof(name), "n=%d m=%d sequential filter + RTS", n, m);
+    report(name, ns / steps);
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    for (int threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+        KalmanFilter model = makeKalmanFilter(n, m, {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        ParallelKalmanFilter parallel(model, pool);
+        ns = nanosecondsPerIteration(1, [&] {
+            parallel.filter(model.state(), model.covariance(), Y);
+            parallel.smooth();
+        });
+        doNotOptimize(parallel.states());
+        std::snprintf(name, sizeof(name), "n=%d m=%d parallel, %d threads", n, m, threads);
+        report(name, ns / steps);
+    }
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <cstdio>
+#include <vector>
+#include <Eigen/Dense>
+#include <fixed_lag_smoother.h>
+#include <kalman_filter.h>
+#include <rts_smoother.h>
+#include "benchmark_util.h"
+
+// Per-step cost of smoothing a long sequence: a naive two-pass smoother
+// keeping std::vectors of moments and inverting every predicted
+// covariance, RtsSmoother, and FixedLagSmoother with lag 10.
+int main() {
+    const int steps = 100000;
+    const int sizes[][2] = {{2, 1}, {4, 2}, {12, 6}};
+    for (const auto& size : sizes) {
+        Eigen::MatrixXd Y = Eigen::MatrixXd::Random(size[1], steps);
+        char name[96];
+
+        KalmanFilter naive_filter = makeKalmanFilter(size[0], size[1], {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        const Eigen::MatrixXd& A = naive_filter.transitionMatrix();
+        double ns = nanosecondsPerIteration(1, [&] {
+            std::vector<Eigen::VectorXd> xp, xf;
+            std::vector<Eigen::MatrixXd> Pp, Pf;
+            for (int k = 0; k < steps; ++k) {
+                naive_filter.predict();
+                xp.push_back(naive_filter.state());
+                Pp.push_back(naive_filter.covariance());
+                naive_filter.update(Y.col(k));
+                xf.push_back(naive_filter.state());
+                Pf.push_back(naive_filter.covariance());
+            }
+            for (int k = steps - 2; k >= 0; --k) {
+                Eigen::MatrixXd G = Pf[k] * A.transpose() * Pp[k + 1].inverse();
+                xf[k] += G * (xf[k + 1] - xp[k + 1]);
+                Pf[k] += G * (Pf[k + 1] - Pp[k + 1]) * G.transpose();
+            }
+            doNotOptimize(xf);
+        });
+        std::snprintf(name, sizeof(name), "n=%d m=%d naive two-pass", size[0], size[1]);
+        report(name, ns / steps);
+
+        KalmanFilter kf = makeKalmanFilter(size[0], size[1], {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        RtsSmoother smoother(kf.transitionMatrix());
+        ns = nanosecondsPerIteration(1, [&] {
+            smoother.filter(kf, Y);
+            smoother.smooth();
+        });
+        doNotOptimize(smoother.states());
+        std::snprintf(name, sizeof(name), "n=%d m=%d RtsSmoother", size[0], size[1]);
+        report(name, ns / steps);
+
+        KalmanFilter live = makeKalmanFilter(size[0], size[1], {GainSolver::LLT, CovarianceUpdate::Symmetric});
+        FixedLagSmoother lagged(live.transitionMatrix(), 10);
+        Eigen::VectorXd y(size[1]);
+        ns = nanosecondsPerIteration(1, [&] {
+            for (int k = 0; k < steps; ++k) {
+                y = Y.col(k);
+                lagged.step(live, y);
+            }
+        });
+        doNotOptimize(lagged.state());
+        std::snprintf(name, sizeof(name), "n=%d m=%d FixedLagSmoother lag 10", size[0], size[1]);
+        report(name, ns / steps);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include <Eigen/Dense>
+#include <sequential_monte_carlo.h>
+#include "benchmark_util.h"
+
+// One predict/update cycle of a million-particle filter, against the
+// previous array-of-structs layout (Vector3d state next to its weight,
+// one distribution call per noise sample) as reference.
+namespace {
+
+struct AosParticle {
+    Eigen::Vector3d state;
+    double weight;
+};
+
+void aosStep(std::vector<AosParticle>& particles, std::vector<AosParticle>& resampled,
+             std::default_random_engine& gen, const Eigen::Vector2d& z) {
+    std::normal_distribution<double> noise_pos(0.0, 0.2);
+    std::normal_distribution<double> noise_theta(0.0, 0.05);
+    for (auto& p : particles) {
+        p.state(0) += noise_pos(gen);
+        p.state(1) += noise_pos(gen);
+        p.state(2) += noise_theta(gen);
+    }
+    double sum = 0.0;
+    for (auto& p : particles) {
+        double dx = p.state(0) - z(0);
+        double dy = p.state(1) - z(1);
+        p.weight *= std::exp(-0.5 * (dx * dx + dy * dy));
+        sum += p.weight;
+    }
+    const int n = static_cast<int>(particles.size());
+    for (auto& p : particles) {
+        p.weight = sum > 0 ? p.weight / sum : 1.0 / n;
+    }
+    std::uniform_real_distribution<double> dist(0.0, 1.0 / n);
+    double r = dist(gen);
+    double c = particles[0].weight;
+    int i = 0;
+    for (int m = 0; m < n; ++m) {
+        double U = r + m * (1.0 / n);
+        while (U > c && i < n - 1) {
+            ++i;
+            c += particles[i].weight;
+        }
+        resampled[m] = particles[i];
+        resampled[m].weight = 1.0 / n;
+    }
+    particles.swap(resampled);
+}
+
+} // namespace
+
+int main() {
+    const int n = 1000000;
+    const long steps = 10;
+    Eigen::VectorXd z(2);
+    z << 0.1, -0.1;
+
+    std::vector<AosParticle> aos(n, AosParticle{Eigen::Vector3d::Zero(), 1.0 / n});
+    std::vector<AosParticle> aos_resampled(n);
+    std::default_random_engine gen;
+    double aos_ns = nanosecondsPerIteration(steps, [&] {
+        aosStep(aos, aos_resampled, gen, z);
+        doNotOptimize(aos[0].state);
+    });
+    report("AoS Vector3d, 1e6 particles (ns/step)", aos_ns);
+
+    double soa_ns = 0.0;
+    for (int dim : {3, 6, 12}) {
+        SequentialMonteCarlo pf(n, dim);
+        pf.predict();
+        pf.update(z);
+        double predict_ns = nanosecondsPerIteration(steps, [&] {
+            pf.predict();
+            doNotOptimize(pf.particles());
+        });
+        double update_ns = nanosecondsPerIteration(steps, [&] {
+            pf.update(z);
+            doNotOptimize(pf.particles());
+        });
+        char name[64];
+        std::snprintf(name, sizeof(name), "SoA dim %d predict (ns/step)", dim);
+        report(name, predict_ns);
+        std::snprintf(name, sizeof(name), "SoA dim %d update (ns/step)", dim);
+        report(name, update_ns);
+        if (dim == 3) {
+            soa_ns = predict_ns + update_ns;
+        }
+    }
+    std::printf("speedup at dim 3: %.2fx, %.1f steps/s\n", aos_ns / soa_ns, 1e9 / soa_ns);
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <sharded_tracker.h>
+#include "benchmark_util.h"
+
+// Measurement throughput of 4 ingest threads feeding 1000 constant
+// velocity tracks, once through a mutex around a map of filters and once
+// through ShardedTracker with 1, 2 and 4 shards, with the shard latency
+// quantiles.
+static std::unique_ptr<KalmanFilter> makeFilter() {
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(4, 4);
+    A(0, 2) = 0.1;
+    A(1, 3) = 0.1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    auto kf = std::make_unique<KalmanFilter>(0.1, A, C, 0.01 * Eigen::MatrixXd::Identity(4, 4),
+                                             0.1 * Eigen::MatrixXd::Identity(2, 2),
+                                             Eigen::MatrixXd::Identity(4, 4));
+    kf->init(Eigen::VectorXd::Zero(4));
+    return kf;
+}
+
+template <typename Submit>
+static double nanosecondsPerMeasurement(int producers, int per_producer, int tracks, Submit&& submit) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            Eigen::VectorXd y = Eigen::VectorXd::Ones(2);
+            for (int k = 0; k < per_producer; ++k) {
+                submit(static_cast<long>((p * per_producer + k) % tracks), y);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / (producers * per_producer);
+}
+
+int main() {
+    const int producers = 4;
+    const int per_producer = 50000;
+    const int tracks = 1000;
+    char name[96];
+
+    std::mutex mutex;
+    std::unordered_map<long, std::unique_ptr<KalmanFilter>> filters;
+    double ns = nanosecondsPerMeasurement(producers, per_producer, tracks, [&](long id, const Eigen::VectorXd& y) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<KalmanFilter>& filter = filters[id];
+        if (!filter) {
+            filter = makeFilter();
+        }
+        filter->predict();
+        filter->update(y);
+    });
+    report("mutex around filter map", ns);
+
+    for (int shards : {1, 2, 4}) {
+        ShardedTracker tracker(shards, [](long, const Eigen::VectorXd&) {
+            return std::unique_ptr<BaseKalmanFilter>(makeFilter());
+        });
+        ns = nanosecondsPerMeasurement(producers, per_producer, tracks, [&](long id, const Eigen::VectorXd& y) {
+            tracker.submit(id, y);
+        });
+        auto start = std::chrono::steady_clock::now();
+        tracker.flush();
+        double drain = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::snprintf(name, sizeof(name), "ShardedTracker, %d shards", shards);
+        report(name, ns + drain / (producers * per_producer));
+        for (int s = 0; s < shards; ++s) {
+            const LatencyHistogram& latency = tracker.latency(s);
+            std::printf("  shard %d latency p50 <= %lld ns, p99 <= %lld ns\n", s,
+                        static_cast<long long>(latency.quantile(0.5)),
+                        static_cast<long long>(latency.quantile(0.99)));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <kalman_filter.h>
+#include <sparse_kalman_filter.h>
+#include "benchmark_util.h"
+
+// A gridded field of n/4 independent 2D constant velocity cells; each step
+// observes the positions of 16 cells. The sparse filter tracks the 4x4
+// covariance block of every cell. The dense filter is only timed at
+// n = 1000 unless --dense is given, since its O(n^3) step takes minutes
+// beyond that.
+static std::vector<Eigen::Triplet<double>> transition(int n, double dt) {
+    std::vector<Eigen::Triplet<double>> entries;
+    for (int i = 0; i < n; ++i) {
+        entries.emplace_back(i, i, 1.0);
+    }
+    for (int cell = 0; cell < n / 4; ++cell) {
+        entries.emplace_back(4 * cell, 4 * cell + 2, dt);
+        entries.emplace_back(4 * cell + 1, 4 * cell + 3, dt);
+    }
+    return entries;
+}
+
+int main(int argc, char** argv) {
+    bool dense_all = argc > 1 && std::strcmp(argv[1], "--dense") == 0;
+    const int observed_cells = 16;
+    const int m = 2 * observed_cells;
+
+    for (int n : {1000, 5000, 10000}) {
+        using SparseMatrix = SparseKalmanFilter::SparseMatrix;
+        SparseMatrix A(n, n), C(m, n), Q(n, n), R(m, m), P(n, n);
+        auto a = transition(n, 0.1);
+        A.setFromTriplets(a.begin(), a.end());
+        std::vector<Eigen::Triplet<double>> c;
+        for (int k = 0; k < observed_cells; ++k) {
+            int cell = (k * 7919) % (n / 4);
+            c.emplace_back(2 * k, 4 * cell, 1.0);
+            c.emplace_back(2 * k + 1, 4 * cell + 1, 1.0);
+        }
+        C.setFromTriplets(c.begin(), c.end());
+        Q.setIdentity();
+        Q *= 1e-3;
+        R.setIdentity();
+        R *= 0.1;
+        P.setIdentity();
+
+        SparseKalmanFilter sparse_filter(A, C, Q, R, P);
+        for (int cell = 0; cell < n / 4; ++cell) {
+            sparse_filter.trackCovarianceBlock(4 * cell, 4 * cell, 4, 4);
+        }
+        Eigen::VectorXd y = Eigen::VectorXd::Ones(m);
+        double ns = nanosecondsPerIteration(10, [&] {
+            sparse_filter.predict();
+            sparse_filter.update(y);
+        });
+        doNotOptimize(sparse_filter.state());
+        char name[96];
+        std::snprintf(name, sizeof(name), "n=%d SparseKalmanFilter step", n);
+        report(name, ns);
+
+        if (n > 1000 && !dense_all) {
+            std::snprintf(name, sizeof(name), "n=%d KalmanFilter step (skipped, --dense)", n);
+            std::printf("%s\n", name);
+            continue;
+        }
+        KalmanFilter dense_filter(0.1, Eigen::MatrixXd(A), Eigen::MatrixXd(C), Eigen::MatrixXd(Q),
+                                  Eigen::MatrixXd(R), Eigen::MatrixXd(P));
+        dense_filter.init(Eigen::VectorXd::Zero(n));
+        ns = nanosecondsPerIteration(2, [&] {
+            dense_filter.predict();
+            dense_filter.update(y);
+        });
+        doNotOptimize(dense_filter.state());
+        std::snprintf(name, sizeof(name), "n=%d KalmanFilter step", n);
+        report(name, ns);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <Eigen/Dense>
+#include <square_root_unscented_kalman_filter.h>
+#include <unscented_kalman_filter.h>
+#include "benchmark_util.h"
+
+// SquareRootUnscentedKalmanFilter against UnscentedKalmanFilter: position
+// error on a simulated coordinated turn observed by a range-bearing sensor,
+// and per-step cost (predict + update) at n = 6, 12 and 30.
+static void coordinatedTurn(const Eigen::VectorXd& s, Eigen::VectorXd& fx) {
+    const double dt = 0.1;
+    fx << s(0) + dt * s(2) * std::cos(s(3)),
+          s(1) + dt * s(2) * std::sin(s(3)),
+          s(2),
+          s(3) + dt * s(4),
+          s(4);
+}
+
+static void rangeBearing(const Eigen::VectorXd& s, Eigen::VectorXd& z) {
+    z << std::sqrt(s(0) * s(0) + s(1) * s(1)), std::atan2(s(1), s(0));
+}
+
+static void process(const Eigen::VectorXd& x, Eigen::VectorXd& fx) {
+    const Eigen::Index n = x.size();
+    for (Eigen::Index i = 0; i < n; ++i) {
+        fx(i) = 0.95 * x(i) + 0.05 * std::sin(x((i + 1) % n));
+    }
+}
+
+static void sensor(const Eigen::VectorXd& x, Eigen::VectorXd& z) {
+    z = x.head(3) + 0.1 * x.head(3).cwiseAbs2();
+}
+
+template <typename Filter>
+static void configure(Filter& filter, const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0,
+                      const typename Filter::InPlaceModel& f, const Eigen::MatrixXd& Q,
+                      const typename Filter::InPlaceModel& h, const Eigen::MatrixXd& R) {
+    filter.initialize(x0, P0);
+    filter.setInPlaceProcessModel(f, Q);
+    filter.setInPlaceMeasurementModel(h, R);
+}
+
+static void accuracy() {
+    const int steps = 2000;
+    Eigen::VectorXd truth(5);
+    truth << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd Q = Eigen::VectorXd((Eigen::VectorXd(5) << 1e-4, 1e-4, 1e-3, 1e-4, 1e-4).finished()).asDiagonal();
+    Eigen::MatrixXd R = Eigen::VectorXd((Eigen::VectorXd(2) << 0.05 * 0.05, 0.01 * 0.01).finished()).asDiagonal();
+    Eigen::VectorXd x0 = truth;
+    x0.head(2) += Eigen::Vector2d(1.0, -1.0);
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+
+    UnscentedKalmanFilter ukf(5, 2);
+    configure(ukf, x0, P0, coordinatedTurn, Q, rangeBearing, R);
+    SquareRootUnscentedKalmanFilter srukf(5, 2);
+    configure(srukf, x0, P0, coordinatedTurn, Q, rangeBearing, R);
+
+    std::mt19937 generator(7);
+    std::normal_distribution<double> normal;
+    Eigen::LLT<Eigen::MatrixXd> q_factor(Q), r_factor(R);
+    Eigen::VectorXd next(5), w(5), z(2), v(2);
+    double ukf_error = 0.0, srukf_error = 0.0, covariance_gap = 0.0;
+    for (int k = 0; k < steps; ++k) {
+        coordinatedTurn(truth, next);
+        for (int i = 0; i < 5; ++i) w(i) = normal(generator);
+        truth = next + q_factor.matrixL() * w;
+        rangeBearing(truth, z);
+        for (int i = 0; i < 2; ++i) v(i) = normal(generator);
+        z += r_factor.matrixL() * v;
+
+        ukf.predict();
+        ukf.update(z);
+        srukf.predict();
+        srukf.update(z);
+        ukf_error += (ukf.state() - truth).head(2).squaredNorm();
+        srukf_error += (srukf.state() - truth).head(2).squaredNorm();
+        covariance_gap = std::max(covariance_gap, (ukf.covariance() - srukf.covariance()).cwiseAbs().maxCoeff());
+    }
+    std::printf("position RMSE over %d steps: UKF %.4f, SR-UKF %.4f, max |P_UKF - S S'| %.1e\n",
+                steps, std::sqrt(ukf_error / steps), std::sqrt(srukf_error / steps), covariance_gap);
+}
+
+static void timing(int n) {
+    const long steps = n <= 12 ? 20000 : 2000;
+    Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(n, 0.0, 1.0);
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(3, 3);
+    Eigen::VectorXd z = x0.head(3);
+
+    UnscentedKalmanFilter ukf(n, 3);
+    configure(ukf, x0, P0, process, Q, sensor, R);
+    ukf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    SquareRootUnscentedKalmanFilter srukf(n, 3);
+    configure(srukf, x0, P0, process, Q, sensor, R);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "n = %d, UKF", n);
+    report(name, nanosecondsPerIteration(steps, [&] {
+        ukf.predict();
+        ukf.update(z);
+    }));
+    std::snprintf(name, sizeof(name), "n = %d, SR-UKF", n);
+    report(name, nanosecondsPerIteration(steps, [&] {
+        srukf.predict();
+        srukf.update(z);
+    }));
+}
+
+int main() {
+    accuracy();
+    for (int n : {6, 12, 30}) {
+        timing(n);
+    }
+    return 0;
+}
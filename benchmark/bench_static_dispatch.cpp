@@ -0,0 +1,106 @@
+#include <cmath>
+#include <cstdio>
+#include <Eigen/Dense>
+#include <extended_kalman_filter.h>
+#include <extended_kalman_filter_t.h>
+#include <unscented_kalman_filter.h>
+#include <unscented_kalman_filter_t.h>
+#include "benchmark_util.h"
+
+// Per-step cost of the std::function based EKF and UKF against the
+// statically dispatched templates, for a coordinated turn observed by a
+// range-bearing sensor.
+using State = Eigen::Matrix<double, 5, 1>;
+using Measurement = Eigen::Matrix<double, 2, 1>;
+
+struct CoordinatedTurn {
+    double dt;
+    void operator()(const State& s, State& fx) const {
+        fx << s(0) + dt * s(2) * std::cos(s(3)),
+              s(1) + dt * s(2) * std::sin(s(3)),
+              s(2),
+              s(3) + dt * s(4),
+              s(4);
+    }
+    void operator()(const State& s, State& fx, Eigen::Matrix<double, 5, 5>& F) const {
+        (*this)(s, fx);
+        F.setIdentity();
+        F(0, 2) = dt * std::cos(s(3));
+        F(0, 3) = -dt * s(2) * std::sin(s(3));
+        F(1, 2) = dt * std::sin(s(3));
+        F(1, 3) = dt * s(2) * std::cos(s(3));
+        F(3, 4) = dt;
+    }
+};
+
+struct RangeBearing {
+    void operator()(const State& s, Measurement& z) const {
+        z << std::sqrt(s(0) * s(0) + s(1) * s(1)), std::atan2(s(1), s(0));
+    }
+    void operator()(const State& s, Measurement& z, Eigen::Matrix<double, 2, 5>& H) const {
+        (*this)(s, z);
+        double r2 = s(0) * s(0) + s(1) * s(1);
+        double r = std::sqrt(r2);
+        H << s(0) / r, s(1) / r, 0, 0, 0,
+             -s(1) / r2, s(0) / r2, 0, 0, 0;
+    }
+};
+
+int main() {
+    const long steps = 200000;
+    const double dt = 0.01;
+    State x0;
+    x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+    CoordinatedTurn f{dt};
+    RangeBearing h;
+    Eigen::VectorXd z(2);
+    z << 10.7, -0.38;
+    Measurement zf = z;
+
+    ExtendedKalmanFilter ekf(x0, P0, Q, R);
+    ekf.setProcessModel(
+        [f](const Eigen::VectorXd& s) { State fx; f(State(s), fx); return Eigen::VectorXd(fx); },
+        [f](const Eigen::VectorXd& s) { State fx; Eigen::Matrix<double, 5, 5> F; f(State(s), fx, F); return Eigen::MatrixXd(F); });
+    ekf.setMeasurementModel(
+        [h](const Eigen::VectorXd& s) { Measurement m; h(State(s), m); return Eigen::VectorXd(m); },
+        [h](const Eigen::VectorXd& s) { Measurement m; Eigen::Matrix<double, 2, 5> H; h(State(s), m, H); return Eigen::MatrixXd(H); });
+    ekf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Standard});
+    double ns = nanosecondsPerIteration(steps, [&] {
+        ekf.predict();
+        ekf.update(z);
+    });
+    doNotOptimize(ekf.state());
+    report("ExtendedKalmanFilter (std::function)", ns);
+
+    ExtendedKalmanFilterT<CoordinatedTurn, RangeBearing, 5, 2> ekf_t(f, h, x0, P0, Q, R);
+    ns = nanosecondsPerIteration(steps, [&] {
+        ekf_t.predict();
+        ekf_t.update(zf);
+    });
+    doNotOptimize(ekf_t.state());
+    report("ExtendedKalmanFilterT", ns);
+
+    UnscentedKalmanFilter ukf(5, 2);
+    ukf.initialize(x0, P0);
+    ukf.setProcessModel([f](const Eigen::VectorXd& s) { State fx; f(State(s), fx); return Eigen::VectorXd(fx); }, Q);
+    ukf.setMeasurementModel([h](const Eigen::VectorXd& s) { Measurement m; h(State(s), m); return Eigen::VectorXd(m); }, R);
+    ukf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Standard});
+    ns = nanosecondsPerIteration(steps, [&] {
+        ukf.predict();
+        ukf.update(z);
+    });
+    doNotOptimize(ukf.state());
+    report("UnscentedKalmanFilter (std::function)", ns);
+
+    UnscentedKalmanFilterT<CoordinatedTurn, RangeBearing, 5, 2> ukf_t(f, h, x0, P0, Q, R);
+    ns = nanosecondsPerIteration(steps, [&] {
+        ukf_t.predict();
+        ukf_t.update(zf);
+    });
+    doNotOptimize(ukf_t.state());
+    report("UnscentedKalmanFilterT", ns);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#include <cstdio>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include "benchmark_util.h"
+
+// Throughput of a time-invariant KalmanFilter with the full covariance
+// recursion and with the cached steady-state gain.
+int main() {
+    const int sizes[][2] = {{4, 2}, {6, 3}, {12, 6}, {30, 15}};
+    for (const auto& size : sizes) {
+        Eigen::VectorXd z = Eigen::VectorXd::Random(size[1]);
+        char name[96];
+
+        KalmanFilter regular = makeKalmanFilter(size[0], size[1]);
+        double ns = nanosecondsPerIteration(50000, [&] {
+            regular.predict();
+            regular.update(z);
+        });
+        doNotOptimize(regular.state());
+        std::snprintf(name, sizeof(name), "n=%d m=%d full recursion", size[0], size[1]);
+        report(name, ns);
+
+        KalmanFilter steady = makeKalmanFilter(size[0], size[1]);
+        steady.enableSteadyState();
+        ns = nanosecondsPerIteration(50000, [&] {
+            steady.predict();
+            steady.update(z);
+        });
+        doNotOptimize(steady.state());
+        std::snprintf(name, sizeof(name), "n=%d m=%d steady-state gain", size[0], size[1]);
+        report(name, ns);
+    }
+    return 0;
+}
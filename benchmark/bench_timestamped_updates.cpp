@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include "benchmark_util.h"
+
+// Per-measurement latency of timestamped updates as the number of
+// asynchronous sensors grows. Sensors sample on a common 1 ms clock with
+// periods of 10-100 ms and random phases, so the intervals between
+// merged measurements come from a small set that the discretization
+// cache holds.
+int main() {
+    const int n = 6;
+    Eigen::MatrixXd Ac = Eigen::MatrixXd::Zero(n, n);
+    Ac.topRightCorner(n / 2, n / 2).setIdentity();
+    Eigen::MatrixXd Qc = Eigen::MatrixXd::Zero(n, n);
+    Qc.bottomRightCorner(n / 2, n / 2).setIdentity();
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(n / 2, n);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(n / 2, n / 2);
+    const int periods_ms[] = {10, 20, 50, 100};
+
+    for (int num_sensors : {1, 4, 16, 64, 256}) {
+        struct Measurement { long long t_ms; int sensor; };
+        std::vector<Measurement> stream;
+        for (int s = 0; s < num_sensors; ++s) {
+            int period = periods_ms[s % 4];
+            int phase = (s * 7) % period;
+            for (long long t = phase; t < 20000; t += period) {
+                stream.push_back({t, s});
+            }
+        }
+        std::sort(stream.begin(), stream.end(),
+                  [](const Measurement& a, const Measurement& b) { return a.t_ms < b.t_ms; });
+
+        KalmanFilter kf(0.01, Eigen::MatrixXd::Identity(n, n), C, Eigen::MatrixXd::Zero(n, n), R,
+                        Eigen::MatrixXd::Identity(n, n));
+        kf.setContinuousModel(Ac, Qc, 16);
+        kf.init(Eigen::VectorXd::Zero(n), Eigen::MatrixXd::Identity(n, n), 0.0);
+        Eigen::VectorXd y = Eigen::VectorXd::Ones(n / 2);
+        std::size_t next = 0;
+        double ns = nanosecondsPerIteration(static_cast<long>(stream.size()), [&] {
+            kf.update(1e-3 * stream[next++].t_ms, y);
+        });
+        doNotOptimize(kf.state());
+
+        char name[96];
+        std::snprintf(name, sizeof(name), "%3d sensors, per measurement (%d cache misses)",
+                      num_sensors, kf.discretizationCache().misses());
+        report(name, ns);
+    }
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <cmath>
+#include <cstdio>
+#include <Eigen/Dense>
+#include <thread_pool.h>
+#include <unscented_kalman_filter.h>
+#include "benchmark_util.h"
+
+// Per-step cost (predict + update) of UnscentedKalmanFilter at n = 6, 12
+// and 30 with a contracting, weakly coupled nonlinear process model and a three-channel
+// nonlinear sensor, for models returning new vectors and in-place models.
+// Then the same filter with a costly integrator as process model under
+// each sigma point scheme, and with its sigma points evaluated serially
+// and on a thread pool.
+static void process(const Eigen::VectorXd& x, Eigen::VectorXd& fx) {
+    const Eigen::Index n = x.size();
+    for (Eigen::Index i = 0; i < n; ++i) {
+        fx(i) = 0.95 * x(i) + 0.05 * std::sin(x((i + 1) % n));
+    }
+}
+
+static void sensor(const Eigen::VectorXd& x, Eigen::VectorXd& z) {
+    z = x.head(3) + 0.1 * x.head(3).cwiseAbs2();
+}
+
+static void run(int n) {
+    const long steps = n <= 12 ? 20000 : 2000;
+    Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(n, 0.0, 1.0);
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(3, 3);
+    Eigen::VectorXd z = x0.head(3);
+
+    UnscentedKalmanFilter ukf(n, 3);
+    ukf.initialize(x0, Eigen::MatrixXd::Identity(n, n));
+    ukf.setProcessModel([](const Eigen::VectorXd& x) {
+        Eigen::VectorXd fx(x.size());
+        process(x, fx);
+        return fx;
+    }, Q);
+    ukf.setMeasurementModel([](const Eigen::VectorXd& x) {
+        Eigen::VectorXd hx(3);
+        sensor(x, hx);
+        return hx;
+    }, R);
+    ukf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    char name[64];
+    std::snprintf(name, sizeof(name), "n = %d, returning models", n);
+    report(name, nanosecondsPerIteration(steps, [&] {
+        ukf.predict();
+        ukf.update(z);
+    }));
+
+    UnscentedKalmanFilter in_place(n, 3);
+    in_place.initialize(x0, Eigen::MatrixXd::Identity(n, n));
+    in_place.setInPlaceProcessModel(process, Q);
+    in_place.setInPlaceMeasurementModel(sensor, R);
+    in_place.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    std::snprintf(name, sizeof(name), "n = %d, in-place models", n);
+    report(name, nanosecondsPerIteration(steps, [&] {
+        in_place.predict();
+        in_place.update(z);
+    }));
+}
+
+// Forty RK4 substeps of a weakly coupled oscillator chain
+static void integrator(const Eigen::VectorXd& x, Eigen::VectorXd& fx) {
+    const int substeps = 40;
+    const double h = 0.01 / substeps;
+    auto derivative = [](const Eigen::VectorXd& s, Eigen::VectorXd& ds) {
+        const Eigen::Index n = s.size();
+        for (Eigen::Index i = 0; i < n; ++i) {
+            ds(i) = -0.5 * s(i) + std::sin(s((i + 1) % n)) - 0.1 * s(i) * s(i) * s(i);
+        }
+    };
+    Eigen::VectorXd k1(x.size()), k2(x.size()), k3(x.size()), k4(x.size());
+    fx = x;
+    for (int step = 0; step < substeps; ++step) {
+        derivative(fx, k1);
+        derivative(fx + 0.5 * h * k1, k2);
+        derivative(fx + 0.5 * h * k2, k3);
+        derivative(fx + h * k3, k4);
+        fx += h / 6.0 * (k1 + 2.0 * k2 + 2.0 * k3 + k4);
+    }
+}
+
+static void schemes(int n) {
+    const long steps = 2000;
+    Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(n, 0.0, 1.0);
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(3, 3);
+    Eigen::VectorXd z = x0.head(3);
+    const SigmaPointScheme kinds[] = {SigmaPointScheme::SphericalSimplex, SigmaPointScheme::Scaled,
+                                      SigmaPointScheme::FifthDegreeCubature};
+    const char* names[] = {"spherical simplex", "scaled", "fifth-degree cubature"};
+    for (int s = 0; s < 3; ++s) {
+        UnscentedKalmanFilter ukf(n, 3, kinds[s]);
+        ukf.initialize(x0, Eigen::MatrixXd::Identity(n, n));
+        ukf.setInPlaceProcessModel(integrator, Q);
+        ukf.setInPlaceMeasurementModel(sensor, R);
+        ukf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+        char name[64];
+        std::snprintf(name, sizeof(name), "n = %d, %s, %d points", n, names[s], ukf.sigmaPointCount());
+        report(name, nanosecondsPerIteration(steps, [&] {
+            ukf.predict();
+            ukf.update(z);
+        }));
+    }
+}
+
+static void parallel(int n) {
+    const long steps = 500;
+    Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(n, 0.0, 1.0);
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(3, 3);
+    Eigen::VectorXd z = x0.head(3);
+    ThreadPool pool;
+    UnscentedKalmanFilter serial(n, 3);
+    UnscentedKalmanFilter threaded(n, 3);
+    for (UnscentedKalmanFilter* ukf : {&serial, &threaded}) {
+        ukf->initialize(x0, Eigen::MatrixXd::Identity(n, n));
+        ukf->setInPlaceProcessModel(integrator, Q);
+        ukf->setInPlaceMeasurementModel(sensor, R);
+        ukf->setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    }
+    threaded.setThreadPool(&pool);
+    char name[64];
+    std::snprintf(name, sizeof(name), "n = %d, integrator, serial", n);
+    double serial_ns = nanosecondsPerIteration(steps, [&] {
+        serial.predict();
+        serial.update(z);
+    });
+    report(name, serial_ns);
+    std::snprintf(name, sizeof(name), "n = %d, integrator, %d threads", n, pool.size());
+    double threaded_ns = nanosecondsPerIteration(steps, [&] {
+        threaded.predict();
+        threaded.update(z);
+    });
+    report(name, threaded_ns);
+    std::printf("speedup: %.2fx, identical: %s\n", serial_ns / threaded_ns,
+                threaded.state() == serial.state() && threaded.covariance() == serial.covariance() ? "yes" : "no");
+}
+
+int main() {
+    for (int n : {6, 12, 30}) {
+        run(n);
+    }
+    schemes(12);
+    parallel(12);
+    return 0;
+}
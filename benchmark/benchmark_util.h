@@ -0,0 +1,67 @@
+#ifndef BENCHMARK_UTIL_H
+#define BENCHMARK_UTIL_H
+
+#include <chrono>
+#include <cstdio>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+
+/**
+ * @brief Runs body() the given number of times and returns the mean wall
+ * clock time per call in nanoseconds.
+ */
+template <typename Body>
+double nanosecondsPerIteration(long iterations, Body&& body) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        body();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+}
+
+/**
+ * @brief Prints one benchmark result line.
+ */
+inline void report(const char* name, double nanoseconds) {
+    std::printf("%-48s %12.1f ns\n", name, nanoseconds);
+}
+
+/**
+ * @brief Keeps a value observable so the optimizer cannot drop the work
+ * that produced it.
+ */
+template <typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief Measurement matrix of makeKalmanFilter(): the first m state
+ * components, or a dense random m x n matrix.
+ */
+enum class BenchmarkMeasurement { Identity, Random };
+
+/**
+ * @brief Kalman filter of the linear benchmarks: n states drifting with
+ * small coupling to the second half of the state, m measurements, and
+ * the given update strategy.
+ */
+inline KalmanFilter makeKalmanFilter(int n, int m,
+                                     const UpdateStrategy& strategy = UpdateStrategy{},
+                                     BenchmarkMeasurement measurement = BenchmarkMeasurement::Identity) {
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(n, n);
+    A.topRightCorner(n / 2, n / 2).diagonal().setConstant(0.01);
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(m, n);
+    if (measurement == BenchmarkMeasurement::Random) {
+        C = Eigen::MatrixXd::Random(m, n);
+    }
+    Eigen::MatrixXd Q = 1e-4 * Eigen::MatrixXd::Identity(n, n);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(m, m);
+    KalmanFilter kf(0.01, A, C, Q, R, Eigen::MatrixXd::Identity(n, n));
+    kf.init(Eigen::VectorXd::Zero(n));
+    kf.setUpdateStrategy(strategy);
+    return kf;
+}
+
+#endif // BENCHMARK_UTIL_H
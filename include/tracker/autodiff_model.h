@@ -0,0 +1,98 @@
+#ifndef AUTODIFF_MODEL_H
+#define AUTODIFF_MODEL_H
+
+#include <Eigen/Dense>
+#include <unsupported/Eigen/AutoDiff>
+#include <extended_kalman_filter.h>
+
+/**
+ * @brief Evaluates a model functor and its Jacobian in one forward-mode
+ * automatic differentiation pass.
+ *
+ * Every input component is seeded as a dual number carrying one unit
+ * derivative direction, so a single evaluation on Eigen::AutoDiffScalar
+ * yields the value and every Jacobian column. With a fixed input size the
+ * derivative vectors live on the stack and the pass does not allocate;
+ * with Eigen::Dynamic every scalar operation allocates its derivative.
+ *
+ * @tparam Nx Input dimension, or Eigen::Dynamic.
+ * @tparam Ny Output dimension, or Eigen::Dynamic.
+ * @tparam Model Functor with a member template
+ *         template <typename T> Eigen::Matrix<T, Ny, 1> operator()(const Eigen::Matrix<T, Nx, 1>&) const
+ *         written once for both double and dual scalars.
+ */
+template <int Nx, int Ny, typename Model>
+class AutoDiffModel {
+public:
+    using Derivative = Eigen::Matrix<double, Nx, 1>;
+    using Dual = Eigen::AutoDiffScalar<Derivative>;
+    using DualInput = Eigen::Matrix<Dual, Nx, 1>;
+    using DualOutput = Eigen::Matrix<Dual, Ny, 1>;
+
+    explicit AutoDiffModel(const Model& model)
+        : model_(model) {}
+
+    /**
+     * @brief Evaluates the model value only, on plain doubles.
+     */
+    Eigen::Matrix<double, Ny, 1> operator()(const Eigen::Matrix<double, Nx, 1>& x) const {
+        return model_(x);
+    }
+
+    /**
+     * @brief Evaluates the model at x, writing its value and Jacobian.
+     */
+    template <typename Input, typename Value, typename Jacobian>
+    void linearize(const Input& x, Value& value, Jacobian& jacobian) const {
+        const Eigen::Index n = x.size();
+        DualInput xd = DualInput::Zero(n);
+        for (Eigen::Index i = 0; i < n; ++i) {
+            xd(i).value() = x(i);
+            xd(i).derivatives() = Derivative::Unit(n, i);
+        }
+        DualOutput yd = model_(xd);
+        value.resize(yd.size());
+        jacobian.resize(yd.size(), n);
+        for (Eigen::Index r = 0; r < yd.size(); ++r) {
+            value(r) = yd(r).value();
+            jacobian.row(r) = yd(r).derivatives().transpose();
+        }
+    }
+
+    /**
+     * @brief Model signatures of ExtendedKalmanFilterT and UnscentedKalmanFilterT.
+     */
+    template <typename Input, typename Value, typename Jacobian>
+    void operator()(const Input& x, Value& value, Jacobian& jacobian) const {
+        linearize(x, value, jacobian);
+    }
+
+    template <typename Input, typename Value>
+    void operator()(const Input& x, Value& value) const {
+        value = model_(x);
+    }
+
+    /**
+     * @brief Wraps the model for ExtendedKalmanFilter::setLinearizedProcessModel()
+     * and setLinearizedMeasurementModel().
+     */
+    LinearizedModel linearized() const {
+        AutoDiffModel self = *this;
+        return [self](const Eigen::VectorXd& x, Eigen::VectorXd& value, Eigen::MatrixXd& jacobian) {
+            self.linearize(x, value, jacobian);
+        };
+    }
+
+private:
+    Model model_;
+};
+
+/**
+ * @brief Returns the dual-number linearization of model as a LinearizedModel.
+ */
+template <int Nx, int Ny, typename Model>
+LinearizedModel autoDiffModel(const Model& model) {
+    return AutoDiffModel<Nx, Ny, Model>(model).linearized();
+}
+
+#endif // AUTODIFF_MODEL_H
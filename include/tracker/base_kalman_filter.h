@@ -1,6 +1,7 @@
 #ifndef BASE_KALMAN_FILTER_H
 #define BASE_KALMAN_FILTER_H
 
+#include <stdexcept>
 #include <Eigen/Dense>
 #include <base_filter.h>
 
@@ -20,6 +21,21 @@ public:
      * @brief Returns the current state covariance.
      */
     virtual const Eigen::MatrixXd& covariance() const = 0;
+
+    /**
+     * @brief Overwrites the state estimate and covariance.
+     */
+    virtual void setState(const Eigen::VectorXd& /*x*/, const Eigen::MatrixXd& /*P*/) {
+        throw std::logic_error("Filter does not support overwriting its state.");
+    }
+
+    /**
+     * @brief Returns the log-likelihood of the measurement of the last
+     * update, log N(innovation; 0, S).
+     */
+    virtual double logLikelihood() const {
+        throw std::logic_error("Filter does not provide a measurement likelihood.");
+    }
 };
 
 #endif // BASE_KALMAN_FILTER_H
\ No newline at end of file
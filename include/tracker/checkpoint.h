@@ -0,0 +1,158 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include <extended_kalman_filter.h>
+#include <kalman_filter.h>
+#include <sequential_monte_carlo.h>
+#include <unscented_kalman_filter.h>
+
+/**
+ * @brief Filter type stored in a checkpoint record.
+ */
+enum class CheckpointKind : std::uint16_t {
+    KalmanFilter = 1,
+    ExtendedKalmanFilter = 2,
+    UnscentedKalmanFilter = 3,
+    SequentialMonteCarlo = 4,
+    Commit = 0xffff // end of a consistent batch of records
+};
+
+/**
+ * @brief Appends filter snapshots to a checkpoint file.
+ *
+ * The file is a versioned header followed by a log of records. Each record
+ * is a fixed header (kind, layout version, filter id, payload size) and a
+ * payload of matrices stored as (rows, cols) and raw column-major doubles,
+ * everything 8-byte aligned so a reader can map the payload in place.
+ * write() buffers one record; commit() appends the buffered records and a
+ * commit marker and syncs the file. Only committed records are visible to
+ * CheckpointReader, and for every id the newest one wins, so an
+ * incremental checkpoint writes just the filters that changed since the
+ * last commit. compact() rewrites a log keeping only the newest records.
+ *
+ * Stored per filter:
+ *  - KalmanFilter: time step, time, update strategy, x, P, A, C, Q, R;
+ *  - ExtendedKalmanFilter, UnscentedKalmanFilter: x, P, Q, R;
+ *  - SequentialMonteCarlo: particle states and weights, generator state.
+ * Model functions cannot be serialized; nonlinear filters are restored
+ * into instances already configured with their models.
+ */
+class CheckpointWriter {
+public:
+    /**
+     * @brief Opens a checkpoint file for appending, creating it if needed.
+     */
+    explicit CheckpointWriter(const std::string& path);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void write(long id, const KalmanFilter& kf);
+    void write(long id, const ExtendedKalmanFilter& ekf);
+    void write(long id, const UnscentedKalmanFilter& ukf);
+    void write(long id, const SequentialMonteCarlo& smc);
+
+    /**
+     * @brief Makes the buffered records durable. Records written after the
+     * last commit are discarded if the writer is destroyed.
+     */
+    void commit();
+
+    /**
+     * @brief Writes the newest committed record of every filter in one
+     * checkpoint file to a new file.
+     */
+    static void compact(const std::string& from, const std::string& to);
+
+private:
+    void beginRecord(CheckpointKind kind, long id);
+    void endRecord();
+    void appendMatrix(const Eigen::Ref<const Eigen::MatrixXd>& M);
+    void appendBytes(const std::string& bytes);
+    void appendRaw(const void* data, std::size_t size);
+
+    int fd_ = -1;
+    std::string path_;
+    std::vector<char> buffer_;
+    std::size_t record_start_ = 0; // offset of the open record in buffer_
+};
+
+/**
+ * @brief Memory-mapped read access to a checkpoint file.
+ *
+ * Opening maps the file and indexes the newest committed record of every
+ * filter by walking the record headers; payloads are not touched until a
+ * filter is restored, and then copied straight from the mapping.
+ */
+class CheckpointReader {
+public:
+    explicit CheckpointReader(const std::string& path);
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader&) = delete;
+    CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+    /**
+     * @brief Returns the number of filters in the checkpoint.
+     */
+    std::size_t size() const;
+    bool contains(long id) const;
+    std::vector<long> ids() const;
+    CheckpointKind kind(long id) const;
+
+    /**
+     * @brief Replaces kf with the stored filter.
+     *
+     * Only the fields listed for the writer are stored. Steady-state mode,
+     * sequential mode, a continuous-time model and the out-of-sequence
+     * history are silently dropped: the restored filter starts with all of
+     * them off, predicting with the last transition matrix (the discretized
+     * one for a continuous model) from the effective covariance.
+     * @throws std::invalid_argument if the record's matrices do not fit
+     * together or its update strategy is unknown.
+     */
+    void restore(long id, KalmanFilter& kf) const;
+
+    /**
+     * @brief Restores estimate and noise covariances into a filter
+     * configured with the same models and dimensions.
+     */
+    void restore(long id, ExtendedKalmanFilter& ekf) const;
+    void restore(long id, UnscentedKalmanFilter& ukf) const;
+
+    void restore(long id, SequentialMonteCarlo& smc) const;
+
+private:
+    friend class CheckpointWriter;
+
+    // Sequential access to the payload of one record
+    class Payload {
+    public:
+        Payload(const char* data, std::size_t size);
+        Eigen::Map<const Eigen::MatrixXd> matrix();
+        std::string bytes();
+
+    private:
+        const char* take(std::size_t size);
+        const char* data_;
+        std::size_t size_;
+        std::size_t offset_ = 0;
+    };
+
+    Payload payload(long id, CheckpointKind kind) const;
+    void record(long id, const char*& data, std::size_t& size) const;
+
+    const char* data_ = nullptr;
+    std::size_t bytes_ = 0;
+    std::size_t committed_bytes_ = 0;             // end of the last complete batch
+    std::unordered_map<long, std::size_t> index_; // id -> offset of its newest record
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,31 @@
+#ifndef DISCRETE_RICCATI_H
+#define DISCRETE_RICCATI_H
+
+#include <Eigen/Dense>
+
+/**
+ * @brief Solves the filtering form of the discrete algebraic Riccati equation
+ *
+ *     P = A P A' - A P C' (C P C' + R)^-1 C P A' + Q
+ *
+ * for the steady-state predicted covariance P of a time-invariant linear
+ * model, using the structure-preserving doubling algorithm (quadratic
+ * convergence, one n x n LU factorization per iteration).
+ *
+ * @param A State transition matrix.
+ * @param C Observation matrix.
+ * @param Q Process noise covariance matrix.
+ * @param R Measurement noise covariance matrix, positive definite.
+ * @param tolerance Relative change of P at which iteration stops.
+ * @param max_iterations Iteration limit.
+ * @return Steady-state predicted covariance.
+ * @throws std::runtime_error if the iteration does not converge.
+ */
+Eigen::MatrixXd solveDiscreteRiccati(const Eigen::MatrixXd& A,
+                                     const Eigen::MatrixXd& C,
+                                     const Eigen::MatrixXd& Q,
+                                     const Eigen::MatrixXd& R,
+                                     double tolerance = 1e-12,
+                                     int max_iterations = 100);
+
+#endif // DISCRETE_RICCATI_H
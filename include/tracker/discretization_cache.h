@@ -0,0 +1,69 @@
+#ifndef DISCRETIZATION_CACHE_H
+#define DISCRETIZATION_CACHE_H
+
+#include <vector>
+#include <Eigen/Dense>
+
+/**
+ * @brief Small LRU cache of discretized continuous-time linear models.
+ *
+ * For the continuous model dx = Ac x dt + dw with E[dw dw'] = Qc dt, get(dt)
+ * returns the discrete transition A = exp(Ac dt) and process noise Q from
+ * Van Loan's method. Intervals are keyed after rounding to a fixed
+ * resolution so that periods recovered from floating point timestamps
+ * share one entry; the common sensor periods of a deployment therefore
+ * cost one matrix exponential each and a short linear scan afterwards.
+ */
+class DiscretizationCache {
+public:
+    struct Discretization {
+        Eigen::MatrixXd A; // discrete state transition
+        Eigen::MatrixXd Q; // discrete process noise covariance
+    };
+
+    DiscretizationCache() = default;
+
+    /**
+     * @param Ac Continuous-time system matrix.
+     * @param Qc Continuous-time process noise spectral density.
+     * @param capacity Number of intervals kept.
+     * @param resolution Interval rounding used for the cache key.
+     */
+    DiscretizationCache(const Eigen::MatrixXd& Ac,
+                        const Eigen::MatrixXd& Qc,
+                        int capacity = 8,
+                        double resolution = 1e-9);
+
+    /**
+     * @brief Returns the discretization for an interval, computing it on a miss.
+     */
+    const Discretization& get(double dt);
+
+    /**
+     * @brief Returns whether a continuous model has been set.
+     */
+    bool valid() const;
+
+    int hits() const;
+    int misses() const;
+
+private:
+    struct Entry {
+        long long key;
+        long long last_used;
+        Discretization model;
+    };
+
+    Discretization discretize(double dt) const;
+
+    Eigen::MatrixXd Ac_;
+    Eigen::MatrixXd Qc_;
+    int capacity_ = 0;
+    double resolution_ = 1e-9;
+    std::vector<Entry> entries_;
+    long long clock_ = 0;
+    int hits_ = 0;
+    int misses_ = 0;
+};
+
+#endif // DISCRETIZATION_CACHE_H
@@ -34,6 +34,41 @@
  * )
  * @brief Updates the state and covariance using the measurement.
  *
+ * @method void setLinearizedProcessModel(const LinearizedModel& f)
+ * @method void setLinearizedMeasurementModel(const LinearizedModel& h)
+ * @brief Sets a model that returns its value and Jacobian from one call, e.g.
+ * autoDiffModel<Nx, Ny>(functor) from autodiff_model.h, which needs no
+ * hand-written Jacobian. Replaces the model set by the two-function setter.
+ *
+ * @method void setIteratedUpdate(int max_iterations, double tolerance)
+ * @brief Switches update() to the iterated EKF: the measurement is
+ * relinearized about the updated estimate and the prior is corrected
+ * again, Gauss-Newton style, until the estimate moves less than tolerance
+ * or max_iterations corrections were made. One iteration is the plain EKF.
+ *
+ * @method void setIterationCallback(const IterationCallback& callback)
+ * @brief Called after every update with the number of iterations and the
+ * norm of the last step, e.g. to export iteration counts as metrics.
+ *
+ * @method void setJacobianRefreshPolicy(const JacobianRefreshPolicy& policy)
+ * @brief Lets predict() and update() reuse the Jacobian F or H of the
+ * two-function models until the state has moved further than
+ * policy.state_threshold from the point it was evaluated at, or until it
+ * has served policy.max_age steps. The default refreshes on every step.
+ * Linearized models return their Jacobian with the value and are always
+ * evaluated, and so is H in every iteration of the iterated update, which
+ * relinearizes on purpose.
+ *
+ * @method const JacobianCounters& processJacobianCounters() const
+ * @method const JacobianCounters& measurementJacobianCounters() const
+ * @brief Number of Jacobian evaluations made and skipped under the policy.
+ *
+ * @method void setUpdateStrategy(const UpdateStrategy& strategy)
+ * @brief Selects the gain solver and covariance update form (explicit inverse by default).
+ *
+ * @method const Eigen::MatrixXd& transitionJacobian() const
+ * @brief Returns the process Jacobian used by the last prediction.
+ *
  * @method const Eigen::VectorXd& state() const
  * @brief Returns the current state estimate.
  *
@@ -49,11 +84,33 @@
 #ifndef EXTENDED_KALMAN_FILTER_H
 #define EXTENDED_KALMAN_FILTER_H
 
+#include <functional>
 #include <Eigen/Dense>
 #include <base_kalman_filter.h>
+#include <kalman_corrector.h>
+
+/**
+ * @brief Model evaluated together with its Jacobian at x.
+ */
+using LinearizedModel = std::function<void(const Eigen::VectorXd& x, Eigen::VectorXd& value, Eigen::MatrixXd& jacobian)>;
+
+/**
+ * @brief When a cached Jacobian may be reused instead of re-evaluated.
+ */
+struct JacobianRefreshPolicy {
+    double state_threshold = 0.0; // largest state change (Euclidean norm) a Jacobian is reused over
+    int max_age = 1;              // steps a Jacobian serves before it is re-evaluated
+};
+
+struct JacobianCounters {
+    long evaluated = 0;
+    long skipped = 0;
+};
 
 class ExtendedKalmanFilter : public BaseKalmanFilter {
 public:
+    using IterationCallback = std::function<void(int iterations, double step_norm)>;
+
     ExtendedKalmanFilter(
         const Eigen::VectorXd& x0,
         const Eigen::MatrixXd& P0,
@@ -67,22 +124,77 @@ public:
     void setMeasurementModel(const std::function<Eigen::VectorXd(const Eigen::VectorXd&)>& h,
                              const std::function<Eigen::MatrixXd(const Eigen::VectorXd&)>& H);
 
+    // Setters for models evaluated together with their Jacobians
+    void setLinearizedProcessModel(const LinearizedModel& f);
+    void setLinearizedMeasurementModel(const LinearizedModel& h);
 
     void predict() override;
     void update(const Eigen::VectorXd& z) override;
 
+    void setIteratedUpdate(int max_iterations, double tolerance);
+    void setIterationCallback(const IterationCallback& callback);
+    int iterationCount() const; // iterations of the last update
+
+    void setJacobianRefreshPolicy(const JacobianRefreshPolicy& policy);
+    const JacobianCounters& processJacobianCounters() const;
+    const JacobianCounters& measurementJacobianCounters() const;
+
+    void setUpdateStrategy(const UpdateStrategy& strategy);
+    void setNoiseCovariances(const Eigen::MatrixXd& Q, const Eigen::MatrixXd& R);
+
+    const Eigen::MatrixXd& transitionJacobian() const;
+    const Eigen::MatrixXd& processNoise() const;
+    const Eigen::MatrixXd& measurementNoise() const;
+
     const Eigen::VectorXd& state() const override;
     const Eigen::MatrixXd& covariance() const override;
+    void setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) override;
+    double logLikelihood() const override;
 
 private:
+    // Jacobian of a two-function model with its linearization point
+    struct CachedJacobian {
+        Eigen::VectorXd point;
+        int age = 0; // steps served, 0 when there is nothing to reuse
+        JacobianCounters counters;
+    };
+
+    bool needsJacobian(CachedJacobian& cache, const Eigen::VectorXd& x);
+    // reuse_jacobian lets the refresh policy keep the cached H
+    void evaluateMeasurement(const Eigen::VectorXd& x, bool reuse_jacobian);
+    void iteratedUpdate(const Eigen::VectorXd& z);
+
     std::function<Eigen::VectorXd(const Eigen::VectorXd&)> f_;
     std::function<Eigen::MatrixXd(const Eigen::VectorXd&)> F_;
     std::function<Eigen::VectorXd(const Eigen::VectorXd&)> h_;
     std::function<Eigen::MatrixXd(const Eigen::VectorXd&)> H_;
+    LinearizedModel fF_; // process model and Jacobian in one call
+    LinearizedModel hH_; // measurement model and Jacobian in one call
     Eigen::VectorXd x_;
     Eigen::MatrixXd P_;
     Eigen::MatrixXd Q_;
     Eigen::MatrixXd R_;
+    Eigen::MatrixXd Fk_; // process Jacobian of the last prediction
+    Eigen::MatrixXd Hk_; // measurement Jacobian of the last update
+    Eigen::VectorXd fx_; // predicted state of a linearized model
+    Eigen::VectorXd y_;  // predicted measurement, then innovation
+    KalmanCorrector corrector_;
+
+    // Lazy Jacobian refresh
+    JacobianRefreshPolicy refresh_policy_;
+    CachedJacobian process_jacobian_;
+    CachedJacobian measurement_jacobian_;
+
+    // Iterated update
+    int max_iterations_ = 1;
+    double tolerance_ = 0.0;
+    int iterations_ = 0;
+    IterationCallback iteration_callback_;
+    Eigen::VectorXd x_prior_; // estimate before the update
+    Eigen::VectorXd x_iter_;  // current linearization point
+    Eigen::VectorXd x_next_;  // estimate of the current iteration
+    Eigen::VectorXd dx_;      // x_prior_ - x_iter_
+    Eigen::MatrixXd P_iter_;  // covariance of the current iteration
 };
 
 #endif // EXTENDED_KALMAN_FILTER_H
\ No newline at end of file
@@ -0,0 +1,125 @@
+#ifndef EXTENDED_KALMAN_FILTER_T_H
+#define EXTENDED_KALMAN_FILTER_T_H
+
+#include <Eigen/Dense>
+
+/**
+ * @brief Extended Kalman filter with statically dispatched models and
+ * compile-time dimensions.
+ *
+ * The models are functors stored by value and called directly, so they
+ * can be inlined, and they write their value and Jacobian into fixed-size
+ * outputs owned by the filter. predict() and update() therefore make no
+ * indirect calls and never touch the allocator. Wrap the filter in
+ * KalmanFilterAdapter to use it through BaseKalmanFilter.
+ *
+ * @tparam ProcessModel Functor called as f(x, fx, F) with x a StateVector,
+ *         writing f(x) to fx (StateVector) and its Jacobian to F (StateMatrix).
+ * @tparam MeasurementModel Functor called as h(x, z, H), writing h(x) to z
+ *         (MeasurementVector) and its Jacobian to H (MeasurementMatrix).
+ * @tparam Nx State dimension.
+ * @tparam Nz Measurement dimension.
+ * @tparam Scalar_ Floating point type of the filter.
+ *
+ * AutoDiffModel from autodiff_model.h satisfies both model signatures.
+ */
+template <typename ProcessModel, typename MeasurementModel, int Nx, int Nz, typename Scalar_ = double>
+class ExtendedKalmanFilterT {
+public:
+    using Scalar = Scalar_;
+    using StateVector = Eigen::Matrix<Scalar, Nx, 1>;
+    using StateMatrix = Eigen::Matrix<Scalar, Nx, Nx>;
+    using MeasurementVector = Eigen::Matrix<Scalar, Nz, 1>;
+    using MeasurementMatrix = Eigen::Matrix<Scalar, Nz, Nx>;
+    using MeasurementCovariance = Eigen::Matrix<Scalar, Nz, Nz>;
+
+    /**
+     * @param f Process model.
+     * @param h Measurement model.
+     * @param x0 Initial state.
+     * @param P0 Initial covariance.
+     * @param Q Process noise covariance.
+     * @param R Measurement noise covariance.
+     */
+    ExtendedKalmanFilterT(const ProcessModel& f,
+                          const MeasurementModel& h,
+                          const StateVector& x0,
+                          const StateMatrix& P0,
+                          const StateMatrix& Q,
+                          const MeasurementCovariance& R)
+        : f_(f), h_(h), x_(x0), P_(P0), Q_(Q), R_(R),
+          fx_(StateVector::Zero()), F_(StateMatrix::Identity()),
+          z_(MeasurementVector::Zero()), H_(MeasurementMatrix::Zero()) {}
+
+    void init(const StateVector& x0) {
+        x_ = x0;
+    }
+
+    void init(const StateVector& x0, const StateMatrix& P0) {
+        x_ = x0;
+        P_ = P0;
+    }
+
+    /**
+     * @brief Predicts the next state, linearizing about the prior.
+     */
+    void predict() {
+        f_(x_, fx_, F_);
+        x_ = fx_;
+        P_ = F_ * P_ * F_.transpose() + Q_;
+    }
+
+    /**
+     * @brief Updates the state with a new measurement.
+     * @param z Measurement vector.
+     */
+    void update(const MeasurementVector& z) {
+        h_(x_, z_, H_);
+        const Eigen::Matrix<Scalar, Nz, Nx> HP = H_ * P_;
+        const MeasurementCovariance S = HP * H_.transpose() + R_;
+        // Transposed gain from S * K' = H * P
+        const Eigen::Matrix<Scalar, Nz, Nx> Kt = S.llt().solve(HP);
+        x_.noalias() += Kt.transpose() * (z - z_);
+        P_.noalias() -= Kt.transpose() * HP;
+    }
+
+    const StateVector& state() const {
+        return x_;
+    }
+
+    const StateMatrix& covariance() const {
+        return P_;
+    }
+
+    /**
+     * @brief Returns the process Jacobian used by the last prediction.
+     */
+    const StateMatrix& transitionJacobian() const {
+        return F_;
+    }
+
+    ProcessModel& processModel() {
+        return f_;
+    }
+
+    MeasurementModel& measurementModel() {
+        return h_;
+    }
+
+private:
+    ProcessModel f_;
+    MeasurementModel h_;
+
+    StateVector x_;
+    StateMatrix P_;
+    StateMatrix Q_;
+    MeasurementCovariance R_;
+
+    // Model outputs
+    StateVector fx_;
+    StateMatrix F_;
+    MeasurementVector z_;
+    MeasurementMatrix H_;
+};
+
+#endif // EXTENDED_KALMAN_FILTER_T_H
@@ -0,0 +1,101 @@
+#ifndef FIXED_LAG_SMOOTHER_H
+#define FIXED_LAG_SMOOTHER_H
+
+#include <Eigen/Dense>
+#include <rts_smoother.h>
+
+/**
+ * @brief Fixed-lag smoother for live streams.
+ *
+ * Keeps the predicted and filtered moments of the last lag + 1 steps in a
+ * ring buffer. Once the buffer is full, every update runs the RTS backward
+ * pass across the window and emits the smoothed estimate of the step lag
+ * updates in the past, so each estimate is conditioned on lag later
+ * measurements. Memory is bounded by the lag and the per-step cost is
+ * O(lag * n^3), independent of the stream length.
+ */
+class FixedLagSmoother {
+public:
+    /**
+     * @param state_dim State dimension.
+     * @param lag Number of later measurements each estimate is smoothed with.
+     */
+    FixedLagSmoother(int state_dim, int lag);
+
+    /**
+     * @brief Fixed-lag smoother for a fixed transition matrix A.
+     */
+    FixedLagSmoother(const Eigen::MatrixXd& A, int lag);
+
+    /**
+     * @brief Records the prediction into the next step.
+     * @param F Transition matrix (or Jacobian) used by the prediction.
+     */
+    void addPrediction(const Eigen::MatrixXd& F, const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Records the prediction with the fixed transition matrix.
+     */
+    void addPrediction(const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Records the filtered moments of the current step.
+     * @return true if a lagged smoothed estimate became available.
+     */
+    bool addUpdate(const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Predicts and updates the filter and records the step.
+     * @return true if a lagged smoothed estimate became available.
+     */
+    bool step(KalmanFilter& kf, const Eigen::VectorXd& y);
+    bool step(ExtendedKalmanFilter& ekf, const Eigen::VectorXd& z);
+
+    /**
+     * @brief Discards the window.
+     */
+    void clear();
+
+    int lag() const;
+
+    /**
+     * @brief Index of the step of the latest smoothed estimate, counting
+     * updates since construction or clear().
+     */
+    long index() const;
+
+    /**
+     * @brief Returns the latest smoothed state.
+     */
+    const Eigen::VectorXd& state() const;
+
+    /**
+     * @brief Returns the latest smoothed covariance.
+     */
+    const Eigen::MatrixXd& covariance() const;
+
+private:
+    int slot(long step) const;
+
+    int n_;
+    int lag_;
+    int window_;         // lag + 1 slots
+    long steps_ = 0;     // recorded updates
+    long predictions_ = 0;
+    bool fixed_transition_;
+
+    Eigen::MatrixXd A_;            // fixed transition
+    Eigen::MatrixXd F_;            // ring of transitions, n x (n * window)
+    Eigen::MatrixXd x_predicted_;  // ring, n x window
+    Eigen::MatrixXd P_predicted_;  // ring, n x (n * window)
+    Eigen::MatrixXd x_filtered_;   // ring, n x window
+    Eigen::MatrixXd P_filtered_;   // ring, n x (n * window)
+
+    Eigen::VectorXd x_;      // smoothed estimate, also the backward pass carry
+    Eigen::MatrixXd P_;
+    Eigen::VectorXd x_next_;
+    Eigen::MatrixXd P_next_;
+    RtsBackwardStep backward_;
+};
+
+#endif // FIXED_LAG_SMOOTHER_H
@@ -0,0 +1,150 @@
+#ifndef INFORMATION_FILTER_H
+#define INFORMATION_FILTER_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include <base_kalman_filter.h>
+#include <kalman_filter.h>
+
+/**
+ * @brief Sum of measurement contributions in information form.
+ *
+ * Each thread can own one contribution, accumulate its sensors into it via
+ * InformationFilter::accumulate() and hand it to InformationFilter::fuse().
+ */
+struct InformationContribution {
+    explicit InformationContribution(int state_dim)
+        : Y(Eigen::MatrixXd::Zero(state_dim, state_dim)), y(Eigen::VectorXd::Zero(state_dim)) {}
+
+    void clear() {
+        Y.setZero();
+        y.setZero();
+    }
+
+    Eigen::MatrixXd Y; // sum of C' R^-1 C
+    Eigen::VectorXd y; // sum of C' R^-1 z
+};
+
+/**
+ * @brief Kalman filter in information form for multi-sensor fusion.
+ *
+ * Keeps the information matrix Y = P^-1 and vector y = P^-1 x. A measurement
+ * adds C' R^-1 C to Y and C' R^-1 z to y, so contributions of many sensors
+ * are additive, order independent and can be accumulated concurrently.
+ * The state and covariance are solved for lazily on read-out, once per
+ * batch of updates.
+ */
+class InformationFilter : public BaseKalmanFilter {
+public:
+    /**
+     * @brief Constructor for the Information Filter.
+     * @param dt Time step (e.g., in seconds).
+     * @param A State transition matrix.
+     * @param C Observation matrix of the default sensor.
+     * @param Q Process noise covariance matrix.
+     * @param R Measurement noise covariance matrix of the default sensor.
+     * @param P Initial estimate error covariance matrix.
+     */
+    InformationFilter(double dt,
+                      const Eigen::MatrixXd& A,
+                      const Eigen::MatrixXd& C,
+                      const Eigen::MatrixXd& Q,
+                      const Eigen::MatrixXd& R,
+                      const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Converts a KalmanFilter, taking over its model, state and covariance.
+     */
+    explicit InformationFilter(const KalmanFilter& kf);
+
+    /**
+     * @brief Converts back to a KalmanFilter with the default sensor.
+     */
+    KalmanFilter toKalmanFilter() const;
+
+    /**
+     * @brief Initializes the filter with an initial state.
+     * @param x0 Initial state vector.
+     */
+    void init(const Eigen::VectorXd& x0);
+
+    /**
+     * @brief Registers an additional sensor.
+     * @param C Observation matrix of the sensor.
+     * @param R Measurement noise covariance matrix of the sensor.
+     * @return Sensor index; the constructor's sensor has index 0.
+     */
+    int addSensor(const Eigen::MatrixXd& C, const Eigen::MatrixXd& R);
+
+    /**
+     * @brief Predicts the next state.
+     */
+    void predict() override;
+
+    /**
+     * @brief Updates with a measurement of the default sensor.
+     */
+    void update(const Eigen::VectorXd& z) override;
+
+    /**
+     * @brief Updates with a measurement of a registered sensor.
+     */
+    void update(int sensor, const Eigen::VectorXd& z);
+
+    /**
+     * @brief Adds the contribution of one measurement to out.
+     *
+     * Does not modify the filter, so it may be called from many threads
+     * at once as long as each uses its own contribution.
+     */
+    void accumulate(int sensor, const Eigen::VectorXd& z, InformationContribution& out) const;
+
+    /**
+     * @brief Adds accumulated measurement contributions to the filter.
+     */
+    void fuse(const InformationContribution& contribution);
+
+    /**
+     * @brief Returns the current state estimate, solving Y x = y if needed.
+     */
+    const Eigen::VectorXd& state() const override;
+
+    /**
+     * @brief Returns the current state covariance, inverting Y if needed.
+     */
+    const Eigen::MatrixXd& covariance() const override;
+
+    /**
+     * @brief Overwrites the estimate from moment form.
+     */
+    void setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) override;
+
+    const Eigen::MatrixXd& informationMatrix() const;
+    const Eigen::VectorXd& informationVector() const;
+
+private:
+    struct Sensor {
+        Eigen::MatrixXd C;
+        Eigen::MatrixXd R;
+        Eigen::MatrixXd CtRinv;  // C' R^-1
+        Eigen::MatrixXd CtRinvC; // C' R^-1 C
+    };
+
+    void solve() const;
+
+    double dt_;
+    Eigen::MatrixXd A_;
+    Eigen::MatrixXd Q_;
+    std::vector<Sensor> sensors_;
+
+    Eigen::MatrixXd Y_; // information matrix
+    Eigen::VectorXd y_; // information vector
+
+    // Moment form, recovered on demand
+    mutable bool solved_ = false;
+    mutable Eigen::VectorXd x_;
+    mutable Eigen::MatrixXd P_;
+    mutable Eigen::LLT<Eigen::MatrixXd> llt_;
+};
+
+#endif // INFORMATION_FILTER_H
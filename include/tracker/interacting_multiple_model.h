@@ -0,0 +1,111 @@
+#ifndef INTERACTING_MULTIPLE_MODEL_H
+#define INTERACTING_MULTIPLE_MODEL_H
+
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+#include <base_kalman_filter.h>
+#include <thread_pool.h>
+
+/**
+ * @brief Interacting Multiple Model estimator over a set of model filters.
+ *
+ * Every step follows the IMM cycle of Blom and Bar-Shalom:
+ *
+ *  1. predict() mixes the model-conditioned estimates with the Markov
+ *     switching probabilities, hands every model its mixed prior through
+ *     setState() and predicts it;
+ *  2. update() updates every model and reweights the model probabilities
+ *     with the measurement likelihoods, evaluated in log space;
+ *  3. both steps moment-match the models into the combined estimate
+ *     returned by state() and covariance().
+ *
+ * The models may be any BaseKalmanFilter providing logLikelihood() and
+ * must share the state dimension. All mixing and combination workspaces
+ * are sized in the constructor, so a step allocates nothing beyond what
+ * the models themselves do. With a thread pool the per-model mixing,
+ * prediction and update run concurrently; each model is only touched by
+ * one thread at a time. Zero entries of the transition matrix are skipped
+ * while mixing, which keeps banded switching structures linear in the
+ * number of models.
+ */
+class InteractingMultipleModel : public BaseKalmanFilter {
+public:
+    /**
+     * @param models Model-conditioned filters, initialized by the caller.
+     * @param transition Markov matrix, entry (i, j) the probability of
+     *        switching from model i to model j; rows sum to one.
+     * @param probabilities Initial model probabilities.
+     */
+    InteractingMultipleModel(std::vector<std::unique_ptr<BaseKalmanFilter>> models,
+                             const Eigen::MatrixXd& transition,
+                             const Eigen::VectorXd& probabilities);
+
+    /**
+     * @brief Runs the per-model work on a pool; nullptr runs it serially.
+     * The pool must outlive the estimator.
+     */
+    void setThreadPool(ThreadPool* pool);
+
+    void predict() override;
+    void update(const Eigen::VectorXd& z) override;
+
+    /**
+     * @brief Returns the combined state estimate.
+     */
+    const Eigen::VectorXd& state() const override;
+
+    /**
+     * @brief Returns the combined covariance, including the spread of the
+     * model estimates.
+     */
+    const Eigen::MatrixXd& covariance() const override;
+
+    /**
+     * @brief Sets every model to the same estimate; probabilities are kept.
+     */
+    void setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) override;
+
+    /**
+     * @brief Returns the log-likelihood of the last measurement under the
+     * model mixture.
+     */
+    double logLikelihood() const override;
+
+    int modelCount() const;
+    BaseKalmanFilter& model(int j);
+    const BaseKalmanFilter& model(int j) const;
+
+    /**
+     * @brief Returns the current model probabilities.
+     */
+    const Eigen::VectorXd& modelProbabilities() const;
+
+private:
+    using Step = void (InteractingMultipleModel::*)(int);
+    void runModels(Step step);
+    void mix(int j);
+    void predictModel(int j);
+    void updateModel(int j);
+    void combine();
+
+    std::vector<std::unique_ptr<BaseKalmanFilter>> models_;
+    Eigen::MatrixXd transition_;
+    Eigen::VectorXd mu_;      // model probabilities
+    ThreadPool* pool_ = nullptr;
+    Step step_ = nullptr;     // per-model step of the running pass
+
+    Eigen::VectorXd x_;       // combined state
+    Eigen::MatrixXd P_;       // combined covariance
+    double log_likelihood_ = 0.0;
+
+    // Per-model workspaces, column or entry j belongs to model j
+    Eigen::VectorXd c_;                    // predicted model probabilities
+    std::vector<Eigen::VectorXd> x_mixed_; // mixed prior means
+    std::vector<Eigen::MatrixXd> P_mixed_; // mixed prior covariances
+    Eigen::MatrixXd spread_;               // mean offsets of the mixing and combination
+    Eigen::VectorXd log_l_;                // measurement log-likelihoods
+    const Eigen::VectorXd* z_ = nullptr;   // measurement of the running update
+};
+
+#endif // INTERACTING_MULTIPLE_MODEL_H
@@ -0,0 +1,153 @@
+#ifndef KALMAN_CORRECTOR_H
+#define KALMAN_CORRECTOR_H
+
+#include <Eigen/Dense>
+
+/**
+ * @brief How the Kalman gain is obtained from the innovation covariance S.
+ */
+enum class GainSolver {
+    Inverse, // Explicit S^-1, the original behaviour
+    LLT,     // Cholesky solve, requires S positive definite
+    LDLT     // Pivoted LDL' solve, tolerates nearly singular but positive definite S
+};
+
+/**
+ * @brief How the state covariance is corrected once the gain is known.
+ */
+enum class CovarianceUpdate {
+    Standard,  // P = (I - K C) P
+    Joseph,    // P = (I - K C) P (I - K C)' + K R K', valid for any gain
+    Symmetric  // P = P - K S K', lower triangle only, then mirrored; saves
+               // work with the LLT and LDLT solvers, not with Inverse
+};
+
+/**
+ * @brief Selects the numerical method of the measurement update.
+ */
+struct UpdateStrategy {
+    GainSolver solver = GainSolver::Inverse;
+    CovarianceUpdate covariance = CovarianceUpdate::Standard;
+};
+
+/**
+ * @brief Measurement correction shared by the Kalman filter variants.
+ *
+ * Owns the workspaces of the update so that, once sized, repeated
+ * corrections with the LLT or LDLT solvers do not allocate. The gain is
+ * kept transposed (m x n) so it can be produced by solving S * K' = C * P
+ * directly.
+ */
+class KalmanCorrector {
+public:
+    void setStrategy(const UpdateStrategy& strategy);
+    const UpdateStrategy& strategy() const;
+
+    /**
+     * @brief Corrects x and P for a linear(ized) measurement.
+     * @param x State estimate, updated in place.
+     * @param P State covariance, updated in place.
+     * @param C Observation matrix (or its Jacobian).
+     * @param R Measurement noise covariance.
+     * @param innovation Measurement residual y - h(x).
+     */
+    void correct(Eigen::VectorXd& x,
+                 Eigen::MatrixXd& P,
+                 const Eigen::MatrixXd& C,
+                 const Eigen::MatrixXd& R,
+                 const Eigen::VectorXd& innovation);
+
+    /**
+     * @brief Corrects x and P given the state/measurement cross covariance
+     * and innovation covariance, as produced by sigma-point filters.
+     *
+     * Joseph form needs an observation matrix, so it falls back to the
+     * symmetric update here.
+     */
+    void correctWithCrossCovariance(Eigen::VectorXd& x,
+                                    Eigen::MatrixXd& P,
+                                    const Eigen::MatrixXd& Pxz,
+                                    const Eigen::MatrixXd& S,
+                                    const Eigen::VectorXd& innovation);
+
+    /**
+     * @brief Corrects x and P one scalar measurement at a time.
+     *
+     * Valid when the measurement noise is diagonal. Each channel is a
+     * rank-1 update of the lower triangle of P, O(m * n^2) overall, with
+     * no m x m matrix formed. Channels whose measurement is NaN are
+     * skipped.
+     * @param y Measurement vector.
+     * @param r Diagonal of the measurement noise covariance.
+     */
+    void correctSequential(Eigen::VectorXd& x,
+                           Eigen::MatrixXd& P,
+                           const Eigen::MatrixXd& C,
+                           const Eigen::VectorXd& r,
+                           const Eigen::VectorXd& y);
+
+    /**
+     * @brief Innovation covariance of the last correct() call.
+     */
+    const Eigen::MatrixXd& innovationCovariance() const;
+
+    /**
+     * @brief Log-likelihood of the innovation of the last correction, 0
+     * before the first one.
+     *
+     * Evaluated on demand from the factorization of S made for the gain
+     * (the LU decomposition inverted by the Inverse solver), so corrections
+     * that never ask for it pay nothing.
+     */
+    double logLikelihood() const;
+
+private:
+    void computeGain(const Eigen::MatrixXd& S);
+    void subtractGainTerm(Eigen::MatrixXd& P, bool lower_only);
+
+    UpdateStrategy strategy_;
+
+    Eigen::MatrixXd CP_;   // C * P, m x n
+    Eigen::MatrixXd S_;    // Innovation covariance, m x m
+    Eigen::MatrixXd Sinv_; // S^-1 for the Inverse solver
+    Eigen::PartialPivLU<Eigen::MatrixXd> lu_; // factor behind Sinv_
+    Eigen::MatrixXd Kt_;   // Transposed gain, m x n
+    Eigen::MatrixXd W_;    // whitened C * P for the symmetric LLT and LDLT updates
+    Eigen::MatrixXd IKC_;  // I - K * C
+    Eigen::MatrixXd KR_;   // K * R
+    Eigen::MatrixXd tmp_;  // n x n scratch
+    Eigen::VectorXd pc_;   // P * c' for one measurement row
+    Eigen::VectorXd nu_;   // innovation of the last correction
+    Eigen::LLT<Eigen::MatrixXd> llt_;
+    Eigen::LDLT<Eigen::MatrixXd> ldlt_;
+
+    // Likelihood of the last correction
+    bool has_innovation_ = false;      // whether any correction has run
+    bool sequential_ = false;          // accumulated by correctSequential()
+    double sequential_likelihood_ = 0.0;
+    mutable Eigen::VectorXd v_;
+};
+
+/**
+ * @brief Copies the lower triangle of a square matrix into its upper triangle.
+ */
+void mirrorLowerTriangle(Eigen::MatrixXd& P);
+
+/**
+ * @brief Returns log N(innovation; 0, S) given the Cholesky factor of S.
+ * @param work Scratch vector, resized to the innovation size.
+ */
+double gaussianLogLikelihood(const Eigen::LLT<Eigen::MatrixXd>& S,
+                             const Eigen::VectorXd& innovation,
+                             Eigen::VectorXd& work);
+
+/**
+ * @brief Returns log N(innovation; 0, L * L') given the lower-triangular
+ * factor L; only its lower triangle is read.
+ * @param work Scratch vector, resized to the innovation size.
+ */
+double gaussianLogLikelihood(const Eigen::MatrixXd& L,
+                             const Eigen::VectorXd& innovation,
+                             Eigen::VectorXd& work);
+
+#endif // KALMAN_CORRECTOR_H
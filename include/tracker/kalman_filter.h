@@ -1,11 +1,25 @@
 #ifndef KALMAN_FILTER_H
 #define KALMAN_FILTER_H
 
+#include <deque>
+#include <vector>
 #include <Eigen/Dense>
 #include <base_kalman_filter.h>
+#include <discretization_cache.h>
+#include <kalman_corrector.h>
 
 class KalmanFilter : public BaseKalmanFilter {
-public:/**
+public:
+    /**
+     * @brief Whether measurements are processed one channel at a time.
+     */
+    enum class SequentialMode {
+        Off,  // Joint update of the whole measurement vector
+        Auto, // Sequential whenever R is diagonal
+        On    // Always sequential, R must be diagonal
+    };
+
+    /**
      * @brief Constructor for the Kalman Filter.
      * @param dt Time step (e.g., in seconds).
      * @param A State transition matrix.
@@ -27,6 +41,60 @@ public:/**
      */
     void init(const Eigen::VectorXd& x0);
 
+    /**
+     * @brief Initializes the filter with an initial state and covariance.
+     * @param x0 Initial state vector.
+     * @param P0 Initial estimate error covariance matrix.
+     */
+    void init(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0);
+
+    /**
+     * @brief Initializes state, covariance and the filter clock.
+     * @param t0 Time of the initial estimate.
+     */
+    void init(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0, double t0);
+
+    /**
+     * @brief Sets a continuous-time model dx = Ac x dt + dw, E[dw dw'] = Qc dt.
+     *
+     * Once set, predict() advances by the constructor's dt and the
+     * timestamped predictTo()/update(t, y) discretize the model for each
+     * interval with Van Loan's method, caching the result per interval.
+     * @param cache_size Number of distinct intervals kept in the LRU cache.
+     */
+    void setContinuousModel(const Eigen::MatrixXd& Ac, const Eigen::MatrixXd& Qc, int cache_size = 8);
+
+    /**
+     * @brief Predicts the state at time t.
+     */
+    void predictTo(double t);
+
+    /**
+     * @brief Predicts to the measurement time and updates.
+     *
+     * A measurement older than the filter time is applied out of sequence
+     * by rewinding to the stored posterior preceding it and replaying the
+     * later measurements, which requires setHistoryLength().
+     * @return false if the measurement is older than the stored history.
+     */
+    bool update(double t, const Eigen::VectorXd& y);
+
+    /**
+     * @brief Keeps the posteriors of the last length timestamped updates
+     * for out-of-sequence measurements; 0 disables.
+     */
+    void setHistoryLength(int length);
+
+    /**
+     * @brief Returns the time of the current estimate.
+     */
+    double time() const;
+
+    /**
+     * @brief Returns the interval discretization cache.
+     */
+    const DiscretizationCache& discretizationCache() const;
+
     /**
      * @brief Predicts the next state.
      */
@@ -38,6 +106,71 @@ public:/**
      */
     void update(const Eigen::VectorXd& y) override;
 
+    /**
+     * @brief Selects the gain solver and covariance update form.
+     * @param strategy Update strategy, defaults to explicit inverse.
+     */
+    void setUpdateStrategy(const UpdateStrategy& strategy);
+    const UpdateStrategy& updateStrategy() const;
+
+    /**
+     * @brief Selects sequential scalar processing of the measurement.
+     *
+     * In sequential mode each channel is applied as a rank-1 covariance
+     * update and NaN channels of the measurement are skipped, so partially
+     * missing measurements need no change to C.
+     * @param mode Sequential mode, Off by default.
+     */
+    void setSequentialMode(SequentialMode mode);
+
+    /**
+     * @brief Switches to the steady-state gain of the time-invariant model.
+     *
+     * Solves the discrete algebraic Riccati equation once and caches the
+     * gain and the steady predicted/filtered covariances. From then on
+     * predict() and update() only propagate the state, one matrix-vector
+     * product each. A measurement with NaN channels drops back to the
+     * regular update, starting from the steady covariance of the current
+     * step and correcting with the measured channels only.
+     */
+    void enableSteadyState();
+
+    /**
+     * @brief Enables the automatic switch to the steady-state gain.
+     * @param tolerance Relative change of the filtered covariance between
+     *        two updates below which the gain is frozen; 0 disables.
+     */
+    void setSteadyStateTolerance(double tolerance);
+
+    /**
+     * @brief Returns whether the filter runs on the steady-state gain.
+     */
+    bool isSteadyState() const;
+
+    /**
+     * @brief Filters a whole measurement sequence in one call.
+     *
+     * Runs predict() and update() for every column of Y and writes each
+     * filtered mean into the matching column of means. The outputs may be
+     * Eigen::Map views of caller memory (or a MappedMatrix); once the
+     * workspaces are sized by the first step, the loop does not allocate
+     * with the LLT or LDLT gain solvers. Filtering consecutive column
+     * blocks of a sequence is equivalent to filtering it whole, which
+     * allows input larger than memory to be streamed in chunks.
+     * @param Y Measurements, one column per time step.
+     * @param means Filtered states, n x Y.cols().
+     */
+    void filter(const Eigen::Ref<const Eigen::MatrixXd>& Y, Eigen::Ref<Eigen::MatrixXd> means);
+
+    /**
+     * @brief Filters a whole measurement sequence, also writing the
+     * diagonal of every filtered covariance.
+     * @param variances Filtered variances, n x Y.cols().
+     */
+    void filter(const Eigen::Ref<const Eigen::MatrixXd>& Y,
+                Eigen::Ref<Eigen::MatrixXd> means,
+                Eigen::Ref<Eigen::MatrixXd> variances);
+
     /**
      * @brief Returns the current state estimate.
      */
@@ -45,9 +178,28 @@ public:/**
 
 
     /**
-     * @brief Returns the current state estimate.
+     * @brief Returns the current state covariance.
      */
     const Eigen::MatrixXd& covariance() const override;
+
+    /**
+     * @brief Overwrites the state and covariance, same as init(x, P).
+     */
+    void setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) override;
+
+    /**
+     * @brief Returns the log-likelihood of the last measurement.
+     */
+    double logLikelihood() const override;
+
+    // Model accessors
+    double timeStep() const { return dt; }
+    // Transition of the last prediction: with a continuous model, the
+    // discretization over the last interval once one has been propagated
+    const Eigen::MatrixXd& transitionMatrix() const { return A_discrete.size() > 0 ? A_discrete : A; }
+    const Eigen::MatrixXd& observationMatrix() const { return C; }
+    const Eigen::MatrixXd& processNoise() const { return Q; }
+    const Eigen::MatrixXd& measurementNoise() const { return R; }
 private:
     // Time step
     double dt;
@@ -61,6 +213,51 @@ private:
     Eigen::MatrixXd C; // observation matrix
     Eigen::MatrixXd Q; // process noise covariance
     Eigen::MatrixXd R; // measurement noise covariance
+
+    // Measurement update
+    Eigen::VectorXd innovation; // last measurement residual
+    KalmanCorrector corrector;  // gain and covariance correction
+    Eigen::VectorXd R_diagonal; // diagonal of R for sequential updates
+    bool sequential = false;    // whether update() runs channel by channel
+    std::vector<Eigen::Index> measured_channels; // non-NaN channels of a partial measurement
+    Eigen::MatrixXd C_measured; // rows of C for the measured channels
+    Eigen::MatrixXd R_measured; // R restricted to the measured channels
+    Eigen::VectorXd x_next;     // predicted state workspace
+    Eigen::MatrixXd AP;         // A * P workspace of the prediction
+
+    // Batch filtering
+    void filterSequence(const Eigen::Ref<const Eigen::MatrixXd>& Y,
+                        Eigen::Ref<Eigen::MatrixXd> means,
+                        Eigen::Ref<Eigen::MatrixXd>* variances);
+    Eigen::VectorXd y_step;     // measurement of the current batch step
+
+    // Steady-state operation
+    void enterSteadyState(const Eigen::MatrixXd& P_predicted);
+    bool steady = false;                 // whether the cached gain is in use
+    bool predicted = false;              // whether the last step was predict()
+    double steady_tolerance = 0.0;       // relative covariance change for the automatic switch
+    Eigen::MatrixXd K_steady;            // steady-state gain
+    Eigen::LLT<Eigen::MatrixXd> S_steady; // factor of the steady innovation covariance
+    bool steady_update = false;          // whether the last update used the steady gain
+    mutable Eigen::VectorXd likelihood_work; // whitened innovation scratch
+    Eigen::MatrixXd P_steady_predicted;  // steady-state predicted covariance
+    Eigen::MatrixXd P_steady_filtered;   // steady-state filtered covariance
+    Eigen::MatrixXd P_previous;          // filtered covariance of the previous update
+
+    // Timestamped operation
+    struct HistoryEntry {
+        double t;          // measurement time
+        Eigen::VectorXd y; // measurement, empty for the initial estimate
+        Eigen::VectorXd x; // posterior state
+        Eigen::MatrixXd P; // posterior covariance
+    };
+    void propagate(const DiscretizationCache::Discretization& model);
+    void record(double t_measured, const Eigen::VectorXd& y);
+    double t = 0.0;                         // time of the current estimate
+    DiscretizationCache discretization;     // continuous model per interval
+    Eigen::MatrixXd A_discrete;             // discrete transition of the last propagation
+    std::size_t history_length = 0;         // posteriors kept for out-of-sequence updates
+    std::deque<HistoryEntry> history;       // oldest first
 };
 
 #endif // KALMAN_FILTER_H
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef KALMAN_FILTER_ADAPTER_H
+#define KALMAN_FILTER_ADAPTER_H
+
+#include <Eigen/Dense>
+#include <base_kalman_filter.h>
+
+/**
+ * @brief Exposes a statically dispatched filter through BaseKalmanFilter.
+ *
+ * The wrapped filter keeps its own (typically fixed-size) storage; the
+ * adapter mirrors state and covariance into dynamic matrices after every
+ * step so references returned by state() and covariance() stay valid.
+ * After the first step the mirrors are reused and no further allocation
+ * takes place. Initialize the filter before wrapping it; changes made
+ * through filter() are only mirrored on the next predict() or update().
+ *
+ * @tparam Filter Filter type providing predict(), update(), init(x, P),
+ *                state(), covariance() and the Scalar/MeasurementVector
+ *                aliases.
+ */
+template <typename Filter>
+class KalmanFilterAdapter : public BaseKalmanFilter {
+public:
+    explicit KalmanFilterAdapter(const Filter& filter)
+        : filter_(filter) {
+        sync();
+    }
+
+    void predict() override {
+        filter_.predict();
+        sync();
+    }
+
+    void update(const Eigen::VectorXd& z) override {
+        z_ = z.template cast<typename Filter::Scalar>();
+        filter_.update(z_);
+        sync();
+    }
+
+    const Eigen::VectorXd& state() const override {
+        return x_;
+    }
+
+    const Eigen::MatrixXd& covariance() const override {
+        return P_;
+    }
+
+    void setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) override {
+        filter_.init(x.template cast<typename Filter::Scalar>(),
+                     P.template cast<typename Filter::Scalar>());
+        sync();
+    }
+
+    /**
+     * @brief Returns the wrapped filter.
+     */
+    Filter& filter() {
+        return filter_;
+    }
+
+    const Filter& filter() const {
+        return filter_;
+    }
+
+private:
+    void sync() {
+        x_ = filter_.state().template cast<double>();
+        P_ = filter_.covariance().template cast<double>();
+    }
+
+    Filter filter_;
+    typename Filter::MeasurementVector z_;
+    Eigen::VectorXd x_;
+    Eigen::MatrixXd P_;
+};
+
+#endif // KALMAN_FILTER_ADAPTER_H
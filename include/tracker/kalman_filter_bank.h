@@ -0,0 +1,131 @@
+#ifndef KALMAN_FILTER_BANK_H
+#define KALMAN_FILTER_BANK_H
+
+#include <Eigen/Dense>
+
+/**
+ * @brief Many independent Kalman filters sharing one linear model.
+ *
+ * States and covariances are kept structure-of-arrays: states() holds one
+ * row per filter and one column per state component, and the covariances
+ * store the packed lower triangle the same way. predict() and update()
+ * sweep over blocks of filters so that every arithmetic operation is a
+ * contiguous, vectorizable array operation across filters. A, C, Q and R
+ * are stored once for the whole bank.
+ *
+ * The update uses a per-filter Cholesky factorization of the innovation
+ * covariance evaluated lane-wise across the block, so no matrix is ever
+ * inverted.
+ */
+class KalmanFilterBank {
+public:
+    using Mask = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+    /**
+     * @brief Constructor for the filter bank.
+     * @param num_filters Number of filters in the bank.
+     * @param A State transition matrix.
+     * @param C Observation matrix.
+     * @param Q Process noise covariance matrix.
+     * @param R Measurement noise covariance matrix.
+     * @param P Initial estimate error covariance matrix of every filter.
+     */
+    KalmanFilterBank(int num_filters,
+                     const Eigen::MatrixXd& A,
+                     const Eigen::MatrixXd& C,
+                     const Eigen::MatrixXd& Q,
+                     const Eigen::MatrixXd& R,
+                     const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Initializes one filter with a state and the initial covariance.
+     * @param i Filter index.
+     * @param x0 Initial state vector.
+     */
+    void init(int i, const Eigen::VectorXd& x0);
+
+    /**
+     * @brief Overwrites the state and covariance of one filter.
+     */
+    void setState(int i, const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Changes the number of filters. Existing filters keep their
+     * estimates; new filters start at zero with the initial covariance.
+     */
+    void resize(int num_filters);
+
+    /**
+     * @brief Predicts the next state of every filter.
+     */
+    void predict();
+
+    /**
+     * @brief Updates every filter with its measurement.
+     * @param Y Measurements, one row per filter.
+     */
+    void update(const Eigen::MatrixXd& Y);
+
+    /**
+     * @brief Updates only the filters selected by mask. Rows of Y for
+     * unselected filters are ignored and may hold NaN.
+     */
+    void update(const Eigen::MatrixXd& Y, const Mask& mask);
+
+    /**
+     * @brief Computes the predicted measurement C x and the innovation
+     * covariance C P C' + R of every filter.
+     * @param Z Predicted measurements, resized to one row per filter.
+     * @param S Innovation covariances, resized to one row per filter
+     *          holding the m x m matrix in column-major order.
+     */
+    void predictMeasurements(Eigen::MatrixXd& Z, Eigen::MatrixXd& S) const;
+
+    /**
+     * @brief Returns the number of filters.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns the state estimate of one filter.
+     */
+    Eigen::VectorXd state(int i) const;
+
+    /**
+     * @brief Returns the state covariance of one filter.
+     */
+    Eigen::MatrixXd covariance(int i) const;
+
+    /**
+     * @brief Returns all state estimates, one row per filter.
+     */
+    const Eigen::MatrixXd& states() const;
+
+private:
+    void predictBlock(int begin, int len);
+    void updateBlock(int begin, int len, const Eigen::MatrixXd& Y, const Mask* mask);
+
+    int n_; // State dimension
+    int m_; // Measurement dimension
+    int num_filters_;
+
+    // Shared model
+    Eigen::MatrixXd A_;
+    Eigen::MatrixXd C_;
+    Eigen::MatrixXd Q_;
+    Eigen::MatrixXd R_;
+    Eigen::MatrixXd P0_;
+
+    Eigen::MatrixXd x_;       // num_filters x n
+    Eigen::MatrixXd P_;       // num_filters x n(n+1)/2, packed lower triangle
+    Eigen::MatrixXi packed_;  // column of P_ holding element (i, j)
+
+    // Per-block workspaces, one column per matrix element
+    Eigen::MatrixXd xb_;  // predicted states
+    Eigen::MatrixXd AP_;  // A * P, n x n
+    Eigen::MatrixXd W_;   // L^-1 * C * P, m x n
+    Eigen::MatrixXd S_;   // innovation covariance and its factor, m x m
+    Eigen::MatrixXd nu_;  // innovation, whitened in place
+};
+
+#endif // KALMAN_FILTER_BANK_H
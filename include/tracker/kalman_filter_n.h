@@ -0,0 +1,107 @@
+#ifndef KALMAN_FILTER_N_H
+#define KALMAN_FILTER_N_H
+
+#include <Eigen/Dense>
+
+/**
+ * @brief Kalman filter with compile-time state and measurement dimensions.
+ *
+ * Every vector, matrix and temporary is a fixed-size Eigen type, so
+ * predict() and update() run on the stack and never touch the allocator.
+ * The interface mirrors KalmanFilter and is resolved statically; wrap the
+ * filter in KalmanFilterAdapter to use it through BaseKalmanFilter.
+ *
+ * @tparam Nx State dimension.
+ * @tparam Nz Measurement dimension.
+ * @tparam Scalar_ Floating point type of the filter.
+ */
+template <int Nx, int Nz, typename Scalar_ = double>
+class KalmanFilterN {
+public:
+    using Scalar = Scalar_;
+    using StateVector = Eigen::Matrix<Scalar, Nx, 1>;
+    using StateMatrix = Eigen::Matrix<Scalar, Nx, Nx>;
+    using MeasurementVector = Eigen::Matrix<Scalar, Nz, 1>;
+    using MeasurementMatrix = Eigen::Matrix<Scalar, Nz, Nx>;
+    using MeasurementCovariance = Eigen::Matrix<Scalar, Nz, Nz>;
+    using GainMatrix = Eigen::Matrix<Scalar, Nx, Nz>;
+
+    /**
+     * @brief Constructor for the fixed-size Kalman Filter.
+     * @param A State transition matrix.
+     * @param C Observation matrix.
+     * @param Q Process noise covariance matrix.
+     * @param R Measurement noise covariance matrix.
+     * @param P Initial estimate error covariance matrix.
+     */
+    KalmanFilterN(const StateMatrix& A,
+                  const MeasurementMatrix& C,
+                  const StateMatrix& Q,
+                  const MeasurementCovariance& R,
+                  const StateMatrix& P)
+        : x(StateVector::Zero()), P(P), A(A), C(C), Q(Q), R(R) {}
+
+    /**
+     * @brief Initializes the filter with an initial state.
+     * @param x0 Initial state vector.
+     */
+    void init(const StateVector& x0) {
+        x = x0;
+    }
+
+    /**
+     * @brief Initializes the filter with an initial state and covariance.
+     */
+    void init(const StateVector& x0, const StateMatrix& P0) {
+        x = x0;
+        P = P0;
+    }
+
+    /**
+     * @brief Predicts the next state.
+     */
+    void predict() {
+        x = A * x;
+        P = A * P * A.transpose() + Q;
+    }
+
+    /**
+     * @brief Updates the state with a new measurement.
+     * @param y Measurement vector.
+     */
+    void update(const MeasurementVector& y) {
+        const MeasurementMatrix CP = C * P;
+        const MeasurementCovariance S = CP * C.transpose() + R;
+        const GainMatrix K = CP.transpose() * S.inverse();
+
+        x += K * (y - C * x);
+        P -= K * CP;
+    }
+
+    /**
+     * @brief Returns the current state estimate.
+     */
+    const StateVector& state() const {
+        return x;
+    }
+
+    /**
+     * @brief Returns the current state covariance.
+     */
+    const StateMatrix& covariance() const {
+        return P;
+    }
+
+private:
+    // State vectors
+    StateVector x; // state vector
+    StateMatrix P; // estimate error covariance
+
+    // System matrices
+    StateMatrix A;           // state transition matrix
+    MeasurementMatrix C;     // observation matrix
+    StateMatrix Q;           // process noise covariance
+    MeasurementCovariance R; // measurement noise covariance
+};
+
+#endif // KALMAN_FILTER_N_H
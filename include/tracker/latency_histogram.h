@@ -0,0 +1,51 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Histogram of latencies in power-of-two nanosecond buckets.
+ *
+ * Bucket b counts latencies in [2^b, 2^(b+1)) ns, bucket 0 also holding
+ * 0 ns. Recording is a relaxed atomic increment, so one thread can record
+ * while others read; a reader sees a slightly stale but consistent-enough
+ * view for monitoring.
+ */
+class LatencyHistogram {
+public:
+    static const int kBuckets = 64;
+
+    /**
+     * @brief Records one latency.
+     */
+    void record(std::int64_t nanoseconds);
+
+    /**
+     * @brief Returns the number of recorded latencies.
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @brief Returns the count of one bucket.
+     */
+    std::uint64_t bucket(int b) const;
+
+    /**
+     * @brief Returns the upper bound in nanoseconds of the bucket holding
+     * the given quantile, or 0 if nothing was recorded.
+     * @param q Quantile in [0, 1].
+     */
+    std::int64_t quantile(double q) const;
+
+    /**
+     * @brief Clears all buckets.
+     */
+    void reset();
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets_{};
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,64 @@
+#ifndef MAPPED_MATRIX_H
+#define MAPPED_MATRIX_H
+
+#include <string>
+#include <Eigen/Dense>
+
+/**
+ * @brief Column-major matrix of doubles backed by a memory-mapped file.
+ *
+ * The file holds the raw matrix data with no header, one column after
+ * another, so a recorded measurement series with one column per time step
+ * can be handed to KalmanFilter::filter() without being read into memory.
+ * The mapping is advised for sequential access; the kernel pages columns
+ * in ahead of the filter and may drop them once they have been passed,
+ * so files larger than memory can be processed.
+ */
+class MappedMatrix {
+public:
+    /**
+     * @brief Maps an existing file read-only.
+     * @param path File of rows * cols doubles.
+     * @param rows Number of rows; the column count follows from the file size.
+     */
+    MappedMatrix(const std::string& path, Eigen::Index rows);
+
+    /**
+     * @brief Creates (or truncates) a file of rows x cols doubles and maps
+     * it writable, e.g. as the output buffer of a batch filter run.
+     */
+    static MappedMatrix create(const std::string& path, Eigen::Index rows, Eigen::Index cols);
+
+    MappedMatrix(MappedMatrix&& other) noexcept;
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept;
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+    ~MappedMatrix();
+
+    Eigen::Index rows() const;
+    Eigen::Index cols() const;
+
+    /**
+     * @brief Returns a read-only view of the mapped data.
+     */
+    Eigen::Map<const Eigen::MatrixXd> matrix() const;
+
+    /**
+     * @brief Returns a writable view; throws std::logic_error for a
+     * read-only mapping.
+     */
+    Eigen::Map<Eigen::MatrixXd> mutableMatrix();
+
+private:
+    MappedMatrix() = default;
+    void map(int fd, bool writable);
+    void unmap();
+
+    double* data_ = nullptr;
+    std::size_t bytes_ = 0;
+    Eigen::Index rows_ = 0;
+    Eigen::Index cols_ = 0;
+    bool writable_ = false;
+};
+
+#endif // MAPPED_MATRIX_H
@@ -0,0 +1,112 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for many producers and one consumer.
+ *
+ * Vyukov's bounded queue: every cell carries a sequence number that tells
+ * producers and the consumer whether it is free or full, so a push is one
+ * compare-and-swap on the enqueue position and a pop needs no atomic
+ * read-modify-write at all. Pushes are linearizable, so items pushed by
+ * one thread are popped in the order they were pushed. Items are swapped
+ * in and out of the cells rather than moved, so heap buffers held by the
+ * items (e.g. Eigen vectors) circulate between the producers and the
+ * consumer instead of being reallocated.
+ *
+ * @tparam T Movable item type.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @param capacity Number of cells, rounded up to a power of two.
+     */
+    explicit MpscQueue(std::size_t capacity)
+        : cells_(roundUp(capacity)), mask_(cells_.size() - 1) {
+        for (std::size_t i = 0; i < cells_.size(); ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /**
+     * @brief Appends an item; may be called from any thread.
+     * @return false if the queue is full, in which case item is untouched.
+     */
+    bool push(T& item) {
+        std::size_t position = enqueue_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[position & mask_];
+            std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (difference == 0) {
+                if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+        std::swap(cell->value, item);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest item; only the consumer thread may call it.
+     * @return false if the queue is empty.
+     */
+    bool pop(T& item) {
+        Cell& cell = cells_[dequeue_ & mask_];
+        if (cell.sequence.load(std::memory_order_acquire) != dequeue_ + 1) {
+            return false;
+        }
+        std::swap(item, cell.value);
+        cell.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+        ++dequeue_;
+        return true;
+    }
+
+    /**
+     * @brief Returns whether the next pop() would fail; consumer only.
+     */
+    bool empty() const {
+        return cells_[dequeue_ & mask_].sequence.load(std::memory_order_acquire) != dequeue_ + 1;
+    }
+
+    std::size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    static std::size_t roundUp(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        return size;
+    }
+
+    struct Cell {
+        std::atomic<std::size_t> sequence{0};
+        T value{};
+    };
+
+    std::vector<Cell> cells_;
+    std::size_t mask_;
+    alignas(64) std::atomic<std::size_t> enqueue_{0};
+    alignas(64) std::size_t dequeue_ = 0; // consumer only
+};
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,135 @@
+#ifndef PARALLEL_KALMAN_FILTER_H
+#define PARALLEL_KALMAN_FILTER_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <rts_smoother.h>
+#include <thread_pool.h>
+
+/**
+ * @brief Parallel-in-time Kalman filter and RTS smoother for long offline
+ * sequences of a time-invariant linear model.
+ *
+ * Filtering and smoothing are written as prefix scans over the
+ * associative elements of Särkkä and García-Fernández: each filtering
+ * element (A, b, C, eta, J) is the conditional distribution of x_k given
+ * x_{k-1} and y_k together with the likelihood of y_k in x_{k-1}, and each
+ * smoothing element (E, g, L) the conditional of x_k given x_{k+1}. The
+ * scan is blocked into one chunk per pool thread:
+ *
+ *  1. every chunk folds its elements into one aggregate element, in parallel;
+ *  2. the aggregates are chained across chunks, giving the exact moments
+ *     at every chunk boundary;
+ *  3. every chunk runs the ordinary sequential recursion from its boundary,
+ *     in parallel.
+ *
+ * Phase 3 uses the same KalmanFilter and RtsBackwardStep code as the
+ * sequential path, so the results agree with it to rounding. The model,
+ * including its update strategy, is taken from a KalmanFilter; its
+ * continuous-time model and steady-state settings are not used.
+ * Measurements must not contain NaN.
+ */
+class ParallelKalmanFilter {
+public:
+    /**
+     * @param model Filter providing A, C, Q, R and the update strategy.
+     * @param pool Threads the chunks are distributed over.
+     */
+    ParallelKalmanFilter(const KalmanFilter& model, ThreadPool& pool);
+
+    /**
+     * @brief Sets the number of chunks; defaults to the pool size.
+     */
+    void setChunkCount(int chunks);
+
+    /**
+     * @brief Filters a sequence, one column of Y per step.
+     * @param x0 Initial state, before the first prediction.
+     * @param P0 Initial covariance.
+     */
+    void filter(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0, const Eigen::Ref<const Eigen::MatrixXd>& Y);
+
+    /**
+     * @brief Smooths the filtered sequence in place.
+     */
+    void smooth();
+
+    /**
+     * @brief Returns the number of steps of the last sequence.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns all states, one column per step; filtered before
+     * smooth() and smoothed after it.
+     */
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> states() const;
+
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, 1, true> state(int k) const;
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> covariance(int k) const;
+
+private:
+    // Filtering element: x_k | x_{k-1}, y_k ~ N(A x_{k-1} + b, C) and the
+    // likelihood of y_k as the information pair (eta, J) in x_{k-1}
+    struct FilterElement {
+        Eigen::MatrixXd A;
+        Eigen::VectorXd b;
+        Eigen::MatrixXd C;
+        Eigen::VectorXd eta;
+        Eigen::MatrixXd J;
+    };
+
+    // Smoothing element: x_k | x_{k+1} ~ N(E x_{k+1} + g, L)
+    struct SmoothElement {
+        Eigen::MatrixXd E;
+        Eigen::VectorXd g;
+        Eigen::MatrixXd L;
+    };
+
+    // Per-chunk scratch, reused across calls
+    struct Workspace {
+        FilterElement filter;
+        SmoothElement smooth;
+        Eigen::MatrixXd M;    // I + C * J and its inverse
+        Eigen::MatrixXd T1;   // A_j * M^-1
+        Eigen::MatrixXd T2;   // A_i' * M^-T
+        Eigen::MatrixXd tmp;
+        Eigen::VectorXd v;
+        Eigen::VectorXd y;
+        Eigen::PartialPivLU<Eigen::MatrixXd> lu;
+        Eigen::LLT<Eigen::MatrixXd> llt;
+        RtsBackwardStep backward;
+    };
+
+    int chunkBegin(int c) const;
+    void filterChunk(int c, const Eigen::VectorXd& x, const Eigen::MatrixXd& P, const Eigen::Ref<const Eigen::MatrixXd>& Y);
+    void aggregateFilterChunk(int c, const Eigen::Ref<const Eigen::MatrixXd>& Y);
+    void aggregateSmoothChunk(int c);
+    void smoothChunk(int c);
+
+    KalmanFilter model_;
+    ThreadPool& pool_;
+    int n_;
+    int requested_chunks_;
+    int chunks_ = 0;
+    int steps_ = 0;
+
+    // Constant parts of the filtering elements
+    Eigen::MatrixXd A_element_;  // (I - K C) A
+    Eigen::MatrixXd C_element_;  // (I - K C) Q
+    Eigen::MatrixXd J_element_;  // A' C' S^-1 C A
+    Eigen::MatrixXd K_;          // Q C' S^-1, b = K y
+    Eigen::MatrixXd Eta_;        // A' C' S^-1, eta = Eta y
+
+    Eigen::MatrixXd x_predicted_;  // n x steps
+    Eigen::MatrixXd P_predicted_;  // n x (n * steps)
+    Eigen::MatrixXd x_;            // filtered, then smoothed, n x steps
+    Eigen::MatrixXd P_;            // filtered, then smoothed, n x (n * steps)
+
+    std::vector<Eigen::VectorXd> boundary_x_;  // moments at the chunk boundaries
+    std::vector<Eigen::MatrixXd> boundary_P_;
+    std::vector<Workspace> workspaces_;
+};
+
+#endif // PARALLEL_KALMAN_FILTER_H
@@ -0,0 +1,139 @@
+#ifndef RTS_SMOOTHER_H
+#define RTS_SMOOTHER_H
+
+#include <Eigen/Dense>
+
+class KalmanFilter;
+class ExtendedKalmanFilter;
+
+/**
+ * @brief One backward step of the Rauch-Tung-Striebel recursion.
+ *
+ * Given the filtered moments of step k, the transition F used to predict
+ * step k+1, the predicted moments of step k+1 and the smoothed moments of
+ * step k+1, overwrites the filtered moments of step k with the smoothed
+ * ones. The smoother gain is obtained from a Cholesky solve of the
+ * predicted covariance, and the workspaces are reused between steps.
+ */
+class RtsBackwardStep {
+public:
+    void apply(const Eigen::Ref<const Eigen::MatrixXd>& F,
+               const Eigen::Ref<const Eigen::VectorXd>& x_predicted,
+               const Eigen::Ref<const Eigen::MatrixXd>& P_predicted,
+               const Eigen::Ref<const Eigen::VectorXd>& x_next,
+               const Eigen::Ref<const Eigen::MatrixXd>& P_next,
+               Eigen::Ref<Eigen::VectorXd> x,
+               Eigen::Ref<Eigen::MatrixXd> P);
+
+private:
+    Eigen::MatrixXd Gt_;  // transposed smoother gain P_predicted^-1 * F * P
+    Eigen::MatrixXd dP_;  // P_next - P_predicted
+    Eigen::MatrixXd dPG_; // dP * G'
+    Eigen::VectorXd dx_;  // x_next - x_predicted
+    Eigen::LLT<Eigen::MatrixXd> llt_;
+};
+
+/**
+ * @brief Rauch-Tung-Striebel smoother for a whole recorded sequence.
+ *
+ * Every step is recorded as a prediction (the transition matrix or its
+ * Jacobian together with the predicted moments) followed by an update
+ * (the filtered moments). smooth() then runs the backward pass and
+ * replaces the stored filtered moments by the smoothed ones. All moments
+ * live in a few contiguous matrices that grow geometrically, so recording
+ * a long sequence costs no per-step allocation after reserve().
+ *
+ * For a time-invariant model pass the transition matrix to the
+ * constructor; it is then stored once instead of once per step.
+ */
+class RtsSmoother {
+public:
+    RtsSmoother() = default;
+
+    /**
+     * @brief Smoother for a fixed transition matrix A.
+     */
+    explicit RtsSmoother(const Eigen::MatrixXd& A);
+
+    /**
+     * @brief Preallocates storage for a number of steps.
+     */
+    void reserve(int state_dim, int steps);
+
+    /**
+     * @brief Discards all recorded steps.
+     */
+    void clear();
+
+    /**
+     * @brief Records the prediction into the next step.
+     * @param F Transition matrix (or Jacobian) used by the prediction.
+     * @param x Predicted state.
+     * @param P Predicted covariance.
+     */
+    void addPrediction(const Eigen::MatrixXd& F, const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Records the prediction with the fixed transition matrix.
+     */
+    void addPrediction(const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Records the filtered moments of the current step. A step
+     * without measurement records its predicted moments here.
+     */
+    void addUpdate(const Eigen::VectorXd& x, const Eigen::MatrixXd& P);
+
+    /**
+     * @brief Runs predict() and update() over the columns of Y, recording
+     * every step.
+     */
+    void filter(KalmanFilter& kf, const Eigen::Ref<const Eigen::MatrixXd>& Y);
+    void filter(ExtendedKalmanFilter& ekf, const Eigen::Ref<const Eigen::MatrixXd>& Y);
+
+    /**
+     * @brief Runs the backward pass over the recorded steps. Further
+     * steps can only be recorded after clear().
+     */
+    void smooth();
+
+    /**
+     * @brief Returns the number of recorded steps.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns all states, one column per step; filtered before
+     * smooth() and smoothed after it.
+     */
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> states() const;
+
+    /**
+     * @brief Returns the state of step k.
+     */
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, 1, true> state(int k) const;
+
+    /**
+     * @brief Returns the covariance of step k.
+     */
+    Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> covariance(int k) const;
+
+private:
+    void grow(int state_dim);
+
+    int n_ = 0;          // state dimension
+    int steps_ = 0;      // recorded updates
+    int predictions_ = 0;
+    bool fixed_transition_ = false;
+    bool smoothed_ = false;
+
+    Eigen::MatrixXd A_;            // fixed transition
+    Eigen::MatrixXd F_;            // per-step transitions, n x (n * capacity)
+    Eigen::MatrixXd x_predicted_;  // n x capacity
+    Eigen::MatrixXd P_predicted_;  // n x (n * capacity)
+    Eigen::MatrixXd x_;            // filtered, then smoothed, n x capacity
+    Eigen::MatrixXd P_;            // filtered, then smoothed, n x (n * capacity)
+    RtsBackwardStep backward_;
+};
+
+#endif // RTS_SMOOTHER_H
@@ -0,0 +1,137 @@
+#ifndef SHARDED_TRACKER_H
+#define SHARDED_TRACKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <Eigen/Dense>
+#include <base_kalman_filter.h>
+#include <latency_histogram.h>
+#include <mpsc_queue.h>
+
+/**
+ * @brief Multi-threaded runtime applying measurements to per-track filters.
+ *
+ * Tracks are sharded by id over worker threads; each shard owns its
+ * filters exclusively, so no lock is taken around predict()/update().
+ * Ingest threads push measurements into the shard's bounded lock-free
+ * MPSC queue. A worker drains its queue in batches, groups the batch by
+ * track with a stable sort (so measurements of one track keep their
+ * submission order) and runs predict() followed by update() for each.
+ * The delay from submission to the end of the update is recorded in a
+ * per-shard latency histogram.
+ */
+class ShardedTracker {
+public:
+    /**
+     * @brief Creates the filter of a track on its first measurement.
+     */
+    using FilterFactory = std::function<std::unique_ptr<BaseKalmanFilter>(long track_id, const Eigen::VectorXd& y)>;
+
+    /**
+     * @brief Called on the shard thread after every update.
+     */
+    using UpdateCallback = std::function<void(long track_id, const BaseKalmanFilter& filter)>;
+
+    /**
+     * @param shards Number of worker threads.
+     * @param factory Creates new track filters.
+     * @param queue_capacity Measurements buffered per shard.
+     * @param batch_size Maximum measurements a worker takes per batch.
+     */
+    ShardedTracker(int shards, FilterFactory factory, std::size_t queue_capacity = 4096, int batch_size = 256);
+    ~ShardedTracker();
+
+    ShardedTracker(const ShardedTracker&) = delete;
+    ShardedTracker& operator=(const ShardedTracker&) = delete;
+
+    /**
+     * @brief Sets the update callback; call before submitting measurements.
+     */
+    void setUpdateCallback(UpdateCallback callback);
+
+    /**
+     * @brief Queues a measurement for a track; may be called from any thread.
+     * @return false if the shard queue is full.
+     */
+    bool trySubmit(long track_id, const Eigen::VectorXd& y);
+
+    /**
+     * @brief Queues a measurement, yielding while the shard queue is full.
+     */
+    void submit(long track_id, const Eigen::VectorXd& y);
+
+    /**
+     * @brief Waits until every measurement submitted before the call has
+     * been applied.
+     */
+    void flush();
+
+    int shardCount() const;
+    int shardOf(long track_id) const;
+
+    /**
+     * @brief Submission-to-update latency of one shard.
+     */
+    const LatencyHistogram& latency(int shard) const;
+
+    /**
+     * @brief Number of measurements dropped because their update threw.
+     */
+    std::uint64_t errors() const;
+
+    /**
+     * @brief Number of tracks; only consistent after flush() while no
+     * measurements are being submitted.
+     */
+    std::size_t trackCount() const;
+
+    /**
+     * @brief Copies the estimate of a track; only consistent after flush()
+     * while no measurements are being submitted.
+     * @return false for an unknown track.
+     */
+    bool estimate(long track_id, Eigen::VectorXd& x, Eigen::MatrixXd& P) const;
+
+private:
+    struct Measurement {
+        long track = 0;
+        std::int64_t submitted = 0; // steady clock, ns
+        Eigen::VectorXd y;
+    };
+
+    struct Shard {
+        explicit Shard(std::size_t capacity) : queue(capacity) {}
+
+        MpscQueue<Measurement> queue;
+        std::unordered_map<long, std::unique_ptr<BaseKalmanFilter>> filters;
+        std::vector<Measurement> batch;
+        std::vector<int> order;
+        LatencyHistogram latency;
+        std::atomic<std::uint64_t> submitted{0};
+        std::atomic<std::uint64_t> processed{0};
+        std::atomic<std::uint64_t> errors{0};
+        std::atomic<bool> sleeping{false};
+        std::mutex mutex;
+        std::condition_variable wake;    // worker waits for measurements
+        std::condition_variable drained; // flush() waits for progress
+        std::thread worker;
+    };
+
+    void run(Shard& shard);
+    void process(Shard& shard, int count);
+
+    FilterFactory factory_;
+    UpdateCallback callback_;
+    int batch_size_;
+    std::atomic<bool> stop_{false};
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // SHARDED_TRACKER_H
@@ -0,0 +1,94 @@
+#ifndef SPARSE_KALMAN_FILTER_H
+#define SPARSE_KALMAN_FILTER_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <base_filter.h>
+
+/**
+ * @brief Kalman filter for large state vectors with sparse structure.
+ *
+ * A, C, Q, R and the covariance are Eigen::SparseMatrix, so the cost of a
+ * step follows the number of nonzeros instead of n^3. Only the covariance
+ * entries inside tracked blocks are kept: the sparsity pattern of the
+ * initial covariance and every block passed to trackCovarianceBlock().
+ * Cross covariances outside those blocks are dropped after each step,
+ * which is exact when the blocks are uncoupled and a deliberate
+ * approximation otherwise.
+ */
+class SparseKalmanFilter : public BaseFilter {
+public:
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    /**
+     * @brief Constructor for the sparse Kalman Filter.
+     * @param A State transition matrix.
+     * @param C Observation matrix.
+     * @param Q Process noise covariance matrix.
+     * @param R Measurement noise covariance matrix.
+     * @param P Initial estimate error covariance matrix.
+     */
+    SparseKalmanFilter(const SparseMatrix& A,
+                       const SparseMatrix& C,
+                       const SparseMatrix& Q,
+                       const SparseMatrix& R,
+                       const SparseMatrix& P);
+
+    /**
+     * @brief Initializes the filter with an initial state.
+     * @param x0 Initial state vector.
+     */
+    void init(const Eigen::VectorXd& x0);
+
+    /**
+     * @brief Keeps the covariance block at (row, col) and its transpose.
+     */
+    void trackCovarianceBlock(int row, int col, int rows, int cols);
+
+    /**
+     * @brief Predicts the next state.
+     */
+    void predict() override;
+
+    /**
+     * @brief Updates the state with a new measurement.
+     * @param y Measurement vector.
+     */
+    void update(const Eigen::VectorXd& y) override;
+
+    /**
+     * @brief Returns the current state estimate.
+     */
+    const Eigen::VectorXd& state() const;
+
+    /**
+     * @brief Returns the tracked entries of the state covariance.
+     */
+    const SparseMatrix& covariance() const;
+
+    /**
+     * @brief Returns one block of the covariance as a dense matrix.
+     */
+    Eigen::MatrixXd covarianceBlock(int row, int col, int rows, int cols) const;
+
+private:
+    void applyMask();
+
+    Eigen::VectorXd x_;
+    SparseMatrix P_;
+
+    SparseMatrix A_;
+    SparseMatrix C_;
+    SparseMatrix Q_;
+    SparseMatrix R_;
+
+    // Tracked covariance pattern, ones inside tracked blocks
+    SparseMatrix mask_;
+    std::vector<Eigen::Triplet<double>> mask_entries_;
+    bool mask_dirty_ = true;
+
+    Eigen::SimplicialLLT<SparseMatrix> S_llt_;
+};
+
+#endif // SPARSE_KALMAN_FILTER_H
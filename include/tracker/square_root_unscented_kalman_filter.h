@@ -0,0 +1,130 @@
+/**
+ * @file square_root_unscented_kalman_filter.h
+ * @brief Definition of the SquareRootUnscentedKalmanFilter class.
+ *
+ * Square-root form of UnscentedKalmanFilter: the filter carries the lower
+ * Cholesky factor S of the state covariance (P = S * S') instead of P, so
+ * the sigma points need no factorization and P stays positive definite by
+ * construction.
+ *
+ * @class SquareRootUnscentedKalmanFilter
+ *
+ * @brief Public Methods:
+ *   - SquareRootUnscentedKalmanFilter(int state_dim, int meas_dim):
+ *       Constructor specifying the dimensions of the state and measurement vectors.
+ *   - void initialize(const Vector& x0, const Matrix& P0):
+ *       Initializes the filter and factorizes P0; throws std::invalid_argument
+ *       if P0 is not positive definite.
+ *   - void setProcessModel(...) / setMeasurementModel(...):
+ *   - void setInPlaceProcessModel(...) / setInPlaceMeasurementModel(...):
+ *       Same model signatures as UnscentedKalmanFilter. The noise covariances
+ *       are factorized once here.
+ *   - void predict():
+ *       Propagates the sigma points and rebuilds S from a QR decomposition of
+ *       the weighted deviations and the process noise factor, followed by a
+ *       rank-1 Cholesky update for the central point.
+ *   - void update(const Vector& z):
+ *       Corrects the state and refactors S by QR from the residual sigma
+ *       point deviations dX - K * dZ and K * sqrt(R). Unlike m rank-1
+ *       downdates by K * Sz, this keeps S valid when a precise measurement
+ *       shrinks P by many orders of magnitude.
+ *   - const Matrix& squareRootCovariance() const:
+ *       Returns the lower-triangular factor S.
+ *   - const Matrix& covariance() const:
+ *       Returns S * S', formed on demand.
+ *
+ * @note
+ *   Deviations are taken from the central sigma point rather than from the
+ *   weighted mean. With the scaled weights this leaves only non-negative
+ *   coefficients (the central point enters with beta - alpha^2), so the
+ *   prediction never needs the downdate that a negative zeroth weight
+ *   otherwise requires. A downdate only remains for beta < alpha^2.
+ */
+#ifndef SQUARE_ROOT_UNSCENTED_KALMAN_FILTER_H
+#define SQUARE_ROOT_UNSCENTED_KALMAN_FILTER_H
+
+#include <functional>
+#include <Eigen/Dense>
+#include <base_kalman_filter.h>
+
+class SquareRootUnscentedKalmanFilter : public BaseKalmanFilter {
+public:
+    using Vector = Eigen::VectorXd;
+    using Matrix = Eigen::MatrixXd;
+    using InPlaceModel = std::function<void(const Vector& x, Vector& out)>;
+
+    SquareRootUnscentedKalmanFilter(int state_dim, int meas_dim);
+
+    void initialize(const Vector& x0, const Matrix& P0);
+
+    // Setters for models and noise covariances
+    void setProcessModel(const std::function<Vector(const Vector&)>& f, const Matrix& Q);
+    void setMeasurementModel(const std::function<Vector(const Vector&)>& h, const Matrix& R);
+    void setInPlaceProcessModel(const InPlaceModel& f, const Matrix& Q);
+    void setInPlaceMeasurementModel(const InPlaceModel& h, const Matrix& R);
+
+    // Unified interface overrides
+    void predict() override;
+    void update(const Eigen::VectorXd& z) override;
+
+    const Vector& state() const override;
+    const Matrix& covariance() const override;
+    const Matrix& squareRootCovariance() const;
+    void setState(const Vector& x, const Matrix& P) override;
+    double logLikelihood() const override;
+
+private:
+    void generateSigmaPoints();
+    void transformSigmaPoints(const std::function<Vector(const Vector&)>& model,
+                              const InPlaceModel& in_place_model,
+                              Vector& output,
+                              Matrix& transformed);
+
+    int n_x_; // State dimension
+    int n_z_; // Measurement dimension
+    double lambda_;
+    double weight_;         // mean and covariance weight of the outer points
+    double center_weight_;  // weight of the central deviation, beta - alpha^2
+    Vector x_;              // State estimate
+    Matrix S_;              // Lower Cholesky factor of the state covariance
+    mutable Matrix P_;      // S_ * S_', formed by covariance()
+
+    // UKF parameters
+    double alpha_ = 1e-3;
+    double beta_ = 2.0;
+    double kappa_ = 0.0;
+
+    // Nonlinear models and noise factors
+    std::function<Vector(const Vector&)> f_;
+    std::function<Vector(const Vector&)> h_;
+    InPlaceModel f_in_place_;
+    InPlaceModel h_in_place_;
+    Matrix sqrt_Q_; // lower factor of Q
+    Matrix sqrt_R_; // lower factor of R
+
+    // Workspaces, sized once
+    Matrix sigma_points_;   // one sigma point per column
+    Matrix propagated_;     // f at each sigma point, then deviations from the center
+    Matrix meas_sigma_;     // h at each sigma point, then deviations from the center
+    Matrix compound_;       // [sqrt(w) * deviations, noise factor]' for the state
+    Matrix compound_meas_;  // same for the measurement
+    Matrix compound_update_; // [sqrt(w) * (dX - K * dZ), K * sqrt(R)]' for the update
+    Eigen::HouseholderQR<Matrix> qr_;
+    Eigen::HouseholderQR<Matrix> qr_meas_;
+    Eigen::HouseholderQR<Matrix> qr_update_;
+    Vector point_;
+    Vector fx_;
+    Vector hx_;
+    Vector center_;         // mean minus central point
+    Vector center_meas_;
+    Vector z_pred_;
+    Vector innovation_;
+    Vector column_;         // vector of a rank-1 update of S_
+    Vector column_meas_;    // vector of a rank-1 update of Sz_
+    Matrix Sz_;             // lower factor of the innovation covariance
+    Matrix Pxz_;            // state/measurement cross covariance
+    Matrix Kt_;             // transposed gain
+    mutable Vector likelihood_work_;
+};
+
+#endif // SQUARE_ROOT_UNSCENTED_KALMAN_FILTER_H
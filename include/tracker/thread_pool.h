@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads for data-parallel loops.
+ *
+ * parallelFor() hands out loop indices through a shared counter to the
+ * workers and to the calling thread, and returns once every index has
+ * run. The first exception thrown by the body is rethrown to the caller.
+ * Calls made from inside a body run serially on the calling thread, so
+ * parallel code can be composed without deadlock. The pool is meant to be
+ * created once and shared by the filters that use it.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param threads Total number of threads including the caller; 0 uses
+     *        the hardware concurrency.
+     */
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the number of threads taking part in a loop.
+     */
+    int size() const;
+
+    /**
+     * @brief Runs body(i) for every i in [begin, end) and waits for completion.
+     */
+    void parallelFor(int begin, int end, const std::function<void(int)>& body);
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex call_mutex_; // serializes parallelFor() calls from different threads
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+
+    // Current loop, guarded by mutex_ except for the index counter
+    const std::function<void(int)>* body_ = nullptr;
+    std::atomic<int> next_{0};
+    int end_ = 0;
+    int active_ = 0;       // workers that have not finished the current loop
+    long generation_ = 0;  // incremented for every loop
+    bool stop_ = false;
+    std::exception_ptr error_;
+};
+
+#endif // THREAD_POOL_H
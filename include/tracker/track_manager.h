@@ -0,0 +1,151 @@
+#ifndef TRACK_MANAGER_H
+#define TRACK_MANAGER_H
+
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter_bank.h>
+
+/**
+ * @brief Tuning of the track manager.
+ */
+struct TrackManagerConfig {
+    double gate = 9.21;          // squared Mahalanobis gate, 99% for two degrees of freedom
+    double cell_size = 1.0;      // minimum spatial grid cell size in measurement units
+    int confirmation_hits = 3;   // updates before a track is confirmed
+    int max_misses = 5;          // consecutive misses before a confirmed track is deleted
+    double auction_epsilon = 1e-4; // minimum bid increment; the assignment is optimal
+                                   // within this times the number of tracks
+};
+
+/**
+ * @brief One live track.
+ */
+struct Track {
+    long id;      // unique, increasing with birth order
+    int slot;     // filter index in the bank
+    int hits;     // measurement updates since birth
+    int misses;   // consecutive frames without a detection
+};
+
+/**
+ * @brief Multi-target tracker built on a KalmanFilterBank.
+ *
+ * Every frame, all tracks are predicted together in the bank. Detections
+ * are binned into a uniform grid over their first two measurement
+ * components, and each track only visits the cells covered by the
+ * bounding box of its gate ellipse, so gating costs O(N + M) for well
+ * separated targets instead of O(N * M). The global nearest neighbour
+ * assignment is solved with an auction over the gated
+ * pairs only, each track having the private option of staying unassigned
+ * at the cost of the gate. Unassigned detections start tentative tracks;
+ * tentative tracks die at their first miss and confirmed ones after
+ * max_misses consecutive misses. Freed filter slots are reused, so the
+ * bank only grows to the peak number of tracks.
+ */
+class TrackManager {
+public:
+    /**
+     * @brief Constructor for the track manager.
+     * @param A State transition matrix.
+     * @param C Observation matrix; the first two measurement components
+     *          are the spatial position used for gating.
+     * @param Q Process noise covariance matrix.
+     * @param R Measurement noise covariance matrix.
+     * @param P Initial covariance of a new track.
+     */
+    TrackManager(const Eigen::MatrixXd& A,
+                 const Eigen::MatrixXd& C,
+                 const Eigen::MatrixXd& Q,
+                 const Eigen::MatrixXd& R,
+                 const Eigen::MatrixXd& P,
+                 const TrackManagerConfig& config = TrackManagerConfig());
+
+    /**
+     * @brief Processes one frame: predict, gate, assign, update, birth and death.
+     * @param detections Measurements, one row per detection.
+     */
+    void step(const Eigen::MatrixXd& detections);
+
+    /**
+     * @brief Returns the live tracks. Order changes when tracks die.
+     */
+    const std::vector<Track>& tracks() const;
+
+    /**
+     * @brief Returns whether a track has been confirmed.
+     */
+    bool confirmed(const Track& track) const;
+
+    /**
+     * @brief Returns the state estimate of a track.
+     */
+    Eigen::VectorXd state(const Track& track) const;
+
+    /**
+     * @brief Returns the state covariance of a track.
+     */
+    Eigen::MatrixXd covariance(const Track& track) const;
+
+    /**
+     * @brief Track id each detection of the last frame was assigned to,
+     * including tracks born from it.
+     */
+    const std::vector<long>& detectionTracks() const;
+
+    /**
+     * @brief Returns the number of gated track/detection pairs of the last frame.
+     */
+    int gatedPairs() const;
+
+    const KalmanFilterBank& bank() const;
+
+private:
+    void buildGrid(const Eigen::MatrixXd& detections);
+    void gate(const Eigen::MatrixXd& detections);
+    void assign();
+    void updateTracks(const Eigen::MatrixXd& detections);
+    void manageTracks(const Eigen::MatrixXd& detections);
+
+    int m_;
+    TrackManagerConfig config_;
+    KalmanFilterBank bank_;
+    Eigen::MatrixXd P0_;
+    Eigen::MatrixXd birth_;  // least-squares state from a measurement
+
+    std::vector<Track> tracks_;
+    std::vector<int> free_slots_;
+    long next_id_ = 0;
+
+    // Uniform grid over detection positions, detections sorted by cell
+    double cell_ = 1.0;
+    double origin_x_ = 0.0;
+    double origin_y_ = 0.0;
+    int cells_x_ = 0;
+    int cells_y_ = 0;
+    std::vector<int> cell_start_;
+    std::vector<int> cell_items_;
+    std::vector<int> cell_of_;    // cell of each detection
+    std::vector<int> cell_fill_;  // write cursor per cell during the sort
+
+    // Gated pairs in compressed rows, one row per live track
+    Eigen::MatrixXd Z_;  // predicted measurements of all slots
+    Eigen::MatrixXd S_;  // innovation covariances of all slots
+    std::vector<int> edge_begin_;
+    std::vector<int> edge_detection_;
+    std::vector<double> edge_benefit_;  // gate - squared distance
+    Eigen::MatrixXd Si_;
+    Eigen::LLT<Eigen::MatrixXd> llt_;
+    Eigen::VectorXd residual_;
+
+    // Auction state
+    std::vector<double> price_;
+    std::vector<int> owner_;     // track index owning each detection, -1 if none
+    std::vector<int> assigned_;  // detection of each track, -1 for none
+    std::vector<int> queue_;
+
+    Eigen::MatrixXd Y_;             // measurements per slot
+    KalmanFilterBank::Mask mask_;   // slots updated this frame
+    std::vector<long> detection_tracks_;
+};
+
+#endif // TRACK_MANAGER_H
@@ -14,14 +14,39 @@
  *   Alias for Eigen::MatrixXd, representing a covariance or transformation matrix.
  *
  * @brief Public Methods:
- *   - UnscentedKalmanFilter(int state_dim, int meas_dim):
- *       Constructor specifying the dimensions of the state and measurement vectors.
+ *   - UnscentedKalmanFilter(int state_dim, int meas_dim, SigmaPointScheme scheme = SigmaPointScheme::Scaled):
+ *       Constructor specifying the dimensions of the state and measurement vectors
+ *       and the sigma point set, whose points and weights are computed here.
  *   - void initialize(const Vector& x0, const Matrix& P0):
  *       Initializes the filter with an initial state and covariance.
+ *   - void setInPlaceProcessModel(const InPlaceModel& f, const Matrix& Q):
+ *   - void setInPlaceMeasurementModel(const InPlaceModel& h, const Matrix& R):
+ *       Sets a model that writes its output into a vector owned by the filter
+ *       instead of returning a new one; with these models a step does not
+ *       allocate once the workspaces are sized.
+ *   - void setBatchProcessModel(const BatchModel& f, const Matrix& Q):
+ *   - void setBatchMeasurementModel(const BatchModel& h, const Matrix& R):
+ *       Sets a model called once per step with all sigma points as the columns
+ *       of a matrix, writing one output column per point, so the model can
+ *       vectorize or thread across the points.
  *   - void predict(const std::function<Vector(const Vector&)>& f, const Matrix& Q):
  *       Performs the prediction step using the process model and process noise covariance.
  *   - void update(const std::function<Vector(const Vector&)>& h, const Vector& z, const Matrix& R):
  *       Performs the update step using the measurement model, measurement, and measurement noise covariance.
+ *   - void setThreadPool(ThreadPool* pool, double min_parallel_nanoseconds = 50000):
+ *       Evaluates per-point models at the sigma points on the pool once a
+ *       serial pass over the points is estimated to take longer than
+ *       min_parallel_nanoseconds; cheaper models stay on the calling thread.
+ *       The estimate is a moving average over timed serial passes, one of
+ *       which replaces every 32nd parallel pass, and a model switched to
+ *       the pool returns only below half the threshold.
+ *       Every point writes its own column and the means and covariances are
+ *       reduced afterwards in a fixed order, so results are bit-identical to
+ *       serial mode. Models must then be safe to call concurrently. Batch
+ *       models are always called once on the calling thread. nullptr runs
+ *       serially; the pool must outlive the filter.
+ *   - void setUpdateStrategy(const UpdateStrategy& strategy):
+ *       Selects the gain solver and covariance update form (explicit inverse by default).
  *   - const Vector& getState() const:
  *       Returns the current state estimate.
  *   - const Matrix& getCovariance() const:
@@ -30,8 +55,12 @@
  * @brief Private Methods:
  *   - void generateSigmaPoints():
  *       Generates sigma points based on the current state and covariance.
+ *       The update draws a fresh set from the predicted estimate.
+ *   - void transformSigmaPoints(...):
+ *       Evaluates a model at every sigma point into the columns of a matrix.
  *   - void computeWeights():
- *       Computes the weights for mean and covariance calculations.
+ *       Computes the unit sigma points of the scheme and the weights for mean
+ *       and covariance calculations.
  *
  * @brief Member Variables:
  *   - n_x_: State dimension.
@@ -39,9 +68,12 @@
  *   - lambda_: Scaling parameter for sigma point generation.
  *   - x_: Current state estimate.
  *   - P_: Current state covariance.
- *   - sigma_points_: Container for generated sigma points.
+ *   - sigma_points_: n_x x (2 n_x + 1) matrix with one sigma point per column;
+ *       weighted means and covariances are matrix products over it.
  *   - weights_mean_: Weights for mean calculation.
  *   - weights_cov_: Weights for covariance calculation.
+ *   - unit_points_: Sigma points of the scheme for zero mean and unit covariance,
+ *       mapped through x + L * unit_points_ (not stored for the scaled set).
  *   - alpha_, beta_, kappa_: UKF tuning parameters.
  *
  * @note
@@ -51,43 +83,89 @@
 #ifndef UNSCENTED_KALMAN_FILTER_H
 #define UNSCENTED_KALMAN_FILTER_H
 
-#include <Eigen/Dense>
+#include <functional>
 #include <vector>
+#include <Eigen/Dense>
 #include <base_kalman_filter.h>
+#include <kalman_corrector.h>
+#include <thread_pool.h>
+
+/**
+ * @brief Sigma point set of UnscentedKalmanFilter.
+ */
+enum class SigmaPointScheme {
+    Scaled,             // 2n + 1 points, scaled unscented transform (alpha, beta, kappa)
+    SphericalSimplex,   // n + 2 points, second order (matches mean and covariance), for costly models
+    FifthDegreeCubature // 2n^2 + 1 points, exact for polynomials up to degree five
+};
 
 class UnscentedKalmanFilter : public BaseKalmanFilter {
 public:
     using Vector = Eigen::VectorXd;
     using Matrix = Eigen::MatrixXd;
+    using InPlaceModel = std::function<void(const Vector& x, Vector& out)>;
+    using BatchModel = std::function<void(const Matrix& points, Matrix& out)>;
 
-    UnscentedKalmanFilter(int state_dim, int meas_dim);
+    UnscentedKalmanFilter(int state_dim, int meas_dim, SigmaPointScheme scheme = SigmaPointScheme::Scaled);
 
     void initialize(const Vector& x0, const Matrix& P0);
 
     // Setters for models and noise covariances
     void setProcessModel(const std::function<Vector(const Vector&)>& f, const Matrix& Q);
     void setMeasurementModel(const std::function<Vector(const Vector&)>& h, const Matrix& R);
+    void setInPlaceProcessModel(const InPlaceModel& f, const Matrix& Q);
+    void setInPlaceMeasurementModel(const InPlaceModel& h, const Matrix& R);
+    void setBatchProcessModel(const BatchModel& f, const Matrix& Q);
+    void setBatchMeasurementModel(const BatchModel& h, const Matrix& R);
 
     // Unified interface overrides
     void predict() override;
     void update(const Eigen::VectorXd& z) override;
 
+    void setThreadPool(ThreadPool* pool, double min_parallel_nanoseconds = 50000.0);
+    void setUpdateStrategy(const UpdateStrategy& strategy);
+    void setNoiseCovariances(const Matrix& Q, const Matrix& R);
+    const Matrix& processNoise() const;
+    SigmaPointScheme sigmaPointScheme() const;
+    int sigmaPointCount() const;
+    const Matrix& measurementNoise() const;
+
     const Vector& state() const override;
     const Matrix& covariance() const override;
+    void setState(const Vector& x, const Matrix& P) override;
+    double logLikelihood() const override;
 
 private:
+    // Per-model state of the parallel sigma point evaluation
+    struct ParallelTransform {
+        std::vector<Vector> outputs;    // one in-place output per sigma point
+        double point_nanoseconds = 0.0; // smoothed cost of one serial evaluation
+        long serial_passes = 0;         // timed passes behind the estimate
+        bool parallel = false;          // current mode
+        int parallel_passes = 0;        // since the last serial pass
+    };
+
     void generateSigmaPoints();
     void computeWeights();
+    void transformSigmaPoints(const std::function<Vector(const Vector&)>& model,
+                              const InPlaceModel& in_place_model,
+                              const BatchModel& batch_model,
+                              Vector& output,
+                              Matrix& transformed,
+                              ParallelTransform& parallel);
+    void transformPoint(int i);
 
     int n_x_; // State dimension
     int n_z_; // Measurement dimension
+    SigmaPointScheme scheme_;
     double lambda_;
     Vector x_; // State estimate
     Matrix P_; // State covariance
 
-    std::vector<Vector> sigma_points_;
+    Matrix sigma_points_; // one sigma point per column
     Vector weights_mean_;
     Vector weights_cov_;
+    Matrix unit_points_; // zero mean, unit covariance points of the scheme
 
     // UKF parameters
     double alpha_ = 1e-3;
@@ -97,9 +175,41 @@ private:
     // Nonlinear models and noise
     std::function<Vector(const Vector&)> f_;
     std::function<Vector(const Vector&)> h_;
+    InPlaceModel f_in_place_;
+    InPlaceModel h_in_place_;
+    BatchModel f_batch_;
+    BatchModel h_batch_;
     Matrix Q_;
     Matrix R_;
     Vector z_; // Last measurement
+    KalmanCorrector corrector_;
+
+    // Workspaces, sized once
+    Eigen::LLT<Matrix> llt_;  // factor of P_ for the sigma points
+    Matrix L_;                // lower factor for the mapped schemes
+    Vector point_;            // sigma point handed to a model
+    Vector fx_;               // process model output
+    Vector hx_;               // measurement model output
+    Matrix propagated_;       // f at each sigma point, then deviations from x_
+    Matrix meas_sigma_;       // h at each sigma point, then deviations from z_pred_
+    Matrix weighted_;         // deviations scaled by the covariance weights
+    Matrix weighted_meas_;
+    Vector z_pred_;           // predicted measurement
+    Vector innovation_;
+    Matrix S_;                // innovation covariance
+    Matrix Tc_;               // state/measurement cross covariance
+
+    // Parallel evaluation; the pending_ pointers describe the running
+    // transform so the pool body captures only this
+    ThreadPool* pool_ = nullptr;
+    double min_parallel_nanoseconds_ = 0.0;
+    std::vector<Vector> points_; // one copy per sigma point
+    ParallelTransform process_parallel_;
+    ParallelTransform measurement_parallel_;
+    const std::function<Vector(const Vector&)>* pending_model_ = nullptr;
+    const InPlaceModel* pending_in_place_model_ = nullptr;
+    std::vector<Vector>* pending_outputs_ = nullptr;
+    Matrix* pending_transformed_ = nullptr;
 };
 
 #endif // UNSCENTED_KALMAN_FILTER_H
\ No newline at end of file
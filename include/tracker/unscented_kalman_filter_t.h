@@ -0,0 +1,168 @@
+#ifndef UNSCENTED_KALMAN_FILTER_T_H
+#define UNSCENTED_KALMAN_FILTER_T_H
+
+#include <cmath>
+#include <Eigen/Dense>
+
+/**
+ * @brief Unscented Kalman filter with statically dispatched models and
+ * compile-time dimensions.
+ *
+ * The 2 Nx + 1 sigma points are the columns of one fixed-size matrix, the
+ * models are functors called directly on each of them, and the weighted
+ * means and covariances are matrix products over the sigma matrices, so a
+ * step makes no indirect calls and never allocates. The update draws a
+ * fresh set of sigma points from the predicted estimate. Wrap the filter
+ * in KalmanFilterAdapter to use it through BaseKalmanFilter.
+ *
+ * @tparam ProcessModel Functor called as f(x, fx) with StateVector x,
+ *         writing f(x) to the StateVector fx.
+ * @tparam MeasurementModel Functor called as h(x, z), writing h(x) to the
+ *         MeasurementVector z.
+ * @tparam Nx State dimension.
+ * @tparam Nz Measurement dimension.
+ * @tparam Scalar_ Floating point type of the filter.
+ */
+template <typename ProcessModel, typename MeasurementModel, int Nx, int Nz, typename Scalar_ = double>
+class UnscentedKalmanFilterT {
+public:
+    static constexpr int Ns = 2 * Nx + 1; // number of sigma points
+
+    using Scalar = Scalar_;
+    using StateVector = Eigen::Matrix<Scalar, Nx, 1>;
+    using StateMatrix = Eigen::Matrix<Scalar, Nx, Nx>;
+    using MeasurementVector = Eigen::Matrix<Scalar, Nz, 1>;
+    using MeasurementCovariance = Eigen::Matrix<Scalar, Nz, Nz>;
+    using WeightVector = Eigen::Matrix<Scalar, Ns, 1>;
+    using StateSigmaMatrix = Eigen::Matrix<Scalar, Nx, Ns>;
+    using MeasurementSigmaMatrix = Eigen::Matrix<Scalar, Nz, Ns>;
+
+    /**
+     * @param f Process model.
+     * @param h Measurement model.
+     * @param x0 Initial state.
+     * @param P0 Initial covariance.
+     * @param Q Process noise covariance.
+     * @param R Measurement noise covariance.
+     * @param alpha, beta, kappa Scaled unscented transform parameters.
+     */
+    UnscentedKalmanFilterT(const ProcessModel& f,
+                           const MeasurementModel& h,
+                           const StateVector& x0,
+                           const StateMatrix& P0,
+                           const StateMatrix& Q,
+                           const MeasurementCovariance& R,
+                           Scalar alpha = 1e-3,
+                           Scalar beta = 2.0,
+                           Scalar kappa = 0.0)
+        : f_(f), h_(h), x_(x0), P_(P0), Q_(Q), R_(R),
+          X_(StateSigmaMatrix::Zero()), Z_(MeasurementSigmaMatrix::Zero()),
+          point_(StateVector::Zero()), fx_(StateVector::Zero()), hx_(MeasurementVector::Zero()),
+          z_pred_(MeasurementVector::Zero()), S_(MeasurementCovariance::Zero()) {
+        Scalar lambda = alpha * alpha * (Nx + kappa) - Nx;
+        scaling_ = std::sqrt(Nx + lambda);
+        wm_.setConstant(1.0 / (2.0 * (Nx + lambda)));
+        wc_ = wm_;
+        wm_(0) = lambda / (Nx + lambda);
+        wc_(0) = wm_(0) + (1 - alpha * alpha + beta);
+    }
+
+    void init(const StateVector& x0) {
+        x_ = x0;
+    }
+
+    void init(const StateVector& x0, const StateMatrix& P0) {
+        x_ = x0;
+        P_ = P0;
+    }
+
+    /**
+     * @brief Predicts the next state through the unscented transform.
+     */
+    void predict() {
+        generateSigmaPoints();
+        for (int i = 0; i < Ns; ++i) {
+            point_ = X_.col(i);
+            f_(point_, fx_);
+            X_.col(i) = fx_;
+        }
+        x_.noalias() = X_ * wm_;
+        X_.colwise() -= x_;
+        P_ = Q_;
+        P_.noalias() += X_ * wc_.asDiagonal() * X_.transpose();
+    }
+
+    /**
+     * @brief Updates the state with a new measurement.
+     * @param z Measurement vector.
+     */
+    void update(const MeasurementVector& z) {
+        generateSigmaPoints();
+        for (int i = 0; i < Ns; ++i) {
+            point_ = X_.col(i);
+            h_(point_, hx_);
+            Z_.col(i) = hx_;
+        }
+        z_pred_.noalias() = Z_ * wm_;
+        Z_.colwise() -= z_pred_;
+        X_.colwise() -= x_;
+
+        S_ = R_;
+        S_.noalias() += Z_ * wc_.asDiagonal() * Z_.transpose();
+        const Eigen::Matrix<Scalar, Nz, Nx> Pzx = Z_ * wc_.asDiagonal() * X_.transpose();
+        // Transposed gain from S * K' = Pzx
+        const Eigen::Matrix<Scalar, Nz, Nx> Kt = S_.llt().solve(Pzx);
+        x_.noalias() += Kt.transpose() * (z - z_pred_);
+        P_.noalias() -= Kt.transpose() * Pzx;
+    }
+
+    const StateVector& state() const {
+        return x_;
+    }
+
+    const StateMatrix& covariance() const {
+        return P_;
+    }
+
+    ProcessModel& processModel() {
+        return f_;
+    }
+
+    MeasurementModel& measurementModel() {
+        return h_;
+    }
+
+private:
+    void generateSigmaPoints() {
+        const StateMatrix L = P_.llt().matrixL();
+        X_.col(0) = x_;
+        for (int i = 0; i < Nx; ++i) {
+            X_.col(1 + i) = x_ + scaling_ * L.col(i);
+            X_.col(1 + Nx + i) = x_ - scaling_ * L.col(i);
+        }
+    }
+
+    ProcessModel f_;
+    MeasurementModel h_;
+
+    StateVector x_;
+    StateMatrix P_;
+    StateMatrix Q_;
+    MeasurementCovariance R_;
+
+    // Unscented transform
+    Scalar scaling_;
+    WeightVector wm_; // mean weights
+    WeightVector wc_; // covariance weights
+
+    // Sigma points and model outputs
+    StateSigmaMatrix X_;
+    MeasurementSigmaMatrix Z_;
+    StateVector point_;
+    StateVector fx_;
+    MeasurementVector hx_;
+    MeasurementVector z_pred_;
+    MeasurementCovariance S_;
+};
+
+#endif // UNSCENTED_KALMAN_FILTER_T_H
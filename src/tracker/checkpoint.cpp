@@ -0,0 +1,435 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <checkpoint.h>
+
+namespace {
+const char kMagic[8] = {'T', 'R', 'K', 'C', 'K', 'P', 'T', '\0'};
+const std::uint32_t kFormatVersion = 1;
+const std::uint32_t kRecordMagic = 0x43455254; // "TREC"
+const std::uint16_t kRecordVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t reserved;
+};
+
+struct RecordHeader {
+    std::uint32_t magic;
+    std::uint16_t kind;
+    std::uint16_t version;
+    std::int64_t id;
+    std::uint64_t bytes; // payload size, a multiple of 8
+};
+
+static_assert(sizeof(FileHeader) == 16, "File header must stay 16 bytes.");
+static_assert(sizeof(RecordHeader) == 24, "Record header must stay 24 bytes.");
+
+std::size_t padded(std::size_t size) {
+    return (size + 7) & ~std::size_t(7);
+}
+
+void writeAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Cannot write checkpoint.");
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+bool isSquare(const Eigen::Map<const Eigen::MatrixXd>& M, Eigen::Index size) {
+    return M.rows() == size && M.cols() == size;
+}
+
+// Nonlinear filter records hold x, P, Q and R; all must fit the target
+// filter before any of them is installed
+void checkNoiseShapes(const Eigen::Map<const Eigen::MatrixXd>& x,
+                      const Eigen::Map<const Eigen::MatrixXd>& P,
+                      const Eigen::Map<const Eigen::MatrixXd>& Q,
+                      const Eigen::Map<const Eigen::MatrixXd>& R,
+                      Eigen::Index state_size,
+                      Eigen::Index measurement_size) {
+    if (x.size() != state_size || !isSquare(P, state_size) || !isSquare(Q, state_size) ||
+        !isSquare(R, measurement_size)) {
+        throw std::invalid_argument("Checkpoint does not match the filter dimensions.");
+    }
+}
+
+// Whether a stored scalar is one of the first count enumerators
+bool isEnumerator(double value, int count) {
+    return value >= 0.0 && value < count && value == std::floor(value);
+}
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path)
+    : path_(path)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Cannot open " + path + ".");
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot stat " + path + ".");
+    }
+    off_t end = sizeof(FileHeader);
+    if (info.st_size == 0) {
+        FileHeader header;
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kFormatVersion;
+        header.reserved = 0;
+        writeAll(fd_, reinterpret_cast<const char*>(&header), sizeof(header));
+    } else {
+        // Drop a batch left half-written by a crashed writer
+        try {
+            end = static_cast<off_t>(CheckpointReader(path).committed_bytes_);
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+    if (::ftruncate(fd_, end) != 0 || ::lseek(fd_, end, SEEK_SET) != end) {
+        ::close(fd_);
+        throw std::runtime_error("Cannot position " + path + ".");
+    }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    ::close(fd_);
+}
+
+void CheckpointWriter::write(long id, const KalmanFilter& kf) {
+    beginRecord(CheckpointKind::KalmanFilter, id);
+    Eigen::Vector4d scalars(kf.timeStep(), kf.time(),
+                            static_cast<double>(kf.updateStrategy().solver),
+                            static_cast<double>(kf.updateStrategy().covariance));
+    appendMatrix(scalars);
+    appendMatrix(kf.state());
+    appendMatrix(kf.covariance());
+    appendMatrix(kf.transitionMatrix());
+    appendMatrix(kf.observationMatrix());
+    appendMatrix(kf.processNoise());
+    appendMatrix(kf.measurementNoise());
+    endRecord();
+}
+
+void CheckpointWriter::write(long id, const ExtendedKalmanFilter& ekf) {
+    beginRecord(CheckpointKind::ExtendedKalmanFilter, id);
+    appendMatrix(ekf.state());
+    appendMatrix(ekf.covariance());
+    appendMatrix(ekf.processNoise());
+    appendMatrix(ekf.measurementNoise());
+    endRecord();
+}
+
+void CheckpointWriter::write(long id, const UnscentedKalmanFilter& ukf) {
+    beginRecord(CheckpointKind::UnscentedKalmanFilter, id);
+    appendMatrix(ukf.state());
+    appendMatrix(ukf.covariance());
+    appendMatrix(ukf.processNoise());
+    appendMatrix(ukf.measurementNoise());
+    endRecord();
+}
+
+void CheckpointWriter::write(long id, const SequentialMonteCarlo& smc) {
+    beginRecord(CheckpointKind::SequentialMonteCarlo, id);
+    // One column per particle: state, then weight
+    Eigen::MatrixXd columns(smc.stateDimension() + 1, smc.particleCount());
+    columns.topRows(smc.stateDimension()) = smc.particles().transpose();
+    columns.bottomRows(1) = smc.weights().transpose();
+    appendMatrix(columns);
+    std::ostringstream generator;
+    generator << smc.generator();
+    appendBytes(generator.str());
+    endRecord();
+}
+
+void CheckpointWriter::commit() {
+    beginRecord(CheckpointKind::Commit, 0);
+    endRecord();
+    writeAll(fd_, buffer_.data(), buffer_.size());
+    buffer_.clear();
+    if (::fsync(fd_) != 0) {
+        throw std::runtime_error("Cannot sync " + path_ + ".");
+    }
+}
+
+void CheckpointWriter::compact(const std::string& from, const std::string& to) {
+    CheckpointReader reader(from);
+    ::unlink(to.c_str());
+    CheckpointWriter writer(to);
+    for (const auto& entry : reader.index_) {
+        const char* data;
+        std::size_t size;
+        reader.record(entry.first, data, size);
+        writer.appendRaw(data, size);
+    }
+    writer.commit();
+}
+
+void CheckpointWriter::beginRecord(CheckpointKind kind, long id) {
+    record_start_ = buffer_.size();
+    RecordHeader header{kRecordMagic, static_cast<std::uint16_t>(kind), kRecordVersion,
+                        static_cast<std::int64_t>(id), 0};
+    appendRaw(&header, sizeof(header));
+}
+
+void CheckpointWriter::endRecord() {
+    std::uint64_t bytes = buffer_.size() - record_start_ - sizeof(RecordHeader);
+    std::memcpy(buffer_.data() + record_start_ + offsetof(RecordHeader, bytes), &bytes, sizeof(bytes));
+}
+
+void CheckpointWriter::appendMatrix(const Eigen::Ref<const Eigen::MatrixXd>& M) {
+    std::int64_t shape[2] = {M.rows(), M.cols()};
+    appendRaw(shape, sizeof(shape));
+    for (Eigen::Index j = 0; j < M.cols(); ++j) {
+        appendRaw(M.col(j).data(), static_cast<std::size_t>(M.rows()) * sizeof(double));
+    }
+}
+
+void CheckpointWriter::appendBytes(const std::string& bytes) {
+    // Marked by a row count of -1, padded to the next 8 bytes
+    std::int64_t shape[2] = {-1, static_cast<std::int64_t>(bytes.size())};
+    appendRaw(shape, sizeof(shape));
+    appendRaw(bytes.data(), bytes.size());
+    buffer_.resize(padded(buffer_.size()), '\0');
+}
+
+void CheckpointWriter::appendRaw(const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+}
+
+CheckpointReader::CheckpointReader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ".");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ".");
+    }
+    bytes_ = static_cast<std::size_t>(info.st_size);
+    if (bytes_ < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error(path + " is not a checkpoint file.");
+    }
+    void* address = ::mmap(nullptr, bytes_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path + ".");
+    }
+    data_ = static_cast<const char*>(address);
+
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        ::munmap(const_cast<char*>(data_), bytes_);
+        throw std::runtime_error(path + " is not a checkpoint file.");
+    }
+    if (header.version != kFormatVersion) {
+        ::munmap(const_cast<char*>(data_), bytes_);
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(header.version) + ".");
+    }
+
+    // Index the records of every complete batch; a torn tail is ignored
+    std::vector<std::pair<long, std::size_t>> batch;
+    std::size_t offset = sizeof(FileHeader);
+    committed_bytes_ = offset;
+    while (bytes_ - offset >= sizeof(RecordHeader)) {
+        RecordHeader record;
+        std::memcpy(&record, data_ + offset, sizeof(record));
+        if (record.magic != kRecordMagic || record.bytes > bytes_ - offset - sizeof(RecordHeader)) {
+            break;
+        }
+        std::size_t next = offset + sizeof(RecordHeader) + record.bytes;
+        if (record.kind == static_cast<std::uint16_t>(CheckpointKind::Commit)) {
+            for (const auto& entry : batch) {
+                index_[entry.first] = entry.second;
+            }
+            batch.clear();
+            committed_bytes_ = next;
+        } else {
+            batch.emplace_back(static_cast<long>(record.id), offset);
+        }
+        offset = next;
+    }
+    ::madvise(const_cast<char*>(data_), bytes_, MADV_WILLNEED);
+}
+
+CheckpointReader::~CheckpointReader() {
+    ::munmap(const_cast<char*>(data_), bytes_);
+}
+
+std::size_t CheckpointReader::size() const {
+    return index_.size();
+}
+
+bool CheckpointReader::contains(long id) const {
+    return index_.count(id) > 0;
+}
+
+std::vector<long> CheckpointReader::ids() const {
+    std::vector<long> ids;
+    ids.reserve(index_.size());
+    for (const auto& entry : index_) {
+        ids.push_back(entry.first);
+    }
+    return ids;
+}
+
+CheckpointKind CheckpointReader::kind(long id) const {
+    const char* data;
+    std::size_t size;
+    record(id, data, size);
+    RecordHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    return static_cast<CheckpointKind>(header.kind);
+}
+
+void CheckpointReader::restore(long id, KalmanFilter& kf) const {
+    Payload p = payload(id, CheckpointKind::KalmanFilter);
+    Eigen::Map<const Eigen::MatrixXd> scalars = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> x = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> P = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> A = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> C = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> Q = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> R = p.matrix();
+    // The record replaces the whole filter, so it has to be consistent in
+    // itself before kf is touched
+    if (scalars.size() != 4) {
+        throw std::invalid_argument("Kalman filter checkpoint has " + std::to_string(scalars.size()) +
+                                    " scalars instead of 4.");
+    }
+    const Eigen::Index n = x.rows();
+    if (x.cols() != 1 || !isSquare(P, n) || !isSquare(A, n) || !isSquare(Q, n) || C.cols() != n ||
+        !isSquare(R, C.rows())) {
+        throw std::invalid_argument("Kalman filter checkpoint has inconsistent dimensions.");
+    }
+    if (!isEnumerator(scalars(2), 3) || !isEnumerator(scalars(3), 3)) {
+        throw std::invalid_argument("Kalman filter checkpoint has an unknown update strategy.");
+    }
+    kf = KalmanFilter(scalars(0), A, C, Q, R, P);
+    kf.setUpdateStrategy({static_cast<GainSolver>(scalars(2)), static_cast<CovarianceUpdate>(scalars(3))});
+    kf.init(x, P, scalars(1));
+}
+
+void CheckpointReader::restore(long id, ExtendedKalmanFilter& ekf) const {
+    Payload p = payload(id, CheckpointKind::ExtendedKalmanFilter);
+    Eigen::Map<const Eigen::MatrixXd> x = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> P = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> Q = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> R = p.matrix();
+    checkNoiseShapes(x, P, Q, R, ekf.state().size(), ekf.measurementNoise().rows());
+    ekf.setState(x, P);
+    ekf.setNoiseCovariances(Q, R);
+}
+
+void CheckpointReader::restore(long id, UnscentedKalmanFilter& ukf) const {
+    Payload p = payload(id, CheckpointKind::UnscentedKalmanFilter);
+    Eigen::Map<const Eigen::MatrixXd> x = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> P = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> Q = p.matrix();
+    Eigen::Map<const Eigen::MatrixXd> R = p.matrix();
+    checkNoiseShapes(x, P, Q, R, ukf.state().size(), ukf.measurementNoise().rows());
+    ukf.setState(x, P);
+    ukf.setNoiseCovariances(Q, R);
+}
+
+void CheckpointReader::restore(long id, SequentialMonteCarlo& smc) const {
+    Payload p = payload(id, CheckpointKind::SequentialMonteCarlo);
+    Eigen::Map<const Eigen::MatrixXd> columns = p.matrix();
+    if (columns.rows() != smc.stateDimension() + 1) {
+        throw std::invalid_argument("Checkpoint does not match the filter dimensions.");
+    }
+    std::default_random_engine gen;
+    std::istringstream generator(p.bytes());
+    generator >> gen;
+    smc.setParticles(columns.topRows(smc.stateDimension()).transpose(), columns.bottomRows(1).transpose());
+    smc.setGenerator(gen);
+}
+
+CheckpointReader::Payload CheckpointReader::payload(long id, CheckpointKind kind) const {
+    const char* data;
+    std::size_t size;
+    record(id, data, size);
+    RecordHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.kind != static_cast<std::uint16_t>(kind)) {
+        throw std::invalid_argument("Checkpoint of filter " + std::to_string(id) + " holds another filter type.");
+    }
+    if (header.version != kRecordVersion) {
+        throw std::runtime_error("Unsupported checkpoint record version " + std::to_string(header.version) + ".");
+    }
+    return Payload(data + sizeof(RecordHeader), size - sizeof(RecordHeader));
+}
+
+void CheckpointReader::record(long id, const char*& data, std::size_t& size) const {
+    auto entry = index_.find(id);
+    if (entry == index_.end()) {
+        throw std::out_of_range("No checkpoint for filter " + std::to_string(id) + ".");
+    }
+    RecordHeader header;
+    std::memcpy(&header, data_ + entry->second, sizeof(header));
+    data = data_ + entry->second;
+    size = sizeof(RecordHeader) + header.bytes;
+}
+
+CheckpointReader::Payload::Payload(const char* data, std::size_t size)
+    : data_(data), size_(size) {}
+
+Eigen::Map<const Eigen::MatrixXd> CheckpointReader::Payload::matrix() {
+    std::int64_t shape[2];
+    std::memcpy(shape, take(sizeof(shape)), sizeof(shape));
+    if (shape[0] < 0 || shape[1] < 0) {
+        throw std::runtime_error("Corrupt checkpoint record.");
+    }
+    // Bound the shape by the remaining payload before multiplying, so a
+    // corrupt record cannot wrap the size around to something small
+    const std::uint64_t rows = static_cast<std::uint64_t>(shape[0]);
+    const std::uint64_t cols = static_cast<std::uint64_t>(shape[1]);
+    if (cols != 0 && rows > (size_ - offset_) / sizeof(double) / cols) {
+        throw std::runtime_error("Corrupt checkpoint record.");
+    }
+    std::size_t count = static_cast<std::size_t>(shape[0] * shape[1]);
+    const double* values = reinterpret_cast<const double*>(take(count * sizeof(double)));
+    return Eigen::Map<const Eigen::MatrixXd>(values, shape[0], shape[1]);
+}
+
+std::string CheckpointReader::Payload::bytes() {
+    std::int64_t shape[2];
+    std::memcpy(shape, take(sizeof(shape)), sizeof(shape));
+    if (shape[0] != -1 || shape[1] < 0) {
+        throw std::runtime_error("Corrupt checkpoint record.");
+    }
+    std::size_t size = static_cast<std::size_t>(shape[1]);
+    return std::string(take(padded(size)), size);
+}
+
+const char* CheckpointReader::Payload::take(std::size_t size) {
+    if (size > size_ - offset_) {
+        throw std::runtime_error("Corrupt checkpoint record.");
+    }
+    const char* data = data_ + offset_;
+    offset_ += size;
+    return data;
+}
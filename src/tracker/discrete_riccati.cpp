@@ -0,0 +1,42 @@
+#include <stdexcept>
+#include <discrete_riccati.h>
+
+Eigen::MatrixXd solveDiscreteRiccati(const Eigen::MatrixXd& A,
+                                     const Eigen::MatrixXd& C,
+                                     const Eigen::MatrixXd& Q,
+                                     const Eigen::MatrixXd& R,
+                                     double tolerance,
+                                     int max_iterations) {
+    const Eigen::Index n = A.rows();
+    Eigen::LLT<Eigen::MatrixXd> R_llt(R);
+    if (R_llt.info() != Eigen::Success) {
+        throw std::invalid_argument("Measurement noise covariance must be positive definite.");
+    }
+
+    // Doubling iteration on the dual (control) form with A' and C'
+    Eigen::MatrixXd Ak = A.transpose();
+    Eigen::MatrixXd G = C.transpose() * R_llt.solve(C);
+    Eigen::MatrixXd H = Q;
+    Eigen::MatrixXd I = Eigen::MatrixXd::Identity(n, n);
+
+    for (int iteration = 0; iteration < max_iterations; ++iteration) {
+        Eigen::PartialPivLU<Eigen::MatrixXd> W(I + G * H);
+        Eigen::MatrixXd WA = W.solve(Ak);
+        Eigen::MatrixXd WG = W.solve(G);
+
+        Eigen::MatrixXd H_next = H + Ak.transpose() * H * WA;
+        G += Ak * WG * Ak.transpose();
+        Ak = Ak * WA;
+
+        // Keep the iterates symmetric against rounding
+        H_next = 0.5 * (H_next + H_next.transpose()).eval();
+        G = 0.5 * (G + G.transpose()).eval();
+
+        double change = (H_next - H).norm();
+        H = H_next;
+        if (change <= tolerance * H.norm()) {
+            return H;
+        }
+    }
+    throw std::runtime_error("Riccati iteration did not converge; check that the model is detectable.");
+}
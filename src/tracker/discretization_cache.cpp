@@ -0,0 +1,72 @@
+#include <cmath>
+#include <stdexcept>
+#include <unsupported/Eigen/MatrixFunctions>
+#include <discretization_cache.h>
+
+DiscretizationCache::DiscretizationCache(const Eigen::MatrixXd& Ac,
+                                         const Eigen::MatrixXd& Qc,
+                                         int capacity,
+                                         double resolution)
+    : Ac_(Ac), Qc_(Qc), capacity_(capacity), resolution_(resolution)
+{
+    if (capacity_ < 1 || resolution_ <= 0.0) {
+        throw std::invalid_argument("Cache capacity and resolution must be positive.");
+    }
+    entries_.reserve(capacity_);
+}
+
+const DiscretizationCache::Discretization& DiscretizationCache::get(double dt) {
+    long long key = std::llround(dt / resolution_);
+    ++clock_;
+    for (auto& entry : entries_) {
+        if (entry.key == key) {
+            entry.last_used = clock_;
+            ++hits_;
+            return entry.model;
+        }
+    }
+
+    ++misses_;
+    Discretization model = discretize(key * resolution_);
+    if (static_cast<int>(entries_.size()) < capacity_) {
+        entries_.push_back({key, clock_, std::move(model)});
+        return entries_.back().model;
+    }
+    // Evict the least recently used interval
+    Entry* oldest = &entries_[0];
+    for (auto& entry : entries_) {
+        if (entry.last_used < oldest->last_used) {
+            oldest = &entry;
+        }
+    }
+    *oldest = {key, clock_, std::move(model)};
+    return oldest->model;
+}
+
+bool DiscretizationCache::valid() const {
+    return capacity_ > 0;
+}
+
+int DiscretizationCache::hits() const {
+    return hits_;
+}
+
+int DiscretizationCache::misses() const {
+    return misses_;
+}
+
+DiscretizationCache::Discretization DiscretizationCache::discretize(double dt) const {
+    // Van Loan: exp([-Ac Qc; 0 Ac'] dt) = [. G12; 0 G22], A = G22', Q = A G12
+    const Eigen::Index n = Ac_.rows();
+    Eigen::MatrixXd M = Eigen::MatrixXd::Zero(2 * n, 2 * n);
+    M.topLeftCorner(n, n) = -Ac_ * dt;
+    M.topRightCorner(n, n) = Qc_ * dt;
+    M.bottomRightCorner(n, n) = Ac_.transpose() * dt;
+    Eigen::MatrixXd G = M.exp();
+
+    Discretization model;
+    model.A = G.bottomRightCorner(n, n).transpose();
+    model.Q = model.A * G.topRightCorner(n, n);
+    model.Q = 0.5 * (model.Q + model.Q.transpose()).eval();
+    return model;
+}
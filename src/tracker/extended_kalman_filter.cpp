@@ -1,5 +1,6 @@
 
 #include <functional>
+#include <stdexcept>
 #include <extended_kalman_filter.h>
 
 ExtendedKalmanFilter::ExtendedKalmanFilter(
@@ -17,6 +18,8 @@ void ExtendedKalmanFilter::setProcessModel(
 ) {
     f_ = f;
     F_ = F;
+    fF_ = nullptr;
+    process_jacobian_.age = 0;
 }
 
 void ExtendedKalmanFilter::setMeasurementModel(
@@ -25,23 +28,162 @@ void ExtendedKalmanFilter::setMeasurementModel(
 ) {
     h_ = h;
     H_ = H;
+    hH_ = nullptr;
+    measurement_jacobian_.age = 0;
+}
+
+void ExtendedKalmanFilter::setLinearizedProcessModel(const LinearizedModel& f) {
+    fF_ = f;
+    f_ = nullptr;
+    F_ = nullptr;
+}
+
+void ExtendedKalmanFilter::setLinearizedMeasurementModel(const LinearizedModel& h) {
+    hH_ = h;
+    h_ = nullptr;
+    H_ = nullptr;
 }
 
 void ExtendedKalmanFilter::predict() {
+    if (fF_) {
+        // Value and Jacobian from the same evaluation at the prior
+        fF_(x_, fx_, Fk_);
+        x_.swap(fx_);
+        P_ = Fk_ * P_ * Fk_.transpose() + Q_;
+        return;
+    }
     if (!f_ || !F_) return; // Optionally throw or assert
+    // Linearize about the prior estimate
+    if (needsJacobian(process_jacobian_, x_)) {
+        Fk_ = F_(x_);
+    }
     x_ = f_(x_);
-    Eigen::MatrixXd Fk = F_(x_);
-    P_ = Fk * P_ * Fk.transpose() + Q_;
+    P_ = Fk_ * P_ * Fk_.transpose() + Q_;
 }
 
 void ExtendedKalmanFilter::update(const Eigen::VectorXd& z) {
-    if (!h_ || !H_) return; // Optionally throw or assert
-    Eigen::VectorXd y = z - h_(x_);
-    Eigen::MatrixXd Hk = H_(x_);
-    Eigen::MatrixXd S = Hk * P_ * Hk.transpose() + R_;
-    Eigen::MatrixXd K = P_ * Hk.transpose() * S.inverse();
-    x_ = x_ + K * y;
-    P_ = (Eigen::MatrixXd::Identity(x_.size(), x_.size()) - K * Hk) * P_;
+    if (!hH_ && (!h_ || !H_)) return; // Optionally throw or assert
+    if (max_iterations_ > 1) {
+        iteratedUpdate(z);
+        return;
+    }
+    evaluateMeasurement(x_, true);
+    y_ = z - y_;
+    corrector_.correct(x_, P_, Hk_, R_, y_);
+    iterations_ = 1;
+    if (iteration_callback_) {
+        iteration_callback_(1, 0.0);
+    }
+}
+
+void ExtendedKalmanFilter::iteratedUpdate(const Eigen::VectorXd& z) {
+    x_prior_ = x_;
+    x_iter_ = x_;
+    double step = 0.0;
+    int i = 0;
+    while (i < max_iterations_) {
+        ++i;
+        // Linearize about x_iter_ and correct the prior:
+        // innovation z - h(x_iter_) - H (x_prior_ - x_iter_)
+        evaluateMeasurement(x_iter_, false);
+        dx_ = x_prior_ - x_iter_;
+        y_ = z - y_;
+        y_.noalias() -= Hk_ * dx_;
+        x_next_ = x_prior_;
+        P_iter_ = P_;
+        corrector_.correct(x_next_, P_iter_, Hk_, R_, y_);
+
+        step = (x_next_ - x_iter_).norm();
+        x_iter_.swap(x_next_);
+        if (step <= tolerance_) {
+            break;
+        }
+    }
+    x_.swap(x_iter_);
+    P_.swap(P_iter_);
+    iterations_ = i;
+    if (iteration_callback_) {
+        iteration_callback_(i, step);
+    }
+}
+
+void ExtendedKalmanFilter::evaluateMeasurement(const Eigen::VectorXd& x, bool reuse_jacobian) {
+    if (hH_) {
+        hH_(x, y_, Hk_);
+    } else {
+        y_ = h_(x);
+        if (!reuse_jacobian) {
+            measurement_jacobian_.age = 0;
+        }
+        if (needsJacobian(measurement_jacobian_, x)) {
+            Hk_ = H_(x);
+        }
+    }
+}
+
+bool ExtendedKalmanFilter::needsJacobian(CachedJacobian& cache, const Eigen::VectorXd& x) {
+    if (cache.age > 0 && cache.age < refresh_policy_.max_age &&
+        (x - cache.point).norm() <= refresh_policy_.state_threshold) {
+        ++cache.age;
+        ++cache.counters.skipped;
+        return false;
+    }
+    cache.point = x;
+    cache.age = 1;
+    ++cache.counters.evaluated;
+    return true;
+}
+
+void ExtendedKalmanFilter::setJacobianRefreshPolicy(const JacobianRefreshPolicy& policy) {
+    if (policy.max_age < 1 || policy.state_threshold < 0.0) {
+        throw std::invalid_argument("Jacobian refresh policy needs max_age >= 1 and a non-negative threshold.");
+    }
+    refresh_policy_ = policy;
+}
+
+const JacobianCounters& ExtendedKalmanFilter::processJacobianCounters() const {
+    return process_jacobian_.counters;
+}
+
+const JacobianCounters& ExtendedKalmanFilter::measurementJacobianCounters() const {
+    return measurement_jacobian_.counters;
+}
+
+void ExtendedKalmanFilter::setIteratedUpdate(int max_iterations, double tolerance) {
+    if (max_iterations < 1 || tolerance < 0.0) {
+        throw std::invalid_argument("Iterated update needs at least one iteration and a non-negative tolerance.");
+    }
+    max_iterations_ = max_iterations;
+    tolerance_ = tolerance;
+}
+
+void ExtendedKalmanFilter::setIterationCallback(const IterationCallback& callback) {
+    iteration_callback_ = callback;
+}
+
+int ExtendedKalmanFilter::iterationCount() const {
+    return iterations_;
+}
+
+void ExtendedKalmanFilter::setUpdateStrategy(const UpdateStrategy& strategy) {
+    corrector_.setStrategy(strategy);
+}
+
+void ExtendedKalmanFilter::setNoiseCovariances(const Eigen::MatrixXd& Q, const Eigen::MatrixXd& R) {
+    Q_ = Q;
+    R_ = R;
+}
+
+const Eigen::MatrixXd& ExtendedKalmanFilter::transitionJacobian() const {
+    return Fk_;
+}
+
+const Eigen::MatrixXd& ExtendedKalmanFilter::processNoise() const {
+    return Q_;
+}
+
+const Eigen::MatrixXd& ExtendedKalmanFilter::measurementNoise() const {
+    return R_;
 }
 
 const Eigen::VectorXd& ExtendedKalmanFilter::state() const {
@@ -50,4 +192,13 @@ const Eigen::VectorXd& ExtendedKalmanFilter::state() const {
 
 const Eigen::MatrixXd& ExtendedKalmanFilter::covariance() const {
     return P_;
+}
+
+void ExtendedKalmanFilter::setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    x_ = x;
+    P_ = P;
+}
+
+double ExtendedKalmanFilter::logLikelihood() const {
+    return corrector_.logLikelihood();
 }
\ No newline at end of file
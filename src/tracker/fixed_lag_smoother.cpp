@@ -0,0 +1,123 @@
+#include <stdexcept>
+#include <extended_kalman_filter.h>
+#include <fixed_lag_smoother.h>
+#include <kalman_filter.h>
+
+namespace {
+
+// Validates the lag before the ring buffers are sized from it
+int checkedLag(int lag) {
+    if (lag < 0) {
+        throw std::invalid_argument("Lag must not be negative.");
+    }
+    return lag;
+}
+
+} // namespace
+
+FixedLagSmoother::FixedLagSmoother(int state_dim, int lag)
+    : n_(state_dim), lag_(checkedLag(lag)), window_(lag_ + 1), fixed_transition_(false),
+      F_(state_dim, state_dim * window_),
+      x_predicted_(state_dim, window_), P_predicted_(state_dim, state_dim * window_),
+      x_filtered_(state_dim, window_), P_filtered_(state_dim, state_dim * window_),
+      x_(state_dim), P_(state_dim, state_dim), x_next_(state_dim), P_next_(state_dim, state_dim)
+{
+}
+
+FixedLagSmoother::FixedLagSmoother(const Eigen::MatrixXd& A, int lag)
+    : FixedLagSmoother(static_cast<int>(A.rows()), lag)
+{
+    fixed_transition_ = true;
+    A_ = A;
+    F_.resize(0, 0);
+}
+
+void FixedLagSmoother::addPrediction(const Eigen::MatrixXd& F, const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (fixed_transition_) {
+        throw std::logic_error("Smoother was constructed with a fixed transition matrix.");
+    }
+    F_.middleCols(slot(predictions_) * n_, n_) = F;
+    x_predicted_.col(slot(predictions_)) = x;
+    P_predicted_.middleCols(slot(predictions_) * n_, n_) = P;
+    ++predictions_;
+}
+
+void FixedLagSmoother::addPrediction(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (!fixed_transition_) {
+        throw std::logic_error("Smoother has no fixed transition matrix.");
+    }
+    x_predicted_.col(slot(predictions_)) = x;
+    P_predicted_.middleCols(slot(predictions_) * n_, n_) = P;
+    ++predictions_;
+}
+
+bool FixedLagSmoother::addUpdate(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (steps_ + 1 != predictions_) {
+        throw std::logic_error("Every update must follow a prediction.");
+    }
+    x_filtered_.col(slot(steps_)) = x;
+    P_filtered_.middleCols(slot(steps_) * n_, n_) = P;
+    ++steps_;
+    if (steps_ < window_) {
+        return false;
+    }
+
+    // Backward pass from the newest step to the oldest one in the window
+    x_ = x;
+    P_ = P;
+    for (long k = steps_ - 2; k >= steps_ - window_; --k) {
+        int next = slot(k + 1);
+        x_next_.swap(x_);
+        P_next_.swap(P_);
+        x_ = x_filtered_.col(slot(k));
+        P_ = P_filtered_.middleCols(slot(k) * n_, n_);
+        const auto F = fixed_transition_ ? A_.middleCols(0, n_) : F_.middleCols(next * n_, n_);
+        backward_.apply(F,
+                        x_predicted_.col(next), P_predicted_.middleCols(next * n_, n_),
+                        x_next_, P_next_, x_, P_);
+    }
+    return true;
+}
+
+bool FixedLagSmoother::step(KalmanFilter& kf, const Eigen::VectorXd& y) {
+    kf.predict();
+    if (fixed_transition_) {
+        addPrediction(kf.state(), kf.covariance());
+    } else {
+        addPrediction(kf.transitionMatrix(), kf.state(), kf.covariance());
+    }
+    kf.update(y);
+    return addUpdate(kf.state(), kf.covariance());
+}
+
+bool FixedLagSmoother::step(ExtendedKalmanFilter& ekf, const Eigen::VectorXd& z) {
+    ekf.predict();
+    addPrediction(ekf.transitionJacobian(), ekf.state(), ekf.covariance());
+    ekf.update(z);
+    return addUpdate(ekf.state(), ekf.covariance());
+}
+
+void FixedLagSmoother::clear() {
+    steps_ = 0;
+    predictions_ = 0;
+}
+
+int FixedLagSmoother::lag() const {
+    return lag_;
+}
+
+long FixedLagSmoother::index() const {
+    return steps_ - window_;
+}
+
+const Eigen::VectorXd& FixedLagSmoother::state() const {
+    return x_;
+}
+
+const Eigen::MatrixXd& FixedLagSmoother::covariance() const {
+    return P_;
+}
+
+int FixedLagSmoother::slot(long step) const {
+    return static_cast<int>(step % window_);
+}
@@ -0,0 +1,132 @@
+#include <stdexcept>
+#include <information_filter.h>
+
+InformationFilter::InformationFilter(double dt,
+                                     const Eigen::MatrixXd& A,
+                                     const Eigen::MatrixXd& C,
+                                     const Eigen::MatrixXd& Q,
+                                     const Eigen::MatrixXd& R,
+                                     const Eigen::MatrixXd& P)
+    : dt_(dt), A_(A), Q_(Q)
+{
+    addSensor(C, R);
+    llt_.compute(P);
+    if (llt_.info() != Eigen::Success) {
+        throw std::invalid_argument("Initial covariance must be positive definite.");
+    }
+    Y_ = llt_.solve(Eigen::MatrixXd::Identity(P.rows(), P.cols()));
+    y_ = Eigen::VectorXd::Zero(P.rows());
+}
+
+InformationFilter::InformationFilter(const KalmanFilter& kf)
+    : InformationFilter(kf.timeStep(), kf.transitionMatrix(), kf.observationMatrix(),
+                        kf.processNoise(), kf.measurementNoise(), kf.covariance())
+{
+    init(kf.state());
+}
+
+KalmanFilter InformationFilter::toKalmanFilter() const {
+    KalmanFilter kf(dt_, A_, sensors_[0].C, Q_, sensors_[0].R, covariance());
+    kf.init(state());
+    return kf;
+}
+
+void InformationFilter::init(const Eigen::VectorXd& x0) {
+    y_.noalias() = Y_ * x0;
+    solved_ = false;
+}
+
+int InformationFilter::addSensor(const Eigen::MatrixXd& C, const Eigen::MatrixXd& R) {
+    Eigen::LLT<Eigen::MatrixXd> R_llt(R);
+    if (R_llt.info() != Eigen::Success) {
+        throw std::invalid_argument("Measurement noise covariance must be positive definite.");
+    }
+    Sensor sensor;
+    sensor.C = C;
+    sensor.R = R;
+    sensor.CtRinv = R_llt.solve(C).transpose();
+    sensor.CtRinvC = sensor.CtRinv * C;
+    sensors_.push_back(sensor);
+    return static_cast<int>(sensors_.size()) - 1;
+}
+
+void InformationFilter::predict() {
+    // Prediction is done in moment form: P = A P A' + Q, x = A x
+    solve();
+    x_ = A_ * x_;
+    P_ = A_ * P_ * A_.transpose() + Q_;
+
+    llt_.compute(P_);
+    if (llt_.info() != Eigen::Success) {
+        throw std::runtime_error("Predicted covariance is not positive definite.");
+    }
+    Y_ = llt_.solve(Eigen::MatrixXd::Identity(P_.rows(), P_.cols()));
+    y_.noalias() = Y_ * x_;
+    solved_ = true;
+}
+
+void InformationFilter::update(const Eigen::VectorXd& z) {
+    update(0, z);
+}
+
+void InformationFilter::update(int sensor, const Eigen::VectorXd& z) {
+    const Sensor& s = sensors_.at(sensor);
+    Y_ += s.CtRinvC;
+    y_.noalias() += s.CtRinv * z;
+    solved_ = false;
+}
+
+void InformationFilter::accumulate(int sensor, const Eigen::VectorXd& z, InformationContribution& out) const {
+    const Sensor& s = sensors_.at(sensor);
+    out.Y += s.CtRinvC;
+    out.y.noalias() += s.CtRinv * z;
+}
+
+void InformationFilter::fuse(const InformationContribution& contribution) {
+    Y_ += contribution.Y;
+    y_ += contribution.y;
+    solved_ = false;
+}
+
+void InformationFilter::solve() const {
+    if (solved_) {
+        return;
+    }
+    llt_.compute(Y_);
+    if (llt_.info() != Eigen::Success) {
+        throw std::runtime_error("Information matrix is not positive definite.");
+    }
+    x_ = llt_.solve(y_);
+    P_ = llt_.solve(Eigen::MatrixXd::Identity(Y_.rows(), Y_.cols()));
+    solved_ = true;
+}
+
+const Eigen::VectorXd& InformationFilter::state() const {
+    solve();
+    return x_;
+}
+
+const Eigen::MatrixXd& InformationFilter::covariance() const {
+    solve();
+    return P_;
+}
+
+void InformationFilter::setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    llt_.compute(P);
+    if (llt_.info() != Eigen::Success) {
+        throw std::invalid_argument("State covariance must be positive definite.");
+    }
+    x_ = x;
+    P_ = P;
+    Y_ = llt_.solve(Eigen::MatrixXd::Identity(P.rows(), P.cols()));
+    y_.noalias() = Y_ * x;
+    solved_ = true;
+}
+
+const Eigen::MatrixXd& InformationFilter::informationMatrix() const {
+    return Y_;
+}
+
+const Eigen::VectorXd& InformationFilter::informationVector() const {
+    return y_;
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <interacting_multiple_model.h>
+#include <kalman_corrector.h>
+
+InteractingMultipleModel::InteractingMultipleModel(std::vector<std::unique_ptr<BaseKalmanFilter>> models,
+                                                   const Eigen::MatrixXd& transition,
+                                                   const Eigen::VectorXd& probabilities)
+    : models_(std::move(models)), transition_(transition), mu_(probabilities)
+{
+    int M = static_cast<int>(models_.size());
+    if (M == 0) {
+        throw std::invalid_argument("IMM requires at least one model.");
+    }
+    if (transition_.rows() != M || transition_.cols() != M || mu_.size() != M) {
+        throw std::invalid_argument("Transition matrix and probabilities must match the number of models.");
+    }
+    if ((transition_.array() < 0.0).any() ||
+        ((transition_.rowwise().sum().array() - 1.0).abs() > 1e-9).any()) {
+        throw std::invalid_argument("Transition matrix rows must be probability distributions.");
+    }
+    if ((mu_.array() < 0.0).any() || std::abs(mu_.sum() - 1.0) > 1e-9) {
+        throw std::invalid_argument("Model probabilities must be a probability distribution.");
+    }
+    Eigen::Index n = models_[0]->state().size();
+    for (const auto& model : models_) {
+        if (!model || model->state().size() != n) {
+            throw std::invalid_argument("Models must share the state dimension.");
+        }
+    }
+
+    c_.resize(M);
+    x_mixed_.assign(M, Eigen::VectorXd(n));
+    P_mixed_.assign(M, Eigen::MatrixXd(n, n));
+    spread_.resize(n, M);
+    log_l_.resize(M);
+    combine();
+}
+
+void InteractingMultipleModel::setThreadPool(ThreadPool* pool) {
+    pool_ = pool;
+}
+
+void InteractingMultipleModel::predict() {
+    // Predicted model probabilities c_j = sum_i p_ij mu_i
+    c_.noalias() = transition_.transpose() * mu_;
+
+    // Mixing reads every model, so it completes before any model moves
+    runModels(&InteractingMultipleModel::mix);
+    runModels(&InteractingMultipleModel::predictModel);
+    mu_ = c_;
+    combine();
+}
+
+void InteractingMultipleModel::update(const Eigen::VectorXd& z) {
+    z_ = &z;
+    runModels(&InteractingMultipleModel::updateModel);
+    z_ = nullptr;
+
+    // mu_j ~ mu_j * exp(log_l_j), normalized in log space
+    double max_log = -std::numeric_limits<double>::infinity();
+    for (int j = 0; j < modelCount(); ++j) {
+        log_l_(j) = mu_(j) > 0.0 ? std::log(mu_(j)) + log_l_(j) : -std::numeric_limits<double>::infinity();
+        max_log = std::max(max_log, log_l_(j));
+    }
+    if (!std::isfinite(max_log)) {
+        throw std::runtime_error("Measurement has zero likelihood under every model.");
+    }
+    double sum = 0.0;
+    for (int j = 0; j < modelCount(); ++j) {
+        mu_(j) = std::exp(log_l_(j) - max_log);
+        sum += mu_(j);
+    }
+    mu_ /= sum;
+    log_likelihood_ = max_log + std::log(sum);
+    combine();
+}
+
+const Eigen::VectorXd& InteractingMultipleModel::state() const {
+    return x_;
+}
+
+const Eigen::MatrixXd& InteractingMultipleModel::covariance() const {
+    return P_;
+}
+
+void InteractingMultipleModel::setState(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    for (auto& model : models_) {
+        model->setState(x, P);
+    }
+    combine();
+}
+
+double InteractingMultipleModel::logLikelihood() const {
+    return log_likelihood_;
+}
+
+int InteractingMultipleModel::modelCount() const {
+    return static_cast<int>(models_.size());
+}
+
+BaseKalmanFilter& InteractingMultipleModel::model(int j) {
+    return *models_[j];
+}
+
+const BaseKalmanFilter& InteractingMultipleModel::model(int j) const {
+    return *models_[j];
+}
+
+const Eigen::VectorXd& InteractingMultipleModel::modelProbabilities() const {
+    return mu_;
+}
+
+void InteractingMultipleModel::runModels(Step step) {
+    if (!pool_ || modelCount() == 1) {
+        for (int j = 0; j < modelCount(); ++j) {
+            (this->*step)(j);
+        }
+        return;
+    }
+    // Capture only this so the std::function holds the lambda without allocating
+    step_ = step;
+    pool_->parallelFor(0, modelCount(), [this](int j) { (this->*step_)(j); });
+}
+
+void InteractingMultipleModel::mix(int j) {
+    Eigen::VectorXd& x0 = x_mixed_[j];
+    Eigen::MatrixXd& P0 = P_mixed_[j];
+    if (c_(j) <= 0.0) {
+        // No model can switch into j, it keeps its own estimate
+        x0 = models_[j]->state();
+        P0 = models_[j]->covariance();
+        return;
+    }
+
+    // Mixing weights mu_i|j = p_ij mu_i / c_j
+    x0.setZero();
+    for (int i = 0; i < modelCount(); ++i) {
+        double w = transition_(i, j) * mu_(i) / c_(j);
+        if (w != 0.0) {
+            x0 += w * models_[i]->state();
+        }
+    }
+    P0.setZero();
+    auto d = spread_.col(j);
+    for (int i = 0; i < modelCount(); ++i) {
+        double w = transition_(i, j) * mu_(i) / c_(j);
+        if (w != 0.0) {
+            d = models_[i]->state() - x0;
+            P0 += w * models_[i]->covariance();
+            P0.selfadjointView<Eigen::Lower>().rankUpdate(d, w);
+        }
+    }
+    mirrorLowerTriangle(P0);
+}
+
+void InteractingMultipleModel::predictModel(int j) {
+    models_[j]->setState(x_mixed_[j], P_mixed_[j]);
+    models_[j]->predict();
+}
+
+void InteractingMultipleModel::updateModel(int j) {
+    models_[j]->update(*z_);
+    log_l_(j) = models_[j]->logLikelihood();
+}
+
+void InteractingMultipleModel::combine() {
+    x_.setZero(spread_.rows());
+    for (int j = 0; j < modelCount(); ++j) {
+        x_ += mu_(j) * models_[j]->state();
+    }
+    P_.setZero(spread_.rows(), spread_.rows());
+    for (int j = 0; j < modelCount(); ++j) {
+        if (mu_(j) == 0.0) {
+            continue;
+        }
+        spread_.col(j) = models_[j]->state() - x_;
+        P_ += mu_(j) * models_[j]->covariance();
+        P_.selfadjointView<Eigen::Lower>().rankUpdate(spread_.col(j), mu_(j));
+    }
+    mirrorLowerTriangle(P_);
+}
@@ -0,0 +1,196 @@
+#include <cmath>
+#include <stdexcept>
+#include <kalman_corrector.h>
+
+void KalmanCorrector::setStrategy(const UpdateStrategy& strategy) {
+    strategy_ = strategy;
+}
+
+const UpdateStrategy& KalmanCorrector::strategy() const {
+    return strategy_;
+}
+
+void KalmanCorrector::correct(Eigen::VectorXd& x,
+                              Eigen::MatrixXd& P,
+                              const Eigen::MatrixXd& C,
+                              const Eigen::MatrixXd& R,
+                              const Eigen::VectorXd& innovation) {
+    // Innovation covariance S = C * P * C' + R
+    CP_.noalias() = C * P;
+    S_ = R;
+    S_.noalias() += CP_ * C.transpose();
+    computeGain(S_);
+    nu_ = innovation;
+    sequential_ = false;
+    has_innovation_ = true;
+
+    x.noalias() += Kt_.transpose() * innovation;
+
+    switch (strategy_.covariance) {
+    case CovarianceUpdate::Standard:
+        subtractGainTerm(P, false);
+        break;
+    case CovarianceUpdate::Symmetric:
+        subtractGainTerm(P, true);
+        mirrorLowerTriangle(P);
+        break;
+    case CovarianceUpdate::Joseph:
+        IKC_.setIdentity(P.rows(), P.cols());
+        IKC_.noalias() -= Kt_.transpose() * C;
+        tmp_.noalias() = IKC_ * P;
+        P.noalias() = tmp_ * IKC_.transpose();
+        KR_.noalias() = Kt_.transpose() * R;
+        P.noalias() += KR_ * Kt_;
+        mirrorLowerTriangle(P);
+        break;
+    }
+}
+
+void KalmanCorrector::correctWithCrossCovariance(Eigen::VectorXd& x,
+                                                 Eigen::MatrixXd& P,
+                                                 const Eigen::MatrixXd& Pxz,
+                                                 const Eigen::MatrixXd& S,
+                                                 const Eigen::VectorXd& innovation) {
+    CP_ = Pxz.transpose();
+    S_ = S;
+    computeGain(S_);
+    nu_ = innovation;
+    sequential_ = false;
+    has_innovation_ = true;
+
+    x.noalias() += Kt_.transpose() * innovation;
+
+    if (strategy_.covariance == CovarianceUpdate::Standard) {
+        subtractGainTerm(P, false);
+    } else {
+        subtractGainTerm(P, true);
+        mirrorLowerTriangle(P);
+    }
+}
+
+void KalmanCorrector::correctSequential(Eigen::VectorXd& x,
+                                        Eigen::MatrixXd& P,
+                                        const Eigen::MatrixXd& C,
+                                        const Eigen::VectorXd& r,
+                                        const Eigen::VectorXd& y) {
+    sequential_ = true;
+    has_innovation_ = true;
+    sequential_likelihood_ = 0.0;
+    for (Eigen::Index i = 0; i < y.size(); ++i) {
+        if (std::isnan(y(i))) {
+            continue;
+        }
+        // Scalar innovation variance s = c * P * c' + r
+        pc_.noalias() = P.selfadjointView<Eigen::Lower>() * C.row(i).transpose();
+        double s = C.row(i).dot(pc_) + r(i);
+        if (!(s > 0.0) || !std::isfinite(s)) {
+            throw std::runtime_error("Innovation covariance is not positive definite.");
+        }
+        double nu = y(i) - C.row(i).dot(x);
+
+        sequential_likelihood_ -= 0.5 * (std::log(2.0 * M_PI * s) + nu * nu / s);
+        x += (nu / s) * pc_;
+        P.selfadjointView<Eigen::Lower>().rankUpdate(pc_, -1.0 / s);
+    }
+    mirrorLowerTriangle(P);
+}
+
+const Eigen::MatrixXd& KalmanCorrector::innovationCovariance() const {
+    return S_;
+}
+
+double KalmanCorrector::logLikelihood() const {
+    if (!has_innovation_) {
+        return 0.0;
+    }
+    if (sequential_) {
+        return sequential_likelihood_;
+    }
+    double log_det = 0.0;
+    switch (strategy_.solver) {
+    case GainSolver::LLT:
+        return gaussianLogLikelihood(llt_, nu_, v_);
+    case GainSolver::Inverse:
+        v_.noalias() = Sinv_ * nu_;
+        log_det = lu_.matrixLU().diagonal().array().abs().log().sum();
+        break;
+    case GainSolver::LDLT:
+        v_ = nu_;
+        ldlt_.solveInPlace(v_);
+        log_det = ldlt_.vectorD().array().log().sum();
+        break;
+    }
+    return -0.5 * (nu_.dot(v_) + log_det + nu_.size() * std::log(2.0 * M_PI));
+}
+
+void KalmanCorrector::computeGain(const Eigen::MatrixXd& S) {
+    // Solve S * K' = C * P for the transposed gain
+    switch (strategy_.solver) {
+    case GainSolver::Inverse:
+        lu_.compute(S);
+        Sinv_ = lu_.inverse();
+        Kt_.noalias() = Sinv_ * CP_;
+        break;
+    case GainSolver::LLT:
+        llt_.compute(S);
+        if (llt_.info() != Eigen::Success) {
+            throw std::runtime_error("Innovation covariance is not positive definite.");
+        }
+        W_ = CP_;
+        llt_.matrixL().solveInPlace(W_);
+        Kt_ = W_;
+        llt_.matrixU().solveInPlace(Kt_);
+        break;
+    case GainSolver::LDLT:
+        ldlt_.compute(S);
+        if (ldlt_.info() != Eigen::Success || !ldlt_.isPositive() || !(ldlt_.vectorD().array() > 0.0).all()) {
+            throw std::runtime_error("Innovation covariance is not positive definite.");
+        }
+        Kt_ = CP_;
+        ldlt_.solveInPlace(Kt_);
+        break;
+    }
+}
+
+void KalmanCorrector::subtractGainTerm(Eigen::MatrixXd& P, bool lower_only) {
+    // K * S * K' = K * C * P
+    if (!lower_only) {
+        P.noalias() -= Kt_.transpose() * CP_;
+    } else if (strategy_.solver == GainSolver::LLT) {
+        // K * S * K' = W' * W with W = L^-1 * C * P
+        P.selfadjointView<Eigen::Lower>().rankUpdate(W_.transpose(), -1.0);
+    } else if (strategy_.solver == GainSolver::LDLT) {
+        // Same with W = D^-1/2 * L^-1 * Pi * C * P, Pi the pivoting
+        W_ = ldlt_.transpositionsP() * CP_;
+        ldlt_.matrixL().solveInPlace(W_);
+        W_.array().colwise() *= ldlt_.vectorD().array().rsqrt();
+        P.selfadjointView<Eigen::Lower>().rankUpdate(W_.transpose(), -1.0);
+    } else {
+        // An explicit inverse has no factor to split, so the full product
+        // is formed and only its lower triangle kept
+        P.triangularView<Eigen::Lower>() -= Kt_.transpose() * CP_;
+    }
+}
+
+void mirrorLowerTriangle(Eigen::MatrixXd& P) {
+    for (Eigen::Index j = 1; j < P.cols(); ++j) {
+        for (Eigen::Index i = 0; i < j; ++i) {
+            P(i, j) = P(j, i);
+        }
+    }
+}
+
+double gaussianLogLikelihood(const Eigen::LLT<Eigen::MatrixXd>& S,
+                             const Eigen::VectorXd& innovation,
+                             Eigen::VectorXd& work) {
+    return gaussianLogLikelihood(S.matrixLLT(), innovation, work);
+}
+
+double gaussianLogLikelihood(const Eigen::MatrixXd& L,
+                             const Eigen::VectorXd& innovation,
+                             Eigen::VectorXd& work) {
+    work = innovation;
+    L.triangularView<Eigen::Lower>().solveInPlace(work);
+    double log_det = 2.0 * L.diagonal().array().log().sum();
+    return -0.5 * (work.squaredNorm() + log_det + innovation.size() * std::log(2.0 * M_PI));
+}
@@ -1,6 +1,10 @@
 
+#include <algorithm>
+#include <cmath>
 #include <Eigen/Dense>
 #include <iostream>
+#include <stdexcept>
+#include <discrete_riccati.h>
 #include <kalman_filter.h>
 
 // The constructor initializes the filter's matrices
@@ -17,27 +21,273 @@ void KalmanFilter::init(const Eigen::VectorXd& x0) {
     x = x0;
 }
 
+void KalmanFilter::init(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0) {
+    x = x0;
+    P = P0;
+    steady = false;
+    P_previous.resize(0, 0);
+}
+
+void KalmanFilter::init(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0, double t0) {
+    init(x0, P0);
+    t = t0;
+    history.clear();
+    record(t0, Eigen::VectorXd());
+}
+
 // Predict step
 void KalmanFilter::predict() {
+    if (discretization.valid()) {
+        propagate(discretization.get(dt));
+        t += dt;
+        return;
+    }
+
     // Predicts the next state
-    x = A * x;
+    x_next.noalias() = A * x;
+    x.swap(x_next);
+    predicted = true;
+    if (steady) {
+        return;
+    }
     // Predicts the next error covariance
-    P = A * P * A.transpose() + Q;
+    AP.noalias() = A * P;
+    P = Q;
+    P.noalias() += AP * A.transpose();
 }
 
 // Update step
 void KalmanFilter::update(const Eigen::VectorXd& y) {
-    // Calculates the Kalman Gain
-    Eigen::MatrixXd S = C * P * C.transpose() + R;
-    Eigen::MatrixXd K = P * C.transpose() * S.inverse();
+    if (steady) {
+        if (!y.hasNaN()) {
+            innovation = y;
+            innovation.noalias() -= C * x;
+            x.noalias() += K_steady * innovation;
+            steady_update = true;
+            predicted = false;
+            return;
+        }
+        // Missing channels change the gain, continue from the steady
+        // covariance of the current step
+        P = covariance();
+        steady = false;
+    }
+    predicted = false;
+    steady_update = false;
+
+    if (sequential) {
+        // One rank-1 update per measured channel
+        corrector.correctSequential(x, P, C, R_diagonal, y);
+    } else if (y.hasNaN()) {
+        // Correct with the measured channels only
+        measured_channels.clear();
+        for (Eigen::Index i = 0; i < y.size(); ++i) {
+            if (!std::isnan(y(i))) {
+                measured_channels.push_back(i);
+            }
+        }
+        if (!measured_channels.empty()) {
+            C_measured = C(measured_channels, Eigen::all);
+            R_measured = R(measured_channels, measured_channels);
+            innovation = y(measured_channels);
+            innovation.noalias() -= C_measured * x;
+            corrector.correct(x, P, C_measured, R_measured, innovation);
+        }
+    } else {
+        // Residual against the predicted measurement
+        innovation = y;
+        innovation.noalias() -= C * x;
+
+        // Calculates the Kalman Gain and updates state and error covariance
+        corrector.correct(x, P, C, R, innovation);
+    }
+
+    if (steady_tolerance > 0.0) {
+        // Freeze the gain once the covariance has converged
+        if (P_previous.size() == P.size() && (P - P_previous).norm() <= steady_tolerance * P.norm()) {
+            enterSteadyState(A * P * A.transpose() + Q);
+        } else {
+            P_previous = P;
+        }
+    }
+}
+
+void KalmanFilter::filter(const Eigen::Ref<const Eigen::MatrixXd>& Y, Eigen::Ref<Eigen::MatrixXd> means) {
+    filterSequence(Y, means, nullptr);
+}
+
+void KalmanFilter::filter(const Eigen::Ref<const Eigen::MatrixXd>& Y,
+                          Eigen::Ref<Eigen::MatrixXd> means,
+                          Eigen::Ref<Eigen::MatrixXd> variances) {
+    if (variances.rows() != A.rows() || variances.cols() != Y.cols()) {
+        throw std::invalid_argument("Variance buffer must have one column per measurement.");
+    }
+    filterSequence(Y, means, &variances);
+}
+
+void KalmanFilter::filterSequence(const Eigen::Ref<const Eigen::MatrixXd>& Y,
+                                  Eigen::Ref<Eigen::MatrixXd> means,
+                                  Eigen::Ref<Eigen::MatrixXd>* variances) {
+    if (Y.rows() != C.rows()) {
+        throw std::invalid_argument("Measurement rows must match the observation matrix.");
+    }
+    if (means.rows() != A.rows() || means.cols() != Y.cols()) {
+        throw std::invalid_argument("Mean buffer must have one column per measurement.");
+    }
+    y_step.resize(Y.rows());
+    for (Eigen::Index k = 0; k < Y.cols(); ++k) {
+        predict();
+        y_step = Y.col(k);
+        update(y_step);
+        means.col(k) = x;
+        if (variances) {
+            variances->col(k) = covariance().diagonal();
+        }
+    }
+}
 
-    // Updates the state estimate
-    Eigen::VectorXd y_hat = C * x;
-    x = x + K * (y - y_hat);
+void KalmanFilter::setUpdateStrategy(const UpdateStrategy& strategy) {
+    corrector.setStrategy(strategy);
+}
 
-    // Updates the error covariance
-    Eigen::MatrixXd I = Eigen::MatrixXd::Identity(P.rows(), P.cols());
-    P = (I - K * C) * P;
+const UpdateStrategy& KalmanFilter::updateStrategy() const {
+    return corrector.strategy();
+}
+
+void KalmanFilter::setSequentialMode(SequentialMode mode) {
+    bool diagonal = R.isDiagonal(0.0);
+    if (mode == SequentialMode::On && !diagonal) {
+        throw std::invalid_argument("Sequential update requires a diagonal measurement noise covariance.");
+    }
+    sequential = diagonal && mode != SequentialMode::Off;
+    R_diagonal = R.diagonal();
+}
+
+void KalmanFilter::setContinuousModel(const Eigen::MatrixXd& Ac, const Eigen::MatrixXd& Qc, int cache_size) {
+    discretization = DiscretizationCache(Ac, Qc, cache_size);
+    A_discrete.resize(0, 0);
+}
+
+void KalmanFilter::predictTo(double t_target) {
+    double interval = t_target - t;
+    if (interval < 0.0) {
+        throw std::invalid_argument("Cannot predict backwards in time.");
+    }
+    if (interval > 0.0) {
+        if (!discretization.valid()) {
+            throw std::logic_error("Timestamped prediction requires a continuous-time model.");
+        }
+        propagate(discretization.get(interval));
+    }
+    t = t_target;
+}
+
+bool KalmanFilter::update(double t_measured, const Eigen::VectorXd& y) {
+    if (t_measured >= t) {
+        predictTo(t_measured);
+        update(y);
+        record(t_measured, y);
+        return true;
+    }
+
+    // Out of sequence: rewind to the newest posterior not later than the measurement
+    auto later = std::upper_bound(history.begin(), history.end(), t_measured,
+        [](double value, const HistoryEntry& entry) { return value < entry.t; });
+    if (later == history.begin()) {
+        return false;
+    }
+    std::size_t anchor = static_cast<std::size_t>(later - history.begin()) - 1;
+    double t_now = t;
+    // Restart from the anchor posterior. Only the steady flag is cleared,
+    // since its cached covariance no longer describes P; the convergence
+    // bookkeeping of the automatic switch is kept.
+    x = history[anchor].x;
+    P = history[anchor].P;
+    steady = false;
+    predicted = false;
+    t = history[anchor].t;
+
+    predictTo(t_measured);
+    update(y);
+    history.insert(history.begin() + anchor + 1, HistoryEntry{t_measured, y, x, P});
+
+    // Replay the measurements that followed it
+    for (std::size_t k = anchor + 2; k < history.size(); ++k) {
+        predictTo(history[k].t);
+        if (history[k].y.size() > 0) {
+            update(history[k].y);
+        }
+        history[k].x = x;
+        history[k].P = P;
+    }
+    predictTo(t_now);
+
+    while (history.size() > history_length) {
+        history.pop_front();
+    }
+    return true;
+}
+
+void KalmanFilter::setHistoryLength(int length) {
+    history_length = static_cast<std::size_t>(length);
+    history.clear();
+    record(t, Eigen::VectorXd());
+}
+
+double KalmanFilter::time() const {
+    return t;
+}
+
+const DiscretizationCache& KalmanFilter::discretizationCache() const {
+    return discretization;
+}
+
+void KalmanFilter::propagate(const DiscretizationCache::Discretization& model) {
+    if (steady) {
+        // The steady gain belongs to the fixed discrete model
+        P = covariance();
+        steady = false;
+    }
+    A_discrete = model.A;
+    x_next.noalias() = model.A * x;
+    x.swap(x_next);
+    AP.noalias() = model.A * P;
+    P = model.Q;
+    P.noalias() += AP * model.A.transpose();
+    predicted = true;
+}
+
+void KalmanFilter::record(double t_measured, const Eigen::VectorXd& y) {
+    if (history_length == 0) {
+        return;
+    }
+    history.push_back(HistoryEntry{t_measured, y, x, P});
+    while (history.size() > history_length) {
+        history.pop_front();
+    }
+}
+
+void KalmanFilter::enableSteadyState() {
+    enterSteadyState(solveDiscreteRiccati(A, C, Q, R));
+}
+
+void KalmanFilter::setSteadyStateTolerance(double tolerance) {
+    steady_tolerance = tolerance;
+    P_previous.resize(0, 0);
+}
+
+bool KalmanFilter::isSteadyState() const {
+    return steady;
+}
+
+void KalmanFilter::enterSteadyState(const Eigen::MatrixXd& P_predicted) {
+    P_steady_predicted = P_predicted;
+    Eigen::MatrixXd CP = C * P_predicted;
+    S_steady.compute(CP * C.transpose() + R);
+    K_steady = S_steady.solve(CP).transpose();
+    P_steady_filtered = P_predicted - K_steady * CP;
+    mirrorLowerTriangle(P_steady_filtered);
+    steady = true;
 }
 
 // Get the current state estimate
@@ -46,5 +296,19 @@ const Eigen::VectorXd& KalmanFilter::state() const {
 }
 
 const Eigen::MatrixXd& KalmanFilter::covariance() const {
+    if (steady) {
+        return predicted ? P_steady_predicted : P_steady_filtered;
+    }
     return P;
+}
+
+void KalmanFilter::setState(const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0) {
+    init(x0, P0);
+}
+
+double KalmanFilter::logLikelihood() const {
+    if (steady_update) {
+        return gaussianLogLikelihood(S_steady, innovation, likelihood_work);
+    }
+    return corrector.logLikelihood();
 }
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <stdexcept>
+#include <kalman_filter_bank.h>
+
+namespace {
+// Number of filters swept together; keeps the per-block workspaces in cache.
+const int kBlockSize = 256;
+}
+
+KalmanFilterBank::KalmanFilterBank(int num_filters,
+                                   const Eigen::MatrixXd& A,
+                                   const Eigen::MatrixXd& C,
+                                   const Eigen::MatrixXd& Q,
+                                   const Eigen::MatrixXd& R,
+                                   const Eigen::MatrixXd& P)
+    : n_(static_cast<int>(A.rows())), m_(static_cast<int>(C.rows())), num_filters_(0),
+      A_(A), C_(C), Q_(Q), R_(R), P0_(P),
+      x_(0, A.rows()), P_(0, A.rows() * (A.rows() + 1) / 2), packed_(A.rows(), A.rows()),
+      xb_(kBlockSize, n_), AP_(kBlockSize, n_ * n_), W_(kBlockSize, m_ * n_),
+      S_(kBlockSize, m_ * m_), nu_(kBlockSize, m_)
+{
+    int column = 0;
+    for (int j = 0; j < n_; ++j) {
+        for (int i = j; i < n_; ++i) {
+            packed_(i, j) = packed_(j, i) = column++;
+        }
+    }
+    resize(num_filters);
+}
+
+void KalmanFilterBank::init(int i, const Eigen::VectorXd& x0) {
+    setState(i, x0, P0_);
+}
+
+void KalmanFilterBank::setState(int i, const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    x_.row(i) = x.transpose();
+    for (int c = 0; c < n_; ++c) {
+        for (int r = c; r < n_; ++r) {
+            P_(i, packed_(r, c)) = P(r, c);
+        }
+    }
+}
+
+void KalmanFilterBank::resize(int num_filters) {
+    int old_size = num_filters_;
+    x_.conservativeResize(num_filters, n_);
+    P_.conservativeResize(num_filters, P_.cols());
+    num_filters_ = num_filters;
+    for (int i = old_size; i < num_filters_; ++i) {
+        init(i, Eigen::VectorXd::Zero(n_));
+    }
+}
+
+void KalmanFilterBank::predict() {
+    for (int begin = 0; begin < num_filters_; begin += kBlockSize) {
+        predictBlock(begin, std::min(kBlockSize, num_filters_ - begin));
+    }
+}
+
+void KalmanFilterBank::update(const Eigen::MatrixXd& Y) {
+    if (Y.rows() != num_filters_ || Y.cols() != m_) {
+        throw std::invalid_argument("Measurement matrix must have one row per filter.");
+    }
+    for (int begin = 0; begin < num_filters_; begin += kBlockSize) {
+        updateBlock(begin, std::min(kBlockSize, num_filters_ - begin), Y, nullptr);
+    }
+}
+
+void KalmanFilterBank::update(const Eigen::MatrixXd& Y, const Mask& mask) {
+    if (Y.rows() != num_filters_ || Y.cols() != m_ || mask.size() != num_filters_) {
+        throw std::invalid_argument("Measurement matrix and mask must have one row per filter.");
+    }
+    for (int begin = 0; begin < num_filters_; begin += kBlockSize) {
+        updateBlock(begin, std::min(kBlockSize, num_filters_ - begin), Y, &mask);
+    }
+}
+
+void KalmanFilterBank::predictBlock(int begin, int len) {
+    // x = A * x
+    for (int i = 0; i < n_; ++i) {
+        auto xi = xb_.col(i).head(len).array();
+        xi.setZero();
+        for (int l = 0; l < n_; ++l) {
+            if (A_(i, l) != 0.0) {
+                xi += A_(i, l) * x_.col(l).segment(begin, len).array();
+            }
+        }
+    }
+    x_.middleRows(begin, len) = xb_.topRows(len);
+
+    // AP = A * P
+    for (int i = 0; i < n_; ++i) {
+        for (int k = 0; k < n_; ++k) {
+            auto ap = AP_.col(i * n_ + k).head(len).array();
+            ap.setZero();
+            for (int l = 0; l < n_; ++l) {
+                if (A_(i, l) != 0.0) {
+                    ap += A_(i, l) * P_.col(packed_(l, k)).segment(begin, len).array();
+                }
+            }
+        }
+    }
+
+    // P = AP * A' + Q, lower triangle only
+    for (int j = 0; j < n_; ++j) {
+        for (int i = j; i < n_; ++i) {
+            auto p = P_.col(packed_(i, j)).segment(begin, len).array();
+            p.setConstant(Q_(i, j));
+            for (int k = 0; k < n_; ++k) {
+                if (A_(j, k) != 0.0) {
+                    p += A_(j, k) * AP_.col(i * n_ + k).head(len).array();
+                }
+            }
+        }
+    }
+}
+
+void KalmanFilterBank::updateBlock(int begin, int len, const Eigen::MatrixXd& Y, const Mask* mask) {
+    if (mask && !mask->segment(begin, len).any()) {
+        return;
+    }
+
+    // Innovation nu = y - C * x
+    for (int r = 0; r < m_; ++r) {
+        auto nu = nu_.col(r).head(len).array();
+        nu = Y.col(r).segment(begin, len).array();
+        for (int j = 0; j < n_; ++j) {
+            if (C_(r, j) != 0.0) {
+                nu -= C_(r, j) * x_.col(j).segment(begin, len).array();
+            }
+        }
+        if (mask) {
+            nu = mask->segment(begin, len).select(nu, 0.0);
+        }
+    }
+
+    // W = C * P (row r, column i holds (P * C')(i, r))
+    for (int r = 0; r < m_; ++r) {
+        for (int i = 0; i < n_; ++i) {
+            auto w = W_.col(r * n_ + i).head(len).array();
+            w.setZero();
+            for (int j = 0; j < n_; ++j) {
+                if (C_(r, j) != 0.0) {
+                    w += C_(r, j) * P_.col(packed_(i, j)).segment(begin, len).array();
+                }
+            }
+        }
+    }
+
+    // S = C * P * C' + R, lower triangle only
+    for (int s = 0; s < m_; ++s) {
+        for (int r = s; r < m_; ++r) {
+            auto S_rs = S_.col(r * m_ + s).head(len).array();
+            S_rs.setConstant(R_(r, s));
+            for (int i = 0; i < n_; ++i) {
+                if (C_(r, i) != 0.0) {
+                    S_rs += C_(r, i) * W_.col(s * n_ + i).head(len).array();
+                }
+            }
+        }
+    }
+
+    // S = L * L', overwriting the lower triangle of S with L
+    for (int j = 0; j < m_; ++j) {
+        auto L_jj = S_.col(j * m_ + j).head(len).array();
+        for (int k = 0; k < j; ++k) {
+            L_jj -= S_.col(j * m_ + k).head(len).array().square();
+        }
+        L_jj = L_jj.sqrt();
+        for (int i = j + 1; i < m_; ++i) {
+            auto L_ij = S_.col(i * m_ + j).head(len).array();
+            for (int k = 0; k < j; ++k) {
+                L_ij -= S_.col(i * m_ + k).head(len).array() * S_.col(j * m_ + k).head(len).array();
+            }
+            L_ij /= L_jj;
+        }
+    }
+
+    // Whiten: W = L^-1 * C * P and nu = L^-1 * nu by forward substitution
+    for (int r = 0; r < m_; ++r) {
+        auto nu_r = nu_.col(r).head(len).array();
+        for (int s = 0; s < r; ++s) {
+            auto L_rs = S_.col(r * m_ + s).head(len).array();
+            nu_r -= L_rs * nu_.col(s).head(len).array();
+            for (int i = 0; i < n_; ++i) {
+                W_.col(r * n_ + i).head(len).array() -= L_rs * W_.col(s * n_ + i).head(len).array();
+            }
+        }
+        auto L_rr = S_.col(r * m_ + r).head(len).array();
+        nu_r /= L_rr;
+        for (int i = 0; i < n_; ++i) {
+            W_.col(r * n_ + i).head(len).array() /= L_rr;
+        }
+        if (mask) {
+            for (int i = 0; i < n_; ++i) {
+                auto w = W_.col(r * n_ + i).head(len).array();
+                w = mask->segment(begin, len).select(w, 0.0);
+            }
+        }
+    }
+
+    // x = x + W' * nu and P = P - W' * W, lower triangle only
+    for (int i = 0; i < n_; ++i) {
+        auto xi = x_.col(i).segment(begin, len).array();
+        for (int r = 0; r < m_; ++r) {
+            xi += W_.col(r * n_ + i).head(len).array() * nu_.col(r).head(len).array();
+        }
+    }
+    for (int j = 0; j < n_; ++j) {
+        for (int i = j; i < n_; ++i) {
+            auto p = P_.col(packed_(i, j)).segment(begin, len).array();
+            for (int r = 0; r < m_; ++r) {
+                p -= W_.col(r * n_ + i).head(len).array() * W_.col(r * n_ + j).head(len).array();
+            }
+        }
+    }
+}
+
+void KalmanFilterBank::predictMeasurements(Eigen::MatrixXd& Z, Eigen::MatrixXd& S) const {
+    Z.resize(num_filters_, m_);
+    Z.noalias() = x_ * C_.transpose();
+
+    // S(r, s) = R(r, s) + sum over i, j of C(r, i) * C(s, j) * P(i, j)
+    S.resize(num_filters_, m_ * m_);
+    for (int s = 0; s < m_; ++s) {
+        for (int r = s; r < m_; ++r) {
+            auto S_rs = S.col(s * m_ + r).array();
+            S_rs.setConstant(R_(r, s));
+            for (int i = 0; i < n_; ++i) {
+                if (C_(r, i) == 0.0) {
+                    continue;
+                }
+                for (int j = 0; j < n_; ++j) {
+                    if (C_(s, j) != 0.0) {
+                        S_rs += C_(r, i) * C_(s, j) * P_.col(packed_(i, j)).array();
+                    }
+                }
+            }
+            if (r != s) {
+                S.col(r * m_ + s) = S.col(s * m_ + r);
+            }
+        }
+    }
+}
+
+int KalmanFilterBank::size() const {
+    return num_filters_;
+}
+
+Eigen::VectorXd KalmanFilterBank::state(int i) const {
+    return x_.row(i).transpose();
+}
+
+Eigen::MatrixXd KalmanFilterBank::covariance(int i) const {
+    Eigen::MatrixXd P(n_, n_);
+    for (int c = 0; c < n_; ++c) {
+        for (int r = 0; r < n_; ++r) {
+            P(r, c) = P_(i, packed_(r, c));
+        }
+    }
+    return P;
+}
+
+const Eigen::MatrixXd& KalmanFilterBank::states() const {
+    return x_;
+}
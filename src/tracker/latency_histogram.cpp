@@ -0,0 +1,44 @@
+#include <cmath>
+#include <latency_histogram.h>
+
+void LatencyHistogram::record(std::int64_t nanoseconds) {
+    int b = 0;
+    while (b < kBuckets - 1 && (nanoseconds >> (b + 1)) > 0) {
+        ++b;
+    }
+    buckets_[b].fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    std::uint64_t total = 0;
+    for (const auto& b : buckets_) {
+        total += b.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::uint64_t LatencyHistogram::bucket(int b) const {
+    return buckets_[b].load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::quantile(double q) const {
+    std::uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    std::uint64_t target = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(total)));
+    std::uint64_t seen = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+        seen += bucket(b);
+        if (seen >= target && seen > 0) {
+            return b >= 62 ? INT64_MAX : (std::int64_t(1) << (b + 1));
+        }
+    }
+    return INT64_MAX;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) {
+        b.store(0, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,118 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <mapped_matrix.h>
+
+MappedMatrix::MappedMatrix(const std::string& path, Eigen::Index rows) {
+    if (rows <= 0) {
+        throw std::invalid_argument("Mapped matrix needs at least one row.");
+    }
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ".");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat " + path + ".");
+    }
+    std::size_t column_bytes = static_cast<std::size_t>(rows) * sizeof(double);
+    if (static_cast<std::size_t>(info.st_size) % column_bytes != 0) {
+        ::close(fd);
+        throw std::runtime_error("Size of " + path + " is not a whole number of columns.");
+    }
+    rows_ = rows;
+    cols_ = static_cast<Eigen::Index>(static_cast<std::size_t>(info.st_size) / column_bytes);
+    bytes_ = static_cast<std::size_t>(info.st_size);
+    map(fd, false);
+}
+
+MappedMatrix MappedMatrix::create(const std::string& path, Eigen::Index rows, Eigen::Index cols) {
+    // Bound the shape by the largest file size before multiplying
+    const std::uint64_t max_values = static_cast<std::uint64_t>(std::numeric_limits<off_t>::max()) / sizeof(double);
+    if (rows < 0 || cols < 0 ||
+        (cols != 0 && static_cast<std::uint64_t>(rows) > max_values / static_cast<std::uint64_t>(cols))) {
+        throw std::invalid_argument("Invalid mapped matrix size.");
+    }
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create " + path + ".");
+    }
+    MappedMatrix mapped;
+    mapped.rows_ = rows;
+    mapped.cols_ = cols;
+    mapped.bytes_ = static_cast<std::size_t>(rows * cols) * sizeof(double);
+    if (::ftruncate(fd, static_cast<off_t>(mapped.bytes_)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot resize " + path + ".");
+    }
+    mapped.map(fd, true);
+    return mapped;
+}
+
+MappedMatrix::MappedMatrix(MappedMatrix&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedMatrix& MappedMatrix::operator=(MappedMatrix&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        bytes_ = std::exchange(other.bytes_, 0);
+        rows_ = std::exchange(other.rows_, 0);
+        cols_ = std::exchange(other.cols_, 0);
+        writable_ = other.writable_;
+    }
+    return *this;
+}
+
+MappedMatrix::~MappedMatrix() {
+    unmap();
+}
+
+Eigen::Index MappedMatrix::rows() const {
+    return rows_;
+}
+
+Eigen::Index MappedMatrix::cols() const {
+    return cols_;
+}
+
+Eigen::Map<const Eigen::MatrixXd> MappedMatrix::matrix() const {
+    return Eigen::Map<const Eigen::MatrixXd>(data_, rows_, cols_);
+}
+
+Eigen::Map<Eigen::MatrixXd> MappedMatrix::mutableMatrix() {
+    if (!writable_) {
+        throw std::logic_error("Matrix is mapped read-only.");
+    }
+    return Eigen::Map<Eigen::MatrixXd>(data_, rows_, cols_);
+}
+
+void MappedMatrix::map(int fd, bool writable) {
+    writable_ = writable;
+    if (bytes_ > 0) {
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* address = ::mmap(nullptr, bytes_, protection, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Cannot map file.");
+        }
+        ::madvise(address, bytes_, MADV_SEQUENTIAL);
+        data_ = static_cast<double*>(address);
+    }
+    // The mapping keeps the file referenced
+    ::close(fd);
+}
+
+void MappedMatrix::unmap() {
+    if (data_) {
+        ::munmap(data_, bytes_);
+        data_ = nullptr;
+    }
+}
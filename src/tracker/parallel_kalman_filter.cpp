@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <stdexcept>
+#include <parallel_kalman_filter.h>
+
+ParallelKalmanFilter::ParallelKalmanFilter(const KalmanFilter& model, ThreadPool& pool)
+    : model_(model.timeStep(), model.transitionMatrix(), model.observationMatrix(),
+             model.processNoise(), model.measurementNoise(), model.covariance()),
+      pool_(pool), n_(static_cast<int>(model.transitionMatrix().rows())), requested_chunks_(pool.size())
+{
+    model_.setUpdateStrategy(model.updateStrategy());
+
+    // The filtering elements of all steps after the first share everything
+    // but the measurement terms b = K y and eta = Eta y
+    const Eigen::MatrixXd& A = model_.transitionMatrix();
+    const Eigen::MatrixXd& C = model_.observationMatrix();
+    const Eigen::MatrixXd& Q = model_.processNoise();
+    Eigen::MatrixXd S = C * Q * C.transpose() + model_.measurementNoise();
+    Eigen::LLT<Eigen::MatrixXd> llt(S);
+    if (llt.info() != Eigen::Success) {
+        throw std::runtime_error("Innovation covariance is not positive definite.");
+    }
+    K_ = llt.solve(C * Q).transpose();
+    Eta_ = llt.solve(C * A).transpose();
+    Eigen::MatrixXd IKC = Eigen::MatrixXd::Identity(n_, n_) - K_ * C;
+    A_element_ = IKC * A;
+    C_element_ = IKC * Q;
+    J_element_ = Eta_ * C * A;
+}
+
+void ParallelKalmanFilter::setChunkCount(int chunks) {
+    requested_chunks_ = std::max(1, chunks);
+}
+
+int ParallelKalmanFilter::chunkBegin(int c) const {
+    return static_cast<int>(static_cast<long>(steps_) * c / chunks_);
+}
+
+void ParallelKalmanFilter::filter(const Eigen::VectorXd& x0,
+                                  const Eigen::MatrixXd& P0,
+                                  const Eigen::Ref<const Eigen::MatrixXd>& Y) {
+    if (Y.rows() != model_.observationMatrix().rows()) {
+        throw std::invalid_argument("Measurement rows must match the observation matrix.");
+    }
+    steps_ = static_cast<int>(Y.cols());
+    chunks_ = std::max(1, std::min(requested_chunks_, steps_));
+    x_predicted_.resize(n_, steps_);
+    P_predicted_.resize(n_, n_ * steps_);
+    x_.resize(n_, steps_);
+    P_.resize(n_, n_ * steps_);
+    boundary_x_.resize(chunks_);
+    boundary_P_.resize(chunks_);
+    workspaces_.resize(chunks_);
+    if (steps_ == 0) {
+        return;
+    }
+
+    // Phase 1: the first chunk is filtered directly, the others aggregated
+    pool_.parallelFor(0, chunks_, [&](int c) {
+        if (c == 0) {
+            filterChunk(0, x0, P0, Y);
+        } else {
+            aggregateFilterChunk(c, Y);
+        }
+    });
+
+    // Phase 2: filtered moments entering every chunk
+    for (int c = 1; c < chunks_; ++c) {
+        if (c == 1) {
+            boundary_x_[1] = x_.col(chunkBegin(1) - 1);
+            boundary_P_[1] = P_.middleCols((chunkBegin(1) - 1) * n_, n_);
+            continue;
+        }
+        const FilterElement& e = workspaces_[c - 1].filter;
+        Eigen::VectorXd& x = boundary_x_[c];
+        Eigen::MatrixXd& P = boundary_P_[c];
+        const Eigen::VectorXd& x_prev = boundary_x_[c - 1];
+        const Eigen::MatrixXd& P_prev = boundary_P_[c - 1];
+        Eigen::MatrixXd T1 = e.A * (Eigen::MatrixXd::Identity(n_, n_) + P_prev * e.J).inverse();
+        x = T1 * (x_prev + P_prev * e.eta) + e.b;
+        P = T1 * P_prev * e.A.transpose() + e.C;
+        P = 0.5 * (P + P.transpose()).eval();
+    }
+
+    // Phase 3: sequential filtering of every other chunk from its boundary
+    pool_.parallelFor(1, chunks_, [&](int c) {
+        filterChunk(c, boundary_x_[c], boundary_P_[c], Y);
+    });
+}
+
+void ParallelKalmanFilter::filterChunk(int c,
+                                       const Eigen::VectorXd& x,
+                                       const Eigen::MatrixXd& P,
+                                       const Eigen::Ref<const Eigen::MatrixXd>& Y) {
+    KalmanFilter kf = model_;
+    kf.init(x, P);
+    Eigen::VectorXd& y = workspaces_[c].y;
+    for (int k = chunkBegin(c); k < chunkBegin(c + 1); ++k) {
+        kf.predict();
+        x_predicted_.col(k) = kf.state();
+        P_predicted_.middleCols(k * n_, n_) = kf.covariance();
+        y = Y.col(k);
+        kf.update(y);
+        x_.col(k) = kf.state();
+        P_.middleCols(k * n_, n_) = kf.covariance();
+    }
+}
+
+void ParallelKalmanFilter::aggregateFilterChunk(int c, const Eigen::Ref<const Eigen::MatrixXd>& Y) {
+    Workspace& ws = workspaces_[c];
+    FilterElement& acc = ws.filter;
+    int begin = chunkBegin(c);
+    acc.A = A_element_;
+    acc.b.noalias() = K_ * Y.col(begin);
+    acc.C = C_element_;
+    acc.eta.noalias() = Eta_ * Y.col(begin);
+    acc.J = J_element_;
+
+    const Eigen::MatrixXd& Ae = A_element_;
+    const Eigen::MatrixXd& Je = J_element_;
+    for (int k = begin + 1; k < chunkBegin(c + 1); ++k) {
+        // acc = acc (x) element k, with M = I + C_acc J_e
+        ws.M.setIdentity(n_, n_);
+        ws.M.noalias() += acc.C * Je;
+        ws.lu.compute(ws.M);
+        ws.M = ws.lu.inverse();
+        ws.T1.noalias() = Ae * ws.M;
+        ws.T2.noalias() = acc.A.transpose() * ws.M.transpose();
+
+        // b = A_e M^-1 (b_acc + C_acc eta_e) + b_e
+        ws.y.noalias() = Eta_ * Y.col(k);
+        ws.v = acc.b;
+        ws.v.noalias() += acc.C * ws.y;
+
+        // eta = A_acc' M^-T (eta_e - J_e b_acc) + eta_acc
+        ws.y.noalias() -= Je * acc.b;
+        acc.eta.noalias() += ws.T2 * ws.y;
+
+        acc.b.noalias() = ws.T1 * ws.v;
+        acc.b.noalias() += K_ * Y.col(k);
+
+        // J = A_acc' M^-T J_e A_acc + J_acc
+        ws.tmp.noalias() = ws.T2 * Je;
+        acc.J.noalias() += ws.tmp * acc.A;
+
+        // C = A_e M^-1 C_acc A_e' + C_e
+        ws.tmp.noalias() = ws.T1 * acc.C;
+        acc.C = C_element_;
+        acc.C.noalias() += ws.tmp * Ae.transpose();
+
+        // A = A_e M^-1 A_acc
+        ws.tmp.noalias() = ws.T1 * acc.A;
+        acc.A.swap(ws.tmp);
+    }
+}
+
+void ParallelKalmanFilter::smooth() {
+    if (steps_ == 0) {
+        return;
+    }
+    const int last = chunks_ - 1;
+
+    // Phase 1: the last chunk is smoothed directly, the others aggregated
+    pool_.parallelFor(0, chunks_, [&](int c) {
+        if (c == last) {
+            smoothChunk(c);
+        } else {
+            aggregateSmoothChunk(c);
+        }
+    });
+
+    // Phase 2: smoothed moments at the start of every chunk
+    boundary_x_[last] = x_.col(chunkBegin(last));
+    boundary_P_[last] = P_.middleCols(chunkBegin(last) * n_, n_);
+    for (int c = last - 1; c >= 1; --c) {
+        const SmoothElement& e = workspaces_[c].smooth;
+        boundary_x_[c] = e.E * boundary_x_[c + 1] + e.g;
+        boundary_P_[c] = e.E * boundary_P_[c + 1] * e.E.transpose() + e.L;
+    }
+
+    // Phase 3: sequential backward pass of every other chunk
+    pool_.parallelFor(0, last, [&](int c) {
+        smoothChunk(c);
+    });
+}
+
+void ParallelKalmanFilter::aggregateSmoothChunk(int c) {
+    Workspace& ws = workspaces_[c];
+    SmoothElement& acc = ws.smooth;
+    const Eigen::MatrixXd& A = model_.transitionMatrix();
+    int begin = chunkBegin(c);
+    int end = chunkBegin(c + 1);
+
+    for (int k = end - 1; k >= begin; --k) {
+        // Element k: E = P_k A' P_{k+1|k}^-1, g = x_k - E x_{k+1|k}, L = P_k - E A P_k
+        auto P_k = P_.middleCols(k * n_, n_);
+        ws.llt.compute(P_predicted_.middleCols((k + 1) * n_, n_));
+        if (ws.llt.info() != Eigen::Success) {
+            throw std::runtime_error("Predicted covariance is not positive definite.");
+        }
+        ws.tmp.noalias() = A * P_k;
+        ws.T1 = ws.llt.solve(ws.tmp);   // E'
+        ws.T2 = ws.T1.transpose();       // E
+        ws.v = x_.col(k);
+        ws.v.noalias() -= ws.T2 * x_predicted_.col(k + 1);
+        ws.M = P_k;
+        ws.M.noalias() -= ws.T2 * ws.tmp;
+
+        if (k == end - 1) {
+            acc.E = ws.T2;
+            acc.g = ws.v;
+            acc.L = ws.M;
+            continue;
+        }
+        // acc = element k (x) acc
+        ws.tmp.noalias() = ws.T2 * acc.L;
+        acc.L = ws.M;
+        acc.L.noalias() += ws.tmp * ws.T2.transpose();
+        ws.y.noalias() = ws.T2 * acc.g;
+        acc.g = ws.y + ws.v;
+        ws.tmp.noalias() = ws.T2 * acc.E;
+        acc.E.swap(ws.tmp);
+    }
+}
+
+void ParallelKalmanFilter::smoothChunk(int c) {
+    Workspace& ws = workspaces_[c];
+    const Eigen::MatrixXd& A = model_.transitionMatrix();
+    int begin = chunkBegin(c);
+    int end = chunkBegin(c + 1);
+    bool last = c == chunks_ - 1;
+
+    // The last step of the sequence is already smoothed; other chunks
+    // start from the boundary moments of the next chunk
+    int first = last ? end - 2 : end - 1;
+    for (int k = first; k >= begin; --k) {
+        int next = k + 1;
+        if (next == end) {
+            ws.backward.apply(A, x_predicted_.col(next), P_predicted_.middleCols(next * n_, n_),
+                              boundary_x_[c + 1], boundary_P_[c + 1],
+                              x_.col(k), P_.middleCols(k * n_, n_));
+        } else {
+            ws.backward.apply(A, x_predicted_.col(next), P_predicted_.middleCols(next * n_, n_),
+                              x_.col(next), P_.middleCols(next * n_, n_),
+                              x_.col(k), P_.middleCols(k * n_, n_));
+        }
+    }
+}
+
+int ParallelKalmanFilter::size() const {
+    return steps_;
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> ParallelKalmanFilter::states() const {
+    return x_.leftCols(steps_);
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, 1, true> ParallelKalmanFilter::state(int k) const {
+    return x_.col(k);
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> ParallelKalmanFilter::covariance(int k) const {
+    return P_.middleCols(k * n_, n_);
+}
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <stdexcept>
+#include <extended_kalman_filter.h>
+#include <kalman_filter.h>
+#include <rts_smoother.h>
+
+void RtsBackwardStep::apply(const Eigen::Ref<const Eigen::MatrixXd>& F,
+                            const Eigen::Ref<const Eigen::VectorXd>& x_predicted,
+                            const Eigen::Ref<const Eigen::MatrixXd>& P_predicted,
+                            const Eigen::Ref<const Eigen::VectorXd>& x_next,
+                            const Eigen::Ref<const Eigen::MatrixXd>& P_next,
+                            Eigen::Ref<Eigen::VectorXd> x,
+                            Eigen::Ref<Eigen::MatrixXd> P) {
+    // G' = P_predicted^-1 * F * P
+    Gt_.noalias() = F * P;
+    llt_.compute(P_predicted);
+    if (llt_.info() != Eigen::Success) {
+        throw std::runtime_error("Predicted covariance is not positive definite.");
+    }
+    llt_.solveInPlace(Gt_);
+
+    // x = x + G * (x_next - x_predicted)
+    dx_ = x_next - x_predicted;
+    x.noalias() += Gt_.transpose() * dx_;
+
+    // P = P + G * (P_next - P_predicted) * G'
+    dP_ = P_next - P_predicted;
+    dPG_.noalias() = dP_ * Gt_;
+    P.noalias() += Gt_.transpose() * dPG_;
+}
+
+RtsSmoother::RtsSmoother(const Eigen::MatrixXd& A)
+    : fixed_transition_(true), A_(A) {}
+
+void RtsSmoother::reserve(int state_dim, int steps) {
+    n_ = state_dim;
+    int capacity = std::max(steps, static_cast<int>(x_.cols()));
+    x_predicted_.conservativeResize(n_, capacity);
+    P_predicted_.conservativeResize(n_, n_ * capacity);
+    x_.conservativeResize(n_, capacity);
+    P_.conservativeResize(n_, n_ * capacity);
+    if (!fixed_transition_) {
+        F_.conservativeResize(n_, n_ * capacity);
+    }
+}
+
+void RtsSmoother::clear() {
+    steps_ = 0;
+    predictions_ = 0;
+    smoothed_ = false;
+}
+
+void RtsSmoother::grow(int state_dim) {
+    if (smoothed_) {
+        throw std::logic_error("Sequence has already been smoothed, clear() first.");
+    }
+    if (steps_ == 0 && predictions_ == 0) {
+        n_ = state_dim;
+    } else if (state_dim != n_) {
+        throw std::invalid_argument("State dimension changed while recording.");
+    }
+    if (predictions_ >= x_.cols() || steps_ >= x_.cols()) {
+        reserve(n_, std::max(64, 2 * static_cast<int>(x_.cols())));
+    }
+}
+
+void RtsSmoother::addPrediction(const Eigen::MatrixXd& F, const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (fixed_transition_) {
+        throw std::logic_error("Smoother was constructed with a fixed transition matrix.");
+    }
+    grow(static_cast<int>(x.size()));
+    F_.middleCols(predictions_ * n_, n_) = F;
+    x_predicted_.col(predictions_) = x;
+    P_predicted_.middleCols(predictions_ * n_, n_) = P;
+    ++predictions_;
+}
+
+void RtsSmoother::addPrediction(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (!fixed_transition_) {
+        throw std::logic_error("Smoother has no fixed transition matrix.");
+    }
+    grow(static_cast<int>(x.size()));
+    x_predicted_.col(predictions_) = x;
+    P_predicted_.middleCols(predictions_ * n_, n_) = P;
+    ++predictions_;
+}
+
+void RtsSmoother::addUpdate(const Eigen::VectorXd& x, const Eigen::MatrixXd& P) {
+    if (steps_ + 1 != predictions_) {
+        throw std::logic_error("Every update must follow a prediction.");
+    }
+    grow(static_cast<int>(x.size()));
+    x_.col(steps_) = x;
+    P_.middleCols(steps_ * n_, n_) = P;
+    ++steps_;
+}
+
+void RtsSmoother::filter(KalmanFilter& kf, const Eigen::Ref<const Eigen::MatrixXd>& Y) {
+    reserve(static_cast<int>(kf.state().size()), steps_ + static_cast<int>(Y.cols()));
+    for (Eigen::Index k = 0; k < Y.cols(); ++k) {
+        kf.predict();
+        if (fixed_transition_) {
+            addPrediction(kf.state(), kf.covariance());
+        } else {
+            addPrediction(kf.transitionMatrix(), kf.state(), kf.covariance());
+        }
+        kf.update(Y.col(k));
+        addUpdate(kf.state(), kf.covariance());
+    }
+}
+
+void RtsSmoother::filter(ExtendedKalmanFilter& ekf, const Eigen::Ref<const Eigen::MatrixXd>& Y) {
+    reserve(static_cast<int>(ekf.state().size()), steps_ + static_cast<int>(Y.cols()));
+    for (Eigen::Index k = 0; k < Y.cols(); ++k) {
+        ekf.predict();
+        addPrediction(ekf.transitionJacobian(), ekf.state(), ekf.covariance());
+        ekf.update(Y.col(k));
+        addUpdate(ekf.state(), ekf.covariance());
+    }
+}
+
+void RtsSmoother::smooth() {
+    if (steps_ != predictions_) {
+        throw std::logic_error("Last prediction has no update.");
+    }
+    if (smoothed_) {
+        return;
+    }
+    smoothed_ = true;
+    for (int k = steps_ - 2; k >= 0; --k) {
+        int next = k + 1;
+        const auto F = fixed_transition_ ? A_.middleCols(0, n_) : F_.middleCols(next * n_, n_);
+        backward_.apply(F,
+                        x_predicted_.col(next), P_predicted_.middleCols(next * n_, n_),
+                        x_.col(next), P_.middleCols(next * n_, n_),
+                        x_.col(k), P_.middleCols(k * n_, n_));
+    }
+}
+
+int RtsSmoother::size() const {
+    return steps_;
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> RtsSmoother::states() const {
+    return x_.leftCols(steps_);
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, 1, true> RtsSmoother::state(int k) const {
+    return x_.col(k);
+}
+
+Eigen::Block<const Eigen::MatrixXd, Eigen::Dynamic, Eigen::Dynamic, true> RtsSmoother::covariance(int k) const {
+    return P_.middleCols(k * n_, n_);
+}
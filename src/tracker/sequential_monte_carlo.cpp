@@ -1,75 +1,179 @@
-#include <numeric>
 #include <algorithm>
 #include <cmath>
+#include <stdexcept>
 #include <sequential_monte_carlo.h>
 
-SequentialMonteCarlo::SequentialMonteCarlo(int num_particles)
-    : num_particles_(num_particles), particles_(num_particles) {
+SequentialMonteCarlo::SequentialMonteCarlo(int num_particles, int state_dim)
+    : num_particles_(num_particles), state_dim_(state_dim) {
+    if (num_particles < 1 || state_dim < 1) {
+        throw std::invalid_argument("Particle filter needs at least one particle and one state component.");
+    }
     // Initialize particles with default state and uniform weights
-    for (auto& p : particles_) {
-        p.state = Eigen::Vector3d::Zero();
-        p.weight = 1.0 / num_particles_;
+    particles_ = Eigen::MatrixXd::Zero(num_particles_, state_dim_);
+    weights_ = Eigen::VectorXd::Constant(num_particles_, 1.0 / num_particles_);
+    motion_noise_ = Eigen::VectorXd::Constant(state_dim_, 0.05);
+    motion_noise_.head(std::min(2, state_dim_)).setConstant(0.2);
+}
+
+void SequentialMonteCarlo::drawNormals(Eigen::Index count) {
+    // Marsaglia polar method: draw points in the unit disc one by one, then
+    // map all of them at once. Only log and sqrt are needed, both of which
+    // Eigen vectorizes for doubles, unlike the sin and cos of Box-Muller.
+    const Eigen::Index pairs = (count + 1) / 2;
+    disc_x_.resize(pairs);
+    disc_y_.resize(pairs);
+    radius_.resize(pairs);
+    normals_.resize(2 * pairs);
+    const double scale = 2.0 / (static_cast<double>(gen_.max() - gen_.min()) + 1.0);
+    Eigen::Index accepted = 0;
+    while (accepted < pairs) {
+        double u = (static_cast<double>(gen_() - gen_.min()) + 0.5) * scale - 1.0;
+        double v = (static_cast<double>(gen_() - gen_.min()) + 0.5) * scale - 1.0;
+        double s = u * u + v * v;
+        if (s < 1.0) {
+            disc_x_(accepted) = u;
+            disc_y_(accepted) = v;
+            radius_(accepted) = s;
+            ++accepted;
+        }
     }
+    radius_ = (-2.0 * radius_.log() / radius_).sqrt();
+    normals_.head(pairs) = disc_x_ * radius_;
+    normals_.tail(pairs) = disc_y_ * radius_;
 }
+
 void SequentialMonteCarlo::predict() {
-    // Simple motion model: add Gaussian noise to each particle's state
-    std::normal_distribution<double> noise_x(0.0, 0.2);
-    std::normal_distribution<double> noise_y(0.0, 0.2);
-    std::normal_distribution<double> noise_theta(0.0, 0.05);
-
-    for (auto& p : particles_) {
-        p.state(0) += noise_x(gen_);
-        p.state(1) += noise_y(gen_);
-        p.state(2) += noise_theta(gen_);
+    if (motion_) {
+        motion_(particles_);
+    }
+    // Gaussian noise, one contiguous column per state component
+    for (int j = 0; j < state_dim_; ++j) {
+        if (motion_noise_(j) == 0.0) {
+            continue;
+        }
+        drawNormals(num_particles_);
+        particles_.col(j).array() += motion_noise_(j) * normals_.head(num_particles_);
     }
 }
 
 void SequentialMonteCarlo::update(const Eigen::VectorXd& z) {
-    // Example measurement update: assume z = [x_meas, y_meas]
-    // Simple likelihood: Gaussian on position
-    const double sigma = 1.0;
-    const double gauss_norm = 1.0 / (2.0 * M_PI * sigma * sigma);
-
-    for (auto& p : particles_) {
-        double dx = p.state(0) - z(0);
-        double dy = p.state(1) - z(1);
-        double likelihood = gauss_norm * std::exp(-(dx*dx + dy*dy) / (2 * sigma * sigma));
-        p.weight *= likelihood;
+    log_likelihood_.resize(num_particles_);
+    if (log_likelihood_model_) {
+        log_likelihood_model_(particles_, z, log_likelihood_);
+        if (log_likelihood_.size() != num_particles_) {
+            throw std::invalid_argument("Log-likelihood kernel must write one entry per particle.");
+        }
+    } else {
+        // Gaussian on the first z.size() components
+        if (z.size() > state_dim_) {
+            throw std::invalid_argument("Measurement has more components than the particle state.");
+        }
+        log_likelihood_.setZero();
+        for (Eigen::Index k = 0; k < z.size(); ++k) {
+            log_likelihood_.array() -= (particles_.col(k).array() - z(k)).square();
+        }
+        log_likelihood_ *= 1.0 / (2.0 * measurement_sigma_ * measurement_sigma_);
     }
 
-    // Normalize weights
-    double weight_sum = std::accumulate(particles_.begin(), particles_.end(), 0.0,
-        [](double sum, const Particle& p) { return sum + p.weight; });
+    // Reweight relative to the most likely particle so the exponentials
+    // cannot all underflow
+    double max_log_likelihood = log_likelihood_.maxCoeff();
+    weights_.array() *= (log_likelihood_.array() - max_log_likelihood).exp();
 
+    // Normalize weights
+    double weight_sum = weights_.sum();
     if (weight_sum > 0) {
-        for (auto& p : particles_) {
-            p.weight /= weight_sum;
-        }
+        weights_ /= weight_sum;
     } else {
         // Reinitialize weights if degenerate
-        for (auto& p : particles_) {
-            p.weight = 1.0 / num_particles_;
-        }
+        weights_.setConstant(1.0 / num_particles_);
     }
 
-    // Resample particles (systematic resampling)
-    std::vector<Particle> new_particles(num_particles_);
+    resample();
+}
+
+void SequentialMonteCarlo::resample() {
+    // Systematic resampling: pick the slots first, then gather per column
+    indices_.resize(num_particles_);
     std::uniform_real_distribution<double> dist(0.0, 1.0 / num_particles_);
     double r = dist(gen_);
-    double c = particles_[0].weight;
+    double c = weights_(0);
     int i = 0;
     for (int m = 0; m < num_particles_; ++m) {
         double U = r + m * (1.0 / num_particles_);
         while (U > c && i < num_particles_ - 1) {
             ++i;
-            c += particles_[i].weight;
+            c += weights_(i);
         }
-        new_particles[m] = particles_[i];
-        new_particles[m].weight = 1.0 / num_particles_;
+        indices_[m] = i;
     }
-    particles_ = std::move(new_particles);
+    resampled_.resize(num_particles_, state_dim_);
+    for (int j = 0; j < state_dim_; ++j) {
+        const double* source = particles_.col(j).data();
+        double* target = resampled_.col(j).data();
+        for (int m = 0; m < num_particles_; ++m) {
+            target[m] = source[indices_[m]];
+        }
+    }
+    particles_.swap(resampled_);
+    weights_.setConstant(1.0 / num_particles_);
+}
+
+void SequentialMonteCarlo::setMotionModel(const MotionModel& motion) {
+    motion_ = motion;
 }
 
-const std::vector<Particle>& SequentialMonteCarlo::getParticles() const {
+void SequentialMonteCarlo::setMotionNoise(const Eigen::VectorXd& sigma) {
+    if (sigma.size() != state_dim_) {
+        throw std::invalid_argument("Motion noise must have one entry per state component.");
+    }
+    motion_noise_ = sigma;
+}
+
+void SequentialMonteCarlo::setLogLikelihood(const LogLikelihood& log_likelihood) {
+    log_likelihood_model_ = log_likelihood;
+}
+
+void SequentialMonteCarlo::setMeasurementNoise(double sigma) {
+    if (!(sigma > 0.0)) {
+        throw std::invalid_argument("Measurement noise must be positive.");
+    }
+    measurement_sigma_ = sigma;
+}
+
+const Eigen::MatrixXd& SequentialMonteCarlo::particles() const {
     return particles_;
-}
\ No newline at end of file
+}
+
+const Eigen::VectorXd& SequentialMonteCarlo::weights() const {
+    return weights_;
+}
+
+void SequentialMonteCarlo::setParticles(const Eigen::MatrixXd& particles, const Eigen::VectorXd& weights) {
+    if (particles.cols() != state_dim_ || weights.size() != particles.rows() || particles.rows() < 1) {
+        throw std::invalid_argument("Particles do not match the filter's state dimension or weights.");
+    }
+    particles_ = particles;
+    weights_ = weights;
+    num_particles_ = static_cast<int>(particles_.rows());
+}
+
+Eigen::VectorXd SequentialMonteCarlo::mean() const {
+    return particles_.transpose() * weights_;
+}
+
+int SequentialMonteCarlo::particleCount() const {
+    return num_particles_;
+}
+
+int SequentialMonteCarlo::stateDimension() const {
+    return state_dim_;
+}
+
+const std::default_random_engine& SequentialMonteCarlo::generator() const {
+    return gen_;
+}
+
+void SequentialMonteCarlo::setGenerator(const std::default_random_engine& gen) {
+    gen_ = gen;
+}
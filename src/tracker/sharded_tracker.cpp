@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <sharded_tracker.h>
+
+namespace {
+std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+ShardedTracker::ShardedTracker(int shards, FilterFactory factory, std::size_t queue_capacity, int batch_size)
+    : factory_(std::move(factory)), batch_size_(batch_size)
+{
+    if (shards < 1 || batch_size < 1) {
+        throw std::invalid_argument("Need at least one shard and a positive batch size.");
+    }
+    for (int s = 0; s < shards; ++s) {
+        shards_.emplace_back(new Shard(queue_capacity));
+        shards_.back()->batch.resize(batch_size);
+        shards_.back()->order.reserve(batch_size);
+    }
+    for (auto& shard : shards_) {
+        Shard* s = shard.get();
+        s->worker = std::thread([this, s] { run(*s); });
+    }
+}
+
+ShardedTracker::~ShardedTracker() {
+    stop_.store(true);
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+        }
+        shard->wake.notify_one();
+        shard->worker.join();
+    }
+}
+
+void ShardedTracker::setUpdateCallback(UpdateCallback callback) {
+    callback_ = std::move(callback);
+}
+
+bool ShardedTracker::trySubmit(long track_id, const Eigen::VectorXd& y) {
+    // Per-thread staging; after a push it holds a recycled buffer
+    static thread_local Measurement staged;
+    Shard& shard = *shards_[shardOf(track_id)];
+    staged.track = track_id;
+    staged.y = y;
+    staged.submitted = now();
+    if (!shard.queue.push(staged)) {
+        return false;
+    }
+    shard.submitted.fetch_add(1);
+
+    // Pairs with the fence in run() so a sleeping worker is always woken
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.sleeping.load()) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.wake.notify_one();
+    }
+    return true;
+}
+
+void ShardedTracker::submit(long track_id, const Eigen::VectorXd& y) {
+    while (!trySubmit(track_id, y)) {
+        std::this_thread::yield();
+    }
+}
+
+void ShardedTracker::flush() {
+    for (auto& shard : shards_) {
+        std::uint64_t target = shard->submitted.load();
+        std::unique_lock<std::mutex> lock(shard->mutex);
+        shard->drained.wait(lock, [&] { return shard->processed.load() >= target; });
+    }
+}
+
+int ShardedTracker::shardCount() const {
+    return static_cast<int>(shards_.size());
+}
+
+int ShardedTracker::shardOf(long track_id) const {
+    // Mix the id so that strided ids still spread over the shards
+    std::uint64_t h = static_cast<std::uint64_t>(track_id) * 0x9E3779B97F4A7C15ull;
+    return static_cast<int>((h >> 32) % shards_.size());
+}
+
+const LatencyHistogram& ShardedTracker::latency(int shard) const {
+    return shards_[shard]->latency;
+}
+
+std::uint64_t ShardedTracker::errors() const {
+    std::uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->errors.load();
+    }
+    return total;
+}
+
+std::size_t ShardedTracker::trackCount() const {
+    std::size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->filters.size();
+    }
+    return total;
+}
+
+bool ShardedTracker::estimate(long track_id, Eigen::VectorXd& x, Eigen::MatrixXd& P) const {
+    const Shard& shard = *shards_[shardOf(track_id)];
+    auto it = shard.filters.find(track_id);
+    if (it == shard.filters.end()) {
+        return false;
+    }
+    x = it->second->state();
+    P = it->second->covariance();
+    return true;
+}
+
+void ShardedTracker::run(Shard& shard) {
+    for (;;) {
+        int count = 0;
+        while (count < batch_size_ && shard.queue.pop(shard.batch[count])) {
+            ++count;
+        }
+        if (count > 0) {
+            process(shard, count);
+            continue;
+        }
+        if (stop_.load()) {
+            return;
+        }
+
+        // Announce sleep, then re-check the queue before waiting
+        shard.sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.wake.wait_for(lock, std::chrono::milliseconds(1),
+                                [&] { return stop_.load() || !shard.queue.empty(); });
+        }
+        shard.sleeping.store(false);
+    }
+}
+
+void ShardedTracker::process(Shard& shard, int count) {
+    // Group by track; the stable sort keeps each track's submission order
+    shard.order.resize(count);
+    for (int i = 0; i < count; ++i) {
+        shard.order[i] = i;
+    }
+    std::stable_sort(shard.order.begin(), shard.order.end(),
+                     [&](int a, int b) { return shard.batch[a].track < shard.batch[b].track; });
+
+    BaseKalmanFilter* filter = nullptr;
+    long current = 0;
+    for (int i = 0; i < count; ++i) {
+        const Measurement& m = shard.batch[shard.order[i]];
+        try {
+            if (!filter || m.track != current) {
+                current = m.track;
+                std::unique_ptr<BaseKalmanFilter>& slot = shard.filters[current];
+                if (!slot) {
+                    slot = factory_(current, m.y);
+                    if (!slot) {
+                        throw std::runtime_error("Filter factory returned no filter.");
+                    }
+                }
+                filter = slot.get();
+            }
+            filter->predict();
+            filter->update(m.y);
+            if (callback_) {
+                callback_(current, *filter);
+            }
+        } catch (const std::exception&) {
+            shard.errors.fetch_add(1);
+            filter = nullptr;
+        }
+        shard.latency.record(now() - m.submitted);
+    }
+
+    shard.processed.fetch_add(static_cast<std::uint64_t>(count));
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+    }
+    shard.drained.notify_all();
+}
@@ -0,0 +1,88 @@
+#include <stdexcept>
+#include <sparse_kalman_filter.h>
+
+SparseKalmanFilter::SparseKalmanFilter(const SparseMatrix& A,
+                                       const SparseMatrix& C,
+                                       const SparseMatrix& Q,
+                                       const SparseMatrix& R,
+                                       const SparseMatrix& P)
+    : x_(Eigen::VectorXd::Zero(A.rows())), P_(P), A_(A), C_(C), Q_(Q), R_(R)
+{
+    // The diagonal and the pattern of the initial covariance are always tracked
+    for (int i = 0; i < P.rows(); ++i) {
+        mask_entries_.emplace_back(i, i, 1.0);
+    }
+    for (int k = 0; k < P.outerSize(); ++k) {
+        for (SparseMatrix::InnerIterator it(P, k); it; ++it) {
+            mask_entries_.emplace_back(it.row(), it.col(), 1.0);
+        }
+    }
+}
+
+void SparseKalmanFilter::init(const Eigen::VectorXd& x0) {
+    x_ = x0;
+}
+
+void SparseKalmanFilter::trackCovarianceBlock(int row, int col, int rows, int cols) {
+    if (row < 0 || col < 0 || row + rows > P_.rows() || col + cols > P_.cols()) {
+        throw std::invalid_argument("Covariance block is out of range.");
+    }
+    for (int j = 0; j < cols; ++j) {
+        for (int i = 0; i < rows; ++i) {
+            mask_entries_.emplace_back(row + i, col + j, 1.0);
+            mask_entries_.emplace_back(col + j, row + i, 1.0);
+        }
+    }
+    mask_dirty_ = true;
+}
+
+void SparseKalmanFilter::predict() {
+    x_ = A_ * x_;
+    P_ = SparseMatrix(A_ * P_ * A_.transpose()) + Q_;
+    applyMask();
+}
+
+void SparseKalmanFilter::update(const Eigen::VectorXd& y) {
+    // Innovation covariance S = C P C' + R
+    SparseMatrix CP = C_ * P_;
+    SparseMatrix S = SparseMatrix(CP * C_.transpose()) + R_;
+    S_llt_.compute(S);
+    if (S_llt_.info() != Eigen::Success) {
+        throw std::runtime_error("Innovation covariance is not positive definite.");
+    }
+
+    // Transposed gain K' = S^-1 C P, sparse where C P is
+    SparseMatrix Kt = S_llt_.solve(CP);
+    Eigen::VectorXd innovation = y - C_ * x_;
+    x_ += Kt.transpose() * innovation;
+    P_ -= SparseMatrix(Kt.transpose() * CP);
+    applyMask();
+}
+
+void SparseKalmanFilter::applyMask() {
+    if (mask_dirty_) {
+        mask_.resize(P_.rows(), P_.cols());
+        mask_.setFromTriplets(mask_entries_.begin(), mask_entries_.end(),
+                              [](double, double) { return 1.0; });
+        mask_entries_.clear();
+        for (int k = 0; k < mask_.outerSize(); ++k) {
+            for (SparseMatrix::InnerIterator it(mask_, k); it; ++it) {
+                mask_entries_.emplace_back(it.row(), it.col(), 1.0);
+            }
+        }
+        mask_dirty_ = false;
+    }
+    P_ = P_.cwiseProduct(mask_);
+}
+
+const Eigen::VectorXd& SparseKalmanFilter::state() const {
+    return x_;
+}
+
+const SparseKalmanFilter::SparseMatrix& SparseKalmanFilter::covariance() const {
+    return P_;
+}
+
+Eigen::MatrixXd SparseKalmanFilter::covarianceBlock(int row, int col, int rows, int cols) const {
+    return Eigen::MatrixXd(P_.block(row, col, rows, cols));
+}
@@ -0,0 +1,258 @@
+#include <Eigen/Dense>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <kalman_corrector.h>
+#include <square_root_unscented_kalman_filter.h>
+
+namespace {
+
+/**
+ * @brief Rank-1 update (sigma = 1) or downdate (sigma = -1) of a lower
+ * Cholesky factor, L * L' + sigma * v * v'. v is used as scratch.
+ * Returns false if a downdate would leave the matrix indefinite.
+ */
+bool choleskyUpdate(Eigen::MatrixXd& L, Eigen::VectorXd& v, double sigma) {
+    const Eigen::Index n = L.rows();
+    for (Eigen::Index k = 0; k < n; ++k) {
+        double d = L(k, k);
+        double r2 = d * d + sigma * v(k) * v(k);
+        if (!(r2 > 0.0)) {
+            return false;
+        }
+        double r = std::sqrt(r2);
+        double c = r / d;
+        double s = v(k) / d;
+        L(k, k) = r;
+        const Eigen::Index tail = n - k - 1;
+        if (tail > 0) {
+            L.col(k).tail(tail) = (L.col(k).tail(tail) + sigma * s * v.tail(tail)) / c;
+            v.tail(tail) = c * v.tail(tail) - s * L.col(k).tail(tail);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Lower Cholesky factor of M; throws std::invalid_argument if M is
+ * not positive definite.
+ */
+Eigen::MatrixXd lowerFactor(const Eigen::MatrixXd& M, const char* name) {
+    Eigen::LLT<Eigen::MatrixXd> llt(M);
+    if (llt.info() != Eigen::Success) {
+        throw std::invalid_argument(std::string(name) + " is not positive definite.");
+    }
+    return llt.matrixL();
+}
+
+/**
+ * @brief Lower factor L of A * A' from the QR decomposition of At = A'.
+ */
+void lowerFactorFromQR(Eigen::HouseholderQR<Eigen::MatrixXd>& qr, const Eigen::MatrixXd& At, Eigen::MatrixXd& L) {
+    qr.compute(At);
+    const Eigen::Index n = At.cols();
+    L = qr.matrixQR().topRows(n).triangularView<Eigen::Upper>().transpose();
+    // Householder R may carry negative diagonal entries
+    for (Eigen::Index k = 0; k < n; ++k) {
+        if (L(k, k) < 0.0) {
+            L.col(k) = -L.col(k);
+        }
+    }
+}
+
+} // namespace
+
+SquareRootUnscentedKalmanFilter::SquareRootUnscentedKalmanFilter(int state_dim, int meas_dim)
+    : n_x_(state_dim), n_z_(meas_dim)
+{
+    lambda_ = alpha_ * alpha_ * (n_x_ + kappa_) - n_x_;
+    weight_ = 1.0 / (2.0 * (n_x_ + lambda_));
+    // wc0 + 2 n w - 2, the coefficient of the central deviation
+    center_weight_ = lambda_ / (n_x_ + lambda_) + (1 - alpha_ * alpha_ + beta_) + 2 * n_x_ * weight_ - 2.0;
+    x_ = Vector::Zero(n_x_);
+    S_ = Matrix::Identity(n_x_, n_x_);
+
+    const int n_sigma = 2 * n_x_ + 1;
+    sigma_points_.resize(n_x_, n_sigma);
+    propagated_.resize(n_x_, n_sigma);
+    meas_sigma_.resize(n_z_, n_sigma);
+    compound_.resize(2 * n_x_ + n_x_, n_x_);
+    compound_meas_.resize(2 * n_x_ + n_z_, n_z_);
+    qr_ = Eigen::HouseholderQR<Matrix>(compound_.rows(), compound_.cols());
+    qr_meas_ = Eigen::HouseholderQR<Matrix>(compound_meas_.rows(), compound_meas_.cols());
+    compound_update_.resize(2 * n_x_ + n_z_, n_x_);
+    qr_update_ = Eigen::HouseholderQR<Matrix>(compound_update_.rows(), compound_update_.cols());
+    point_.resize(n_x_);
+    fx_.resize(n_x_);
+    hx_.resize(n_z_);
+    center_.resize(n_x_);
+    center_meas_.resize(n_z_);
+    z_pred_.resize(n_z_);
+    innovation_ = Vector::Zero(n_z_);
+    column_.resize(n_x_);
+    column_meas_.resize(n_z_);
+    Sz_ = Matrix::Identity(n_z_, n_z_);
+    Pxz_.resize(n_x_, n_z_);
+    Kt_.resize(n_z_, n_x_);
+}
+
+void SquareRootUnscentedKalmanFilter::initialize(const Vector& x0, const Matrix& P0)
+{
+    x_ = x0;
+    S_ = lowerFactor(P0, "Initial covariance");
+}
+
+void SquareRootUnscentedKalmanFilter::setProcessModel(const std::function<Vector(const Vector&)>& f, const Matrix& Q)
+{
+    f_ = f;
+    f_in_place_ = nullptr;
+    sqrt_Q_ = lowerFactor(Q, "Process noise");
+}
+
+void SquareRootUnscentedKalmanFilter::setMeasurementModel(const std::function<Vector(const Vector&)>& h, const Matrix& R)
+{
+    h_ = h;
+    h_in_place_ = nullptr;
+    sqrt_R_ = lowerFactor(R, "Measurement noise");
+}
+
+void SquareRootUnscentedKalmanFilter::setInPlaceProcessModel(const InPlaceModel& f, const Matrix& Q)
+{
+    f_in_place_ = f;
+    f_ = nullptr;
+    sqrt_Q_ = lowerFactor(Q, "Process noise");
+}
+
+void SquareRootUnscentedKalmanFilter::setInPlaceMeasurementModel(const InPlaceModel& h, const Matrix& R)
+{
+    h_in_place_ = h;
+    h_ = nullptr;
+    sqrt_R_ = lowerFactor(R, "Measurement noise");
+}
+
+void SquareRootUnscentedKalmanFilter::generateSigmaPoints()
+{
+    // Columns: x, x + s * S, x - s * S
+    double scaling = std::sqrt(n_x_ + lambda_);
+    auto plus = sigma_points_.middleCols(1, n_x_);
+    auto minus = sigma_points_.middleCols(1 + n_x_, n_x_);
+    plus = scaling * S_;
+    minus = -plus;
+    sigma_points_.rightCols(2 * n_x_).colwise() += x_;
+    sigma_points_.col(0) = x_;
+}
+
+void SquareRootUnscentedKalmanFilter::transformSigmaPoints(const std::function<Vector(const Vector&)>& model,
+                                                           const InPlaceModel& in_place_model,
+                                                           Vector& output,
+                                                           Matrix& transformed)
+{
+    for (Eigen::Index i = 0; i < sigma_points_.cols(); ++i) {
+        point_ = sigma_points_.col(i);
+        if (in_place_model) {
+            in_place_model(point_, output);
+            transformed.col(i) = output;
+        } else {
+            transformed.col(i) = model(point_);
+        }
+    }
+}
+
+void SquareRootUnscentedKalmanFilter::predict()
+{
+    if (!f_ && !f_in_place_) return; // Optionally throw or assert
+    generateSigmaPoints();
+    transformSigmaPoints(f_, f_in_place_, fx_, propagated_);
+
+    // Deviations from the propagated central point; the mean is the
+    // central point plus their weighted sum
+    auto deviations = propagated_.rightCols(2 * n_x_);
+    deviations.colwise() -= propagated_.col(0);
+    center_.noalias() = weight_ * deviations.rowwise().sum();
+    x_ = propagated_.col(0) + center_;
+
+    // P = w * D * D' + Q + c * e * e'
+    compound_.topRows(2 * n_x_) = std::sqrt(weight_) * deviations.transpose();
+    compound_.bottomRows(n_x_) = sqrt_Q_.transpose();
+    lowerFactorFromQR(qr_, compound_, S_);
+    column_ = std::sqrt(std::abs(center_weight_)) * center_;
+    if (!choleskyUpdate(S_, column_, center_weight_ < 0.0 ? -1.0 : 1.0)) {
+        throw std::runtime_error("Predicted covariance is not positive definite.");
+    }
+}
+
+void SquareRootUnscentedKalmanFilter::update(const Eigen::VectorXd& z)
+{
+    if (!h_ && !h_in_place_) return; // Optionally throw or assert
+
+    // Sigma points of the predicted estimate through the measurement model
+    generateSigmaPoints();
+    transformSigmaPoints(h_, h_in_place_, hx_, meas_sigma_);
+
+    auto meas_deviations = meas_sigma_.rightCols(2 * n_x_);
+    meas_deviations.colwise() -= meas_sigma_.col(0);
+    center_meas_.noalias() = weight_ * meas_deviations.rowwise().sum();
+    z_pred_ = meas_sigma_.col(0) + center_meas_;
+
+    auto deviations = sigma_points_.rightCols(2 * n_x_);
+    deviations.colwise() -= x_;
+    center_.noalias() = weight_ * deviations.rowwise().sum();
+
+    // Innovation covariance factor and cross covariance
+    compound_meas_.topRows(2 * n_x_) = std::sqrt(weight_) * meas_deviations.transpose();
+    compound_meas_.bottomRows(n_z_) = sqrt_R_.transpose();
+    lowerFactorFromQR(qr_meas_, compound_meas_, Sz_);
+    column_meas_ = std::sqrt(std::abs(center_weight_)) * center_meas_;
+    if (!choleskyUpdate(Sz_, column_meas_, center_weight_ < 0.0 ? -1.0 : 1.0)) {
+        throw std::runtime_error("Innovation covariance is not positive definite.");
+    }
+    Pxz_.noalias() = weight_ * deviations * meas_deviations.transpose();
+    Pxz_.noalias() += center_weight_ * center_ * center_meas_.transpose();
+
+    // Transposed gain from Sz * Sz' * K' = Pxz'
+    Kt_ = Pxz_.transpose();
+    Sz_.triangularView<Eigen::Lower>().solveInPlace(Kt_);
+    Sz_.transpose().triangularView<Eigen::Upper>().solveInPlace(Kt_);
+
+    innovation_ = z - z_pred_;
+    x_.noalias() += Kt_.transpose() * innovation_;
+
+    // P - K * Pzz * K' equals the weighted spread of the residual deviations
+    // dX - K * dZ plus K * R * K', a sum of squares that QR factors without
+    // the downdates that lose definiteness when P shrinks by many orders
+    deviations.noalias() -= Kt_.transpose() * meas_deviations;
+    center_.noalias() -= Kt_.transpose() * center_meas_;
+    compound_update_.topRows(2 * n_x_) = std::sqrt(weight_) * deviations.transpose();
+    compound_update_.bottomRows(n_z_).noalias() = sqrt_R_.transpose() * Kt_;
+    lowerFactorFromQR(qr_update_, compound_update_, S_);
+    column_ = std::sqrt(std::abs(center_weight_)) * center_;
+    if (!choleskyUpdate(S_, column_, center_weight_ < 0.0 ? -1.0 : 1.0)) {
+        throw std::runtime_error("Updated covariance is not positive definite.");
+    }
+}
+
+const SquareRootUnscentedKalmanFilter::Vector& SquareRootUnscentedKalmanFilter::state() const
+{
+    return x_;
+}
+
+const SquareRootUnscentedKalmanFilter::Matrix& SquareRootUnscentedKalmanFilter::covariance() const
+{
+    P_.noalias() = S_ * S_.transpose();
+    return P_;
+}
+
+const SquareRootUnscentedKalmanFilter::Matrix& SquareRootUnscentedKalmanFilter::squareRootCovariance() const
+{
+    return S_;
+}
+
+void SquareRootUnscentedKalmanFilter::setState(const Vector& x, const Matrix& P)
+{
+    initialize(x, P);
+}
+
+double SquareRootUnscentedKalmanFilter::logLikelihood() const
+{
+    return gaussianLogLikelihood(Sz_, innovation_, likelihood_work_);
+}
@@ -0,0 +1,97 @@
+#include <thread_pool.h>
+
+namespace {
+// Set on pool threads and on a caller while it runs loop bodies
+thread_local bool inside_pool = false;
+}
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    for (int i = 1; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(workers_.size()) + 1;
+}
+
+void ThreadPool::parallelFor(int begin, int end, const std::function<void(int)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    if (workers_.empty() || inside_pool || end - begin == 1) {
+        for (int i = begin; i < end; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> call(call_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        body_ = &body;
+        next_.store(begin);
+        end_ = end;
+        active_ = static_cast<int>(workers_.size());
+        error_ = nullptr;
+        ++generation_;
+    }
+    start_.notify_all();
+
+    inside_pool = true;
+    runTasks();
+    inside_pool = false;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return active_ == 0; });
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    inside_pool = true;
+    long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        runTasks();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--active_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks() {
+    for (int i = next_.fetch_add(1); i < end_; i = next_.fetch_add(1)) {
+        try {
+            (*body_)(i);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+    }
+}
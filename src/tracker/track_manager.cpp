@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <track_manager.h>
+
+TrackManager::TrackManager(const Eigen::MatrixXd& A,
+                           const Eigen::MatrixXd& C,
+                           const Eigen::MatrixXd& Q,
+                           const Eigen::MatrixXd& R,
+                           const Eigen::MatrixXd& P,
+                           const TrackManagerConfig& config)
+    : m_(static_cast<int>(C.rows())), config_(config), bank_(0, A, C, Q, R, P), P0_(P),
+      birth_(C.completeOrthogonalDecomposition().pseudoInverse())
+{
+    if (m_ < 2) {
+        throw std::invalid_argument("Track manager needs at least two measurement components for gating.");
+    }
+}
+
+void TrackManager::step(const Eigen::MatrixXd& detections) {
+    if (detections.rows() > 0 && detections.cols() != m_) {
+        throw std::invalid_argument("Detections must have one column per measurement component.");
+    }
+    bank_.predict();
+    bank_.predictMeasurements(Z_, S_);
+    buildGrid(detections);
+    gate(detections);
+    assign();
+    updateTracks(detections);
+    manageTracks(detections);
+}
+
+void TrackManager::buildGrid(const Eigen::MatrixXd& detections) {
+    int count = static_cast<int>(detections.rows());
+    cell_of_.resize(count);
+    if (count == 0) {
+        cells_x_ = cells_y_ = 0;
+        return;
+    }
+    origin_x_ = detections.col(0).minCoeff();
+    origin_y_ = detections.col(1).minCoeff();
+    double width = detections.col(0).maxCoeff() - origin_x_;
+    double height = detections.col(1).maxCoeff() - origin_y_;
+
+    // Coarsen the grid until it has at most a few cells per detection
+    cell_ = config_.cell_size;
+    for (;;) {
+        cells_x_ = static_cast<int>(width / cell_) + 1;
+        cells_y_ = static_cast<int>(height / cell_) + 1;
+        if (static_cast<double>(cells_x_) * cells_y_ <= 4.0 * count + 16.0) {
+            break;
+        }
+        cell_ *= 2.0;
+    }
+
+    // Counting sort of the detections by cell
+    cell_start_.assign(static_cast<std::size_t>(cells_x_) * cells_y_ + 1, 0);
+    for (int d = 0; d < count; ++d) {
+        int cx = std::min(cells_x_ - 1, static_cast<int>((detections(d, 0) - origin_x_) / cell_));
+        int cy = std::min(cells_y_ - 1, static_cast<int>((detections(d, 1) - origin_y_) / cell_));
+        cell_of_[d] = cy * cells_x_ + cx;
+        ++cell_start_[cell_of_[d] + 1];
+    }
+    for (std::size_t c = 1; c < cell_start_.size(); ++c) {
+        cell_start_[c] += cell_start_[c - 1];
+    }
+    cell_items_.resize(count);
+    cell_fill_.assign(cell_start_.begin(), cell_start_.end() - 1);
+    for (int d = 0; d < count; ++d) {
+        cell_items_[cell_fill_[cell_of_[d]]++] = d;
+    }
+}
+
+void TrackManager::gate(const Eigen::MatrixXd& detections) {
+    int num_tracks = static_cast<int>(tracks_.size());
+    edge_begin_.assign(num_tracks + 1, 0);
+    edge_detection_.clear();
+    edge_benefit_.clear();
+    Si_.resize(m_, m_);
+    residual_.resize(m_);
+
+    for (int t = 0; t < num_tracks; ++t) {
+        edge_begin_[t] = static_cast<int>(edge_detection_.size());
+        if (cells_x_ == 0) {
+            continue;
+        }
+        int slot = tracks_[t].slot;
+        for (int k = 0; k < m_ * m_; ++k) {
+            Si_(k) = S_(slot, k);
+        }
+        llt_.compute(Si_);
+        if (llt_.info() != Eigen::Success) {
+            continue;
+        }
+
+        // Cells overlapping the bounding box of the gate ellipse
+        double zx = Z_(slot, 0);
+        double zy = Z_(slot, 1);
+        double rx = std::sqrt(config_.gate * Si_(0, 0));
+        double ry = std::sqrt(config_.gate * Si_(1, 1));
+        double x_lo = std::floor((zx - rx - origin_x_) / cell_);
+        double x_hi = std::floor((zx + rx - origin_x_) / cell_);
+        double y_lo = std::floor((zy - ry - origin_y_) / cell_);
+        double y_hi = std::floor((zy + ry - origin_y_) / cell_);
+        if (x_hi < 0.0 || y_hi < 0.0 || x_lo >= cells_x_ || y_lo >= cells_y_) {
+            continue;
+        }
+        int cx_lo = std::max(0, static_cast<int>(x_lo));
+        int cx_hi = std::min(cells_x_ - 1, static_cast<int>(x_hi));
+        int cy_lo = std::max(0, static_cast<int>(y_lo));
+        int cy_hi = std::min(cells_y_ - 1, static_cast<int>(y_hi));
+
+        for (int cy = cy_lo; cy <= cy_hi; ++cy) {
+            int row = cy * cells_x_;
+            for (int i = cell_start_[row + cx_lo]; i < cell_start_[row + cx_hi + 1]; ++i) {
+                int d = cell_items_[i];
+                residual_ = detections.row(d).transpose() - Z_.row(slot).transpose();
+                llt_.matrixL().solveInPlace(residual_);
+                double distance = residual_.squaredNorm();
+                if (distance <= config_.gate) {
+                    edge_detection_.push_back(d);
+                    edge_benefit_.push_back(config_.gate - distance);
+                }
+            }
+        }
+    }
+    edge_begin_[num_tracks] = static_cast<int>(edge_detection_.size());
+}
+
+void TrackManager::assign() {
+    int num_tracks = static_cast<int>(tracks_.size());
+    int num_detections = static_cast<int>(cell_of_.size());
+    price_.assign(num_detections, 0.0);
+    owner_.assign(num_detections, -1);
+    assigned_.assign(num_tracks, -1);
+
+    // Gauss-Seidel auction. Each track may also take its private
+    // "unassigned" option of value 0, so every bid is bounded by the gate.
+    // Epsilon scaling is not used: prices inflated in a coarse phase would
+    // push tracks onto the unassigned option in the next one.
+    queue_.clear();
+    for (int t = num_tracks - 1; t >= 0; --t) {
+        if (edge_begin_[t] != edge_begin_[t + 1]) {
+            queue_.push_back(t);
+        }
+    }
+
+    while (!queue_.empty()) {
+        int t = queue_.back();
+        queue_.pop_back();
+        double best = 0.0;
+        double second = 0.0;
+        int best_detection = -1;
+        for (int e = edge_begin_[t]; e < edge_begin_[t + 1]; ++e) {
+            int d = edge_detection_[e];
+            double value = edge_benefit_[e] - price_[d];
+            if (value > best) {
+                second = best;
+                best = value;
+                best_detection = d;
+            } else if (value > second) {
+                second = value;
+            }
+        }
+        if (best_detection < 0) {
+            continue; // stays unassigned
+        }
+        price_[best_detection] += best - second + config_.auction_epsilon;
+        int previous = owner_[best_detection];
+        if (previous >= 0) {
+            assigned_[previous] = -1;
+            queue_.push_back(previous);
+        }
+        owner_[best_detection] = t;
+        assigned_[t] = best_detection;
+    }
+}
+
+void TrackManager::updateTracks(const Eigen::MatrixXd& detections) {
+    if (bank_.size() == 0) {
+        return;
+    }
+    Y_.resize(bank_.size(), m_);
+    mask_.setConstant(bank_.size(), false);
+    for (std::size_t t = 0; t < tracks_.size(); ++t) {
+        if (assigned_[t] >= 0) {
+            Y_.row(tracks_[t].slot) = detections.row(assigned_[t]);
+            mask_(tracks_[t].slot) = true;
+        }
+    }
+    bank_.update(Y_, mask_);
+}
+
+void TrackManager::manageTracks(const Eigen::MatrixXd& detections) {
+    int num_detections = static_cast<int>(detections.rows());
+    detection_tracks_.assign(num_detections, -1);
+
+    // Bookkeeping and deaths; the assignment is indexed by the old order
+    for (std::size_t t = 0; t < tracks_.size(); ++t) {
+        Track& track = tracks_[t];
+        if (assigned_[t] >= 0) {
+            ++track.hits;
+            track.misses = 0;
+            detection_tracks_[assigned_[t]] = track.id;
+        } else {
+            ++track.misses;
+        }
+    }
+    std::size_t live = 0;
+    for (std::size_t t = 0; t < tracks_.size(); ++t) {
+        const Track& track = tracks_[t];
+        bool dead = confirmed(track) ? track.misses > config_.max_misses : track.misses > 0;
+        if (dead) {
+            bank_.init(track.slot, Eigen::VectorXd::Zero(P0_.rows()));
+            free_slots_.push_back(track.slot);
+        } else {
+            tracks_[live++] = track;
+        }
+    }
+    tracks_.resize(live);
+
+    // Births from unassigned detections
+    for (int d = 0; d < num_detections; ++d) {
+        if (detection_tracks_[d] >= 0) {
+            continue;
+        }
+        if (free_slots_.empty()) {
+            int old_size = bank_.size();
+            int new_size = std::max(16, 2 * old_size);
+            bank_.resize(new_size);
+            for (int slot = new_size - 1; slot >= old_size; --slot) {
+                free_slots_.push_back(slot);
+            }
+        }
+        int slot = free_slots_.back();
+        free_slots_.pop_back();
+        bank_.setState(slot, birth_ * detections.row(d).transpose(), P0_);
+        tracks_.push_back(Track{next_id_, slot, 1, 0});
+        detection_tracks_[d] = next_id_++;
+    }
+}
+
+const std::vector<Track>& TrackManager::tracks() const {
+    return tracks_;
+}
+
+bool TrackManager::confirmed(const Track& track) const {
+    return track.hits >= config_.confirmation_hits;
+}
+
+Eigen::VectorXd TrackManager::state(const Track& track) const {
+    return bank_.state(track.slot);
+}
+
+Eigen::MatrixXd TrackManager::covariance(const Track& track) const {
+    return bank_.covariance(track.slot);
+}
+
+const std::vector<long>& TrackManager::detectionTracks() const {
+    return detection_tracks_;
+}
+
+int TrackManager::gatedPairs() const {
+    return static_cast<int>(edge_detection_.size());
+}
+
+const KalmanFilterBank& TrackManager::bank() const {
+    return bank_;
+}
@@ -1,18 +1,43 @@
 
 #include <Eigen/Dense>
-#include <vector>
+#include <chrono>
 #include <cmath>
+#include <stdexcept>
 #include <unscented_kalman_filter.h>
 
-UnscentedKalmanFilter::UnscentedKalmanFilter(int state_dim, int meas_dim)
-    : n_x_(state_dim), n_z_(meas_dim)
+namespace {
+// Weight of the newest serial pass in the smoothed per-point cost
+const double kCostSmoothing = 0.25;
+// Parallel passes between two serial ones that refresh the cost estimate
+const int kProbeInterval = 32;
+} // namespace
+
+UnscentedKalmanFilter::UnscentedKalmanFilter(int state_dim, int meas_dim, SigmaPointScheme scheme)
+    : n_x_(state_dim), n_z_(meas_dim), scheme_(scheme)
 {
     lambda_ = alpha_ * alpha_ * (n_x_ + kappa_) - n_x_;
     x_ = Vector::Zero(n_x_);
     P_ = Matrix::Identity(n_x_, n_x_);
-    weights_mean_ = Vector::Zero(2 * n_x_ + 1);
-    weights_cov_ = Vector::Zero(2 * n_x_ + 1);
+    // Sized before the models are set so restores can check them
+    Q_ = Matrix::Zero(n_x_, n_x_);
+    R_ = Matrix::Zero(n_z_, n_z_);
     computeWeights();
+
+    const Eigen::Index n_sigma = weights_mean_.size();
+    llt_ = Eigen::LLT<Matrix>(n_x_);
+    L_.resize(n_x_, n_x_);
+    sigma_points_.resize(n_x_, n_sigma);
+    point_.resize(n_x_);
+    fx_.resize(n_x_);
+    hx_.resize(n_z_);
+    propagated_.resize(n_x_, n_sigma);
+    meas_sigma_.resize(n_z_, n_sigma);
+    weighted_.resize(n_x_, n_sigma);
+    weighted_meas_.resize(n_z_, n_sigma);
+    z_pred_.resize(n_z_);
+    innovation_.resize(n_z_);
+    S_.resize(n_z_, n_z_);
+    Tc_.resize(n_x_, n_z_);
 }
 
 void UnscentedKalmanFilter::initialize(const Vector& x0, const Matrix& P0)
@@ -24,101 +49,279 @@ void UnscentedKalmanFilter::initialize(const Vector& x0, const Matrix& P0)
 void UnscentedKalmanFilter::setProcessModel(const std::function<Vector(const Vector&)>& f, const Matrix& Q)
 {
     f_ = f;
+    f_in_place_ = nullptr;
+    f_batch_ = nullptr;
     Q_ = Q;
 }
 
 void UnscentedKalmanFilter::setMeasurementModel(const std::function<Vector(const Vector&)>& h, const Matrix& R)
 {
     h_ = h;
+    h_in_place_ = nullptr;
+    h_batch_ = nullptr;
+    R_ = R;
+}
+
+void UnscentedKalmanFilter::setInPlaceProcessModel(const InPlaceModel& f, const Matrix& Q)
+{
+    f_in_place_ = f;
+    f_ = nullptr;
+    f_batch_ = nullptr;
+    Q_ = Q;
+}
+
+void UnscentedKalmanFilter::setInPlaceMeasurementModel(const InPlaceModel& h, const Matrix& R)
+{
+    h_in_place_ = h;
+    h_ = nullptr;
+    h_batch_ = nullptr;
+    R_ = R;
+}
+
+void UnscentedKalmanFilter::setBatchProcessModel(const BatchModel& f, const Matrix& Q)
+{
+    f_batch_ = f;
+    f_ = nullptr;
+    f_in_place_ = nullptr;
+    Q_ = Q;
+}
+
+void UnscentedKalmanFilter::setBatchMeasurementModel(const BatchModel& h, const Matrix& R)
+{
+    h_batch_ = h;
+    h_ = nullptr;
+    h_in_place_ = nullptr;
     R_ = R;
 }
 
+void UnscentedKalmanFilter::setNoiseCovariances(const Matrix& Q, const Matrix& R)
+{
+    Q_ = Q;
+    R_ = R;
+}
+
+const UnscentedKalmanFilter::Matrix& UnscentedKalmanFilter::processNoise() const
+{
+    return Q_;
+}
+
+const UnscentedKalmanFilter::Matrix& UnscentedKalmanFilter::measurementNoise() const
+{
+    return R_;
+}
+
+SigmaPointScheme UnscentedKalmanFilter::sigmaPointScheme() const
+{
+    return scheme_;
+}
+
+int UnscentedKalmanFilter::sigmaPointCount() const
+{
+    return static_cast<int>(weights_mean_.size());
+}
+
 void UnscentedKalmanFilter::computeWeights()
 {
-    double denom = n_x_ + lambda_;
-    weights_mean_(0) = lambda_ / denom;
-    weights_cov_(0) = lambda_ / denom + (1 - alpha_ * alpha_ + beta_);
-    for (int i = 1; i < 2 * n_x_ + 1; ++i) {
-        weights_mean_(i) = 1.0 / (2.0 * denom);
-        weights_cov_(i) = 1.0 / (2.0 * denom);
+    const int n = n_x_;
+    switch (scheme_) {
+    case SigmaPointScheme::Scaled: {
+        double denom = n + lambda_;
+        weights_mean_ = Vector::Constant(2 * n + 1, 1.0 / (2.0 * denom));
+        weights_cov_ = weights_mean_;
+        weights_mean_(0) = lambda_ / denom;
+        weights_cov_(0) = lambda_ / denom + (1 - alpha_ * alpha_ + beta_);
+        return;
+    }
+    case SigmaPointScheme::SphericalSimplex: {
+        // Julier's spherical simplex: a center point and n + 1 points on a
+        // sphere, all with weight 1 / (n + 2), built one dimension at a time
+        double w = 1.0 / (n + 2);
+        unit_points_ = Matrix::Zero(n, n + 2);
+        for (int j = 1; j <= n; ++j) {
+            double scale = 1.0 / std::sqrt(j * (j + 1) * w);
+            unit_points_.block(j - 1, 1, 1, j).setConstant(-scale);
+            unit_points_(j - 1, j + 1) = j * scale;
+        }
+        weights_mean_ = Vector::Constant(n + 2, w);
+        weights_cov_ = weights_mean_;
+        return;
+    }
+    case SigmaPointScheme::FifthDegreeCubature: {
+        // Fifth-degree spherical-radial rule: the center, 2n axis points at
+        // radius sqrt(n + 2) and 2n(n - 1) points on the axis diagonals
+        double r = std::sqrt(n + 2.0);
+        double s = r / std::sqrt(2.0);
+        int count = 2 * n * n + 1;
+        unit_points_ = Matrix::Zero(n, count);
+        weights_mean_.resize(count);
+        weights_mean_(0) = 2.0 / (n + 2);
+        int column = 1;
+        for (int i = 0; i < n; ++i) {
+            for (double sign : {1.0, -1.0}) {
+                unit_points_(i, column) = sign * r;
+                weights_mean_(column++) = (4.0 - n) / (2.0 * (n + 2) * (n + 2));
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                for (double si : {1.0, -1.0}) {
+                    for (double sj : {1.0, -1.0}) {
+                        unit_points_(i, column) = si * s;
+                        unit_points_(j, column) = sj * s;
+                        weights_mean_(column++) = 1.0 / ((n + 2.0) * (n + 2.0));
+                    }
+                }
+            }
+        }
+        weights_cov_ = weights_mean_;
+        return;
+    }
     }
 }
 
 void UnscentedKalmanFilter::generateSigmaPoints()
 {
-    sigma_points_.clear();
-    Matrix A = P_.llt().matrixL();
-    sigma_points_.push_back(x_);
-    double scaling = std::sqrt(n_x_ + lambda_);
-    for (int i = 0; i < n_x_; ++i) {
-        sigma_points_.push_back(x_ + scaling * A.col(i));
-        sigma_points_.push_back(x_ - scaling * A.col(i));
+    llt_.compute(P_);
+    if (llt_.info() != Eigen::Success) {
+        throw std::runtime_error("State covariance is not positive definite.");
     }
+    if (scheme_ != SigmaPointScheme::Scaled) {
+        L_ = llt_.matrixL();
+        sigma_points_.noalias() = L_ * unit_points_;
+        sigma_points_.colwise() += x_;
+        return;
+    }
+    // Columns: x, x + s * L, x - s * L
+    double scaling = std::sqrt(n_x_ + lambda_);
+    auto plus = sigma_points_.middleCols(1, n_x_);
+    auto minus = sigma_points_.middleCols(1 + n_x_, n_x_);
+    plus = llt_.matrixL();
+    plus *= scaling;
+    minus = -plus;
+    sigma_points_.rightCols(2 * n_x_).colwise() += x_;
+    sigma_points_.col(0) = x_;
 }
 
-void UnscentedKalmanFilter::predict()
+void UnscentedKalmanFilter::transformSigmaPoints(const std::function<Vector(const Vector&)>& model,
+                                                 const InPlaceModel& in_place_model,
+                                                 const BatchModel& batch_model,
+                                                 Vector& output,
+                                                 Matrix& transformed,
+                                                 ParallelTransform& parallel)
 {
-    if (!f_) return; // Optionally throw or assert
-    generateSigmaPoints();
-    std::vector<Vector> propagated_sigma;
-    for (const auto& pt : sigma_points_) {
-        propagated_sigma.push_back(f_(pt));
+    if (batch_model) {
+        batch_model(sigma_points_, transformed);
+        return;
     }
-
-    // Predict mean
-    x_ = Vector::Zero(n_x_);
-    for (size_t i = 0; i < propagated_sigma.size(); ++i) {
-        x_ += weights_mean_(i) * propagated_sigma[i];
+    const int n_sigma = static_cast<int>(sigma_points_.cols());
+    bool run_parallel = false;
+    if (pool_ && pool_->size() > 1) {
+        // Hysteresis: a parallel model returns to the calling thread only
+        // once a serial pass is estimated below half the threshold
+        double serial_nanoseconds = parallel.point_nanoseconds * n_sigma;
+        parallel.parallel = serial_nanoseconds >=
+            (parallel.parallel ? 0.5 * min_parallel_nanoseconds_ : min_parallel_nanoseconds_);
+        run_parallel = parallel.parallel && ++parallel.parallel_passes < kProbeInterval;
+        if (!run_parallel) {
+            parallel.parallel_passes = 0;
+        }
     }
+    std::chrono::steady_clock::time_point start;
+    if (pool_ && !run_parallel) {
+        start = std::chrono::steady_clock::now();
+    }
+    if (run_parallel) {
+        if (in_place_model && parallel.outputs.empty()) {
+            parallel.outputs.assign(n_sigma, output);
+        }
+        pending_model_ = &model;
+        pending_in_place_model_ = &in_place_model;
+        pending_outputs_ = &parallel.outputs;
+        pending_transformed_ = &transformed;
+        // Capture only this so the std::function holds the lambda without allocating
+        pool_->parallelFor(0, n_sigma, [this](int i) { transformPoint(i); });
+    } else {
+        for (int i = 0; i < n_sigma; ++i) {
+            point_ = sigma_points_.col(i);
+            if (in_place_model) {
+                in_place_model(point_, output);
+                transformed.col(i) = output;
+            } else {
+                transformed.col(i) = model(point_);
+            }
+        }
+    }
+    if (pool_ && !run_parallel) {
+        // Per-point cost from serial passes only, so pool overhead does not
+        // feed back into the decision, smoothed over recent passes
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        double sample = elapsed / n_sigma;
+        parallel.point_nanoseconds = parallel.serial_passes++ == 0 ? sample :
+            parallel.point_nanoseconds + kCostSmoothing * (sample - parallel.point_nanoseconds);
+    }
+}
 
-    // Predict covariance
-    P_ = Matrix::Zero(n_x_, n_x_);
-    for (size_t i = 0; i < propagated_sigma.size(); ++i) {
-        Vector dx = propagated_sigma[i] - x_;
-        P_ += weights_cov_(i) * dx * dx.transpose();
+void UnscentedKalmanFilter::transformPoint(int i)
+{
+    Vector& point = points_[i];
+    point = sigma_points_.col(i);
+    if (*pending_in_place_model_) {
+        Vector& output = (*pending_outputs_)[i];
+        (*pending_in_place_model_)(point, output);
+        pending_transformed_->col(i) = output;
+    } else {
+        pending_transformed_->col(i) = (*pending_model_)(point);
     }
-    P_ += Q_;
+}
+
+void UnscentedKalmanFilter::setThreadPool(ThreadPool* pool, double min_parallel_nanoseconds)
+{
+    pool_ = pool;
+    min_parallel_nanoseconds_ = min_parallel_nanoseconds;
+    points_.assign(sigma_points_.cols(), point_);
+}
+
+void UnscentedKalmanFilter::predict()
+{
+    if (!f_ && !f_in_place_ && !f_batch_) return; // Optionally throw or assert
+    generateSigmaPoints();
+    transformSigmaPoints(f_, f_in_place_, f_batch_, fx_, propagated_, process_parallel_);
+
+    // Predicted mean and covariance as products over the sigma matrix
+    x_.noalias() = propagated_ * weights_mean_;
+    propagated_.colwise() -= x_;
+    weighted_.noalias() = propagated_ * weights_cov_.asDiagonal();
+    P_ = Q_;
+    P_.noalias() += weighted_ * propagated_.transpose();
 }
 
 void UnscentedKalmanFilter::update(const Eigen::VectorXd& z)
 {
-    if (!h_) return; // Optionally throw or assert
+    if (!h_ && !h_in_place_ && !h_batch_) return; // Optionally throw or assert
     z_ = z; // Store last measurement if needed
 
-    // Transform sigma points through measurement function
-    std::vector<Vector> meas_sigma;
-    for (const auto& pt : sigma_points_) {
-        meas_sigma.push_back(h_(pt));
-    }
+    // Sigma points of the predicted estimate through the measurement model
+    generateSigmaPoints();
+    transformSigmaPoints(h_, h_in_place_, h_batch_, hx_, meas_sigma_, measurement_parallel_);
 
-    // Predicted measurement mean
-    Vector z_pred = Vector::Zero(n_z_);
-    for (size_t i = 0; i < meas_sigma.size(); ++i) {
-        z_pred += weights_mean_(i) * meas_sigma[i];
-    }
+    z_pred_.noalias() = meas_sigma_ * weights_mean_;
+    meas_sigma_.colwise() -= z_pred_;
+    sigma_points_.colwise() -= x_;
+    weighted_meas_.noalias() = meas_sigma_ * weights_cov_.asDiagonal();
 
-    // Innovation covariance
-    Matrix S = Matrix::Zero(n_z_, n_z_);
-    for (size_t i = 0; i < meas_sigma.size(); ++i) {
-        Vector dz = meas_sigma[i] - z_pred;
-        S += weights_cov_(i) * dz * dz.transpose();
-    }
-    S += R_;
-
-    // Cross covariance
-    Matrix Tc = Matrix::Zero(n_x_, n_z_);
-    for (size_t i = 0; i < meas_sigma.size(); ++i) {
-        Vector dx = sigma_points_[i] - x_;
-        Vector dz = meas_sigma[i] - z_pred;
-        Tc += weights_cov_(i) * dx * dz.transpose();
-    }
+    // Innovation and cross covariance
+    S_ = R_;
+    S_.noalias() += weighted_meas_ * meas_sigma_.transpose();
+    Tc_.noalias() = sigma_points_ * weighted_meas_.transpose();
 
-    // Kalman gain
-    Matrix K = Tc * S.inverse();
+    // Kalman gain, state and covariance update
+    innovation_ = z - z_pred_;
+    corrector_.correctWithCrossCovariance(x_, P_, Tc_, S_, innovation_);
+}
 
-    // Update state and covariance
-    x_ = x_ + K * (z - z_pred);
-    P_ = P_ - K * S * K.transpose();
+void UnscentedKalmanFilter::setUpdateStrategy(const UpdateStrategy& strategy)
+{
+    corrector_.setStrategy(strategy);
 }
 
 const UnscentedKalmanFilter::Vector& UnscentedKalmanFilter::state() const
@@ -129,4 +332,14 @@ const UnscentedKalmanFilter::Vector& UnscentedKalmanFilter::state() const
 const UnscentedKalmanFilter::Matrix& UnscentedKalmanFilter::covariance() const
 {
     return P_;
+}
+
+void UnscentedKalmanFilter::setState(const Vector& x, const Matrix& P)
+{
+    initialize(x, P);
+}
+
+double UnscentedKalmanFilter::logLikelihood() const
+{
+    return corrector_.logLikelihood();
 }
\ No newline at end of file
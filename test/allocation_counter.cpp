@@ -0,0 +1,28 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "allocation_counter.h"
+
+namespace {
+std::atomic<std::size_t> allocations{0};
+}
+
+std::size_t allocationCount() {
+    return allocations.load();
+}
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
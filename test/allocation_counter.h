@@ -0,0 +1,14 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+/**
+ * @brief Number of global operator new calls made by the test binary so far.
+ *
+ * Take the difference around a block of code to check that it does not
+ * allocate.
+ */
+std::size_t allocationCount();
+
+#endif // ALLOCATION_COUNTER_H
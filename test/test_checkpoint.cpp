@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <Eigen/Dense>
+#include <checkpoint.h>
+#include <extended_kalman_filter.h>
+#include <kalman_filter.h>
+#include <sequential_monte_carlo.h>
+#include <unscented_kalman_filter.h>
+
+static KalmanFilter makeFilter(double q) {
+    Eigen::MatrixXd A(2, 2);
+    A << 1, 0.1,
+         0, 1;
+    Eigen::MatrixXd C(1, 2);
+    C << 1, 0;
+    Eigen::MatrixXd Q = q * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(1, 1);
+    KalmanFilter kf(0.1, A, C, Q, R, Eigen::MatrixXd::Identity(2, 2));
+    kf.init(Eigen::VectorXd::Zero(2));
+    return kf;
+}
+
+static Eigen::VectorXd measurement(int k) {
+    Eigen::VectorXd z(1);
+    z << 0.3 * k + 0.1 * std::sin(k);
+    return z;
+}
+
+static std::string checkpointPath(const char* name) {
+    std::string path = testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+TEST(CheckpointTest, RestoredFiltersContinueIdentically) {
+    std::string path = checkpointPath("checkpoint_roundtrip.bin");
+
+    KalmanFilter kf = makeFilter(1e-3);
+    kf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+
+    Eigen::VectorXd x0(2); x0 << 1, 1;
+    Eigen::MatrixXd I = Eigen::MatrixXd::Identity(2, 2);
+    auto f = [](const Eigen::VectorXd& x) { Eigen::VectorXd y(2); y << x(0) + 0.1 * x(1), x(1); return y; };
+    auto F = [](const Eigen::VectorXd&) { Eigen::MatrixXd J(2, 2); J << 1, 0.1, 0, 1; return J; };
+    auto h = [](const Eigen::VectorXd& x) { Eigen::VectorXd z(1); z << x(0); return z; };
+    auto H = [](const Eigen::VectorXd&) { Eigen::MatrixXd J(1, 2); J << 1, 0; return J; };
+    ExtendedKalmanFilter ekf(x0, I, 1e-3 * I, 0.1 * Eigen::MatrixXd::Identity(1, 1));
+    ekf.setProcessModel(f, F);
+    ekf.setMeasurementModel(h, H);
+    UnscentedKalmanFilter ukf(2, 1);
+    ukf.initialize(x0, I);
+    ukf.setProcessModel(f, 1e-3 * I);
+    ukf.setMeasurementModel(h, 0.1 * Eigen::MatrixXd::Identity(1, 1));
+    SequentialMonteCarlo smc(200);
+
+    Eigen::VectorXd z2(2);
+    for (int k = 0; k < 20; ++k) {
+        kf.predict(); kf.update(measurement(k));
+        ekf.predict(); ekf.update(measurement(k));
+        ukf.predict(); ukf.update(measurement(k));
+        z2 << measurement(k)(0), 0.0;
+        smc.predict(); smc.update(z2);
+    }
+    {
+        CheckpointWriter writer(path);
+        writer.write(1, kf);
+        writer.write(2, ekf);
+        writer.write(3, ukf);
+        writer.write(4, smc);
+        writer.commit();
+    }
+
+    CheckpointReader reader(path);
+    ASSERT_EQ(reader.size(), 4u);
+    EXPECT_EQ(reader.kind(4), CheckpointKind::SequentialMonteCarlo);
+    KalmanFilter kf_restored = makeFilter(1.0);
+    reader.restore(1, kf_restored);
+    ExtendedKalmanFilter ekf_restored(Eigen::VectorXd::Zero(2), I, I, Eigen::MatrixXd::Identity(1, 1));
+    ekf_restored.setProcessModel(f, F);
+    ekf_restored.setMeasurementModel(h, H);
+    reader.restore(2, ekf_restored);
+    UnscentedKalmanFilter ukf_restored(2, 1);
+    ukf_restored.setProcessModel(f, I);
+    ukf_restored.setMeasurementModel(h, Eigen::MatrixXd::Identity(1, 1));
+    reader.restore(3, ukf_restored);
+    SequentialMonteCarlo smc_restored(1);
+    reader.restore(4, smc_restored);
+    EXPECT_THROW(reader.restore(1, ekf_restored), std::invalid_argument);
+
+    for (int k = 20; k < 30; ++k) {
+        kf.predict(); kf.update(measurement(k));
+        kf_restored.predict(); kf_restored.update(measurement(k));
+        ekf.predict(); ekf.update(measurement(k));
+        ekf_restored.predict(); ekf_restored.update(measurement(k));
+        ukf.predict(); ukf.update(measurement(k));
+        ukf_restored.predict(); ukf_restored.update(measurement(k));
+        z2 << measurement(k)(0), 0.0;
+        smc.predict(); smc.update(z2);
+        smc_restored.predict(); smc_restored.update(z2);
+    }
+    EXPECT_EQ(kf_restored.state(), kf.state());
+    EXPECT_EQ(kf_restored.covariance(), kf.covariance());
+    EXPECT_DOUBLE_EQ(kf_restored.time(), kf.time());
+    EXPECT_EQ(ekf_restored.state(), ekf.state());
+    EXPECT_EQ(ekf_restored.covariance(), ekf.covariance());
+    EXPECT_EQ(ukf_restored.state(), ukf.state());
+    EXPECT_EQ(ukf_restored.covariance(), ukf.covariance());
+    EXPECT_EQ(smc_restored.particles(), smc.particles());
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, IncrementalWritesKeepNewestCommittedRecord) {
+    std::string path = checkpointPath("checkpoint_incremental.bin");
+    KalmanFilter a = makeFilter(1e-3);
+    KalmanFilter b = makeFilter(1e-2);
+    {
+        CheckpointWriter writer(path);
+        writer.write(1, a);
+        writer.write(2, b);
+        writer.commit();
+    }
+    a.predict();
+    a.update(measurement(0));
+    Eigen::VectorXd a_committed = a.state();
+    {
+        // Only the dirty filter is appended; a batch without commit is dropped
+        CheckpointWriter writer(path);
+        writer.write(1, a);
+        writer.commit();
+        a.predict();
+        a.update(measurement(1));
+        writer.write(1, a);
+    }
+
+    CheckpointReader reader(path);
+    EXPECT_EQ(reader.size(), 2u);
+    KalmanFilter restored = makeFilter(1.0);
+    reader.restore(1, restored);
+    EXPECT_EQ(restored.state(), a_committed);
+    reader.restore(2, restored);
+    EXPECT_EQ(restored.processNoise(), b.processNoise());
+    EXPECT_FALSE(reader.contains(3));
+    EXPECT_THROW(reader.restore(3, restored), std::out_of_range);
+
+    std::string compacted = checkpointPath("checkpoint_compacted.bin");
+    CheckpointWriter::compact(path, compacted);
+    CheckpointReader compact_reader(compacted);
+    EXPECT_EQ(compact_reader.size(), 2u);
+    compact_reader.restore(1, restored);
+    EXPECT_EQ(restored.state(), a_committed);
+    std::remove(path.c_str());
+    std::remove(compacted.c_str());
+}
+
+TEST(CheckpointTest, RejectsUnknownFormatVersion) {
+    std::string path = checkpointPath("checkpoint_version.bin");
+    {
+        CheckpointWriter writer(path);
+        writer.commit();
+    }
+    {
+        // Bump the version field that follows the 8-byte magic
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(8);
+        std::uint32_t version = 99;
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    EXPECT_THROW(CheckpointReader reader(path), std::runtime_error);
+    EXPECT_THROW(CheckpointWriter writer(path), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, RejectsMismatchedOrCorruptShapes) {
+    std::string path = checkpointPath("checkpoint_shapes.bin");
+    Eigen::MatrixXd I = Eigen::MatrixXd::Identity(2, 2);
+    auto f = [](const Eigen::VectorXd& x) { return x; };
+    auto h = [](const Eigen::VectorXd& x) { return Eigen::VectorXd(x.head(1)); };
+    UnscentedKalmanFilter ukf(2, 1);
+    ukf.setProcessModel(f, I);
+    ukf.setMeasurementModel(h, Eigen::MatrixXd::Identity(1, 1));
+    {
+        CheckpointWriter writer(path);
+        writer.write(1, ukf);
+        writer.commit();
+    }
+    // Same state size, but R is 1 x 1 against a filter measuring two components
+    UnscentedKalmanFilter wider(2, 2);
+    {
+        CheckpointReader reader(path);
+        EXPECT_THROW(reader.restore(1, wider), std::invalid_argument);
+        UnscentedKalmanFilter restored(2, 1);
+        reader.restore(1, restored);
+        EXPECT_EQ(restored.measurementNoise(), ukf.measurementNoise());
+    }
+    {
+        // Shape of x after the file and record headers: 2^61 x 8 doubles
+        // wrap to a zero byte count when multiplied
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16 + 24);
+        std::int64_t shape[2] = {std::int64_t(1) << 61, 8};
+        file.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+    }
+    CheckpointReader reader(path);
+    UnscentedKalmanFilter restored(2, 1);
+    EXPECT_THROW(reader.restore(1, restored), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(CheckpointTest, RejectsInconsistentKalmanFilterRecord) {
+    std::string path = checkpointPath("checkpoint_kalman_filter.bin");
+    KalmanFilter kf = makeFilter(0.01);
+    // C has one column too many for the 2-state model
+    KalmanFilter inconsistent(0.1, kf.transitionMatrix(), Eigen::MatrixXd::Ones(1, 3),
+                              kf.processNoise(), kf.measurementNoise(), kf.covariance());
+    inconsistent.init(Eigen::VectorXd::Zero(2));
+    {
+        CheckpointWriter writer(path);
+        writer.write(1, kf);
+        writer.write(2, inconsistent);
+        writer.commit();
+    }
+    {
+        // Solver, the third scalar after the file, record and shape headers
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16 + 24 + 16 + 2 * sizeof(double));
+        double solver = 7.0;
+        file.write(reinterpret_cast<const char*>(&solver), sizeof(solver));
+    }
+    CheckpointReader reader(path);
+    KalmanFilter restored = makeFilter(0.5);
+    EXPECT_THROW(reader.restore(1, restored), std::invalid_argument);
+    EXPECT_THROW(reader.restore(2, restored), std::invalid_argument);
+    // A rejected record leaves the filter untouched
+    EXPECT_EQ(restored.processNoise(), makeFilter(0.5).processNoise());
+    std::remove(path.c_str());
+}
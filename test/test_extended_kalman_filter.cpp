@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
+#include <cmath>
 #include <Eigen/Dense>
+#include <autodiff_model.h>
 #include <extended_kalman_filter.h>
+#include <extended_kalman_filter_t.h>
+#include <kalman_filter_adapter.h>
+#include "allocation_counter.h"
 
 TEST(ExtendedKalmanFilterTest, NonlinearPrediction) {
     int n = 2, m = 1;
@@ -40,4 +45,285 @@ TEST(ExtendedKalmanFilterTest, NonlinearPrediction) {
     Eigen::VectorXd x_pred = ekf.state();
     EXPECT_NEAR(x_pred(0), 1.0, 1e-6);
     EXPECT_NEAR(x_pred(1), 1.0, 1e-6);
-}
\ No newline at end of file
+}
+
+// Coordinated turn with state [x, y, speed, heading, turn rate]
+struct CoordinatedTurn {
+    double dt;
+    template <typename T>
+    Eigen::Matrix<T, 5, 1> operator()(const Eigen::Matrix<T, 5, 1>& s) const {
+        using std::cos;
+        using std::sin;
+        Eigen::Matrix<T, 5, 1> next;
+        next << s(0) + dt * s(2) * cos(s(3)),
+                s(1) + dt * s(2) * sin(s(3)),
+                s(2),
+                s(3) + dt * s(4),
+                s(4);
+        return next;
+    }
+};
+
+// Range and bearing from the origin
+struct RangeBearing {
+    template <typename T>
+    Eigen::Matrix<T, 2, 1> operator()(const Eigen::Matrix<T, 5, 1>& s) const {
+        using std::atan2;
+        using std::sqrt;
+        Eigen::Matrix<T, 2, 1> z;
+        z << sqrt(s(0) * s(0) + s(1) * s(1)), atan2(s(1), s(0));
+        return z;
+    }
+};
+
+static Eigen::MatrixXd coordinatedTurnJacobian(const Eigen::VectorXd& s, double dt) {
+    Eigen::MatrixXd J = Eigen::MatrixXd::Identity(5, 5);
+    J(0, 2) = dt * std::cos(s(3));
+    J(0, 3) = -dt * s(2) * std::sin(s(3));
+    J(1, 2) = dt * std::sin(s(3));
+    J(1, 3) = dt * s(2) * std::cos(s(3));
+    J(3, 4) = dt;
+    return J;
+}
+
+static Eigen::MatrixXd rangeBearingJacobian(const Eigen::VectorXd& s) {
+    double r2 = s(0) * s(0) + s(1) * s(1);
+    double r = std::sqrt(r2);
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(2, 5);
+    J << s(0) / r, s(1) / r, 0, 0, 0,
+         -s(1) / r2, s(0) / r2, 0, 0, 0;
+    return J;
+}
+
+TEST(ExtendedKalmanFilterTest, AutoDiffJacobianMatchesAnalytic) {
+    Eigen::VectorXd s(5);
+    s << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::VectorXd value;
+    Eigen::MatrixXd J;
+
+    autoDiffModel<5, 5>(CoordinatedTurn{0.1})(s, value, J);
+    Eigen::Matrix<double, 5, 1> s_fixed = s;
+    EXPECT_TRUE(value.isApprox(CoordinatedTurn{0.1}(s_fixed), 1e-14));
+    EXPECT_TRUE(J.isApprox(coordinatedTurnJacobian(s, 0.1), 1e-14));
+
+    autoDiffModel<5, 2>(RangeBearing{})(s, value, J);
+    EXPECT_TRUE(J.isApprox(rangeBearingJacobian(s), 1e-14));
+}
+
+TEST(ExtendedKalmanFilterTest, AutoDiffModelsMatchHandWrittenJacobians) {
+    const double dt = 0.1;
+    Eigen::VectorXd x0(5);
+    x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+
+    ExtendedKalmanFilter manual(x0, P0, Q, R);
+    manual.setProcessModel(
+        [dt](const Eigen::VectorXd& s) { return Eigen::VectorXd(CoordinatedTurn{dt}(Eigen::Matrix<double, 5, 1>(s))); },
+        [dt](const Eigen::VectorXd& s) { return coordinatedTurnJacobian(s, dt); });
+    manual.setMeasurementModel(
+        [](const Eigen::VectorXd& s) { return Eigen::VectorXd(RangeBearing{}(Eigen::Matrix<double, 5, 1>(s))); },
+        [](const Eigen::VectorXd& s) { return rangeBearingJacobian(s); });
+
+    ExtendedKalmanFilter automatic(x0, P0, Q, R);
+    automatic.setLinearizedProcessModel(autoDiffModel<5, 5>(CoordinatedTurn{dt}));
+    automatic.setLinearizedMeasurementModel(autoDiffModel<5, 2>(RangeBearing{}));
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 50; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        manual.predict();
+        manual.update(z);
+        automatic.predict();
+        automatic.update(z);
+    }
+    EXPECT_TRUE(automatic.state().isApprox(manual.state(), 1e-10));
+    EXPECT_TRUE(automatic.covariance().isApprox(manual.covariance(), 1e-10));
+    EXPECT_TRUE(automatic.transitionJacobian().isApprox(manual.transitionJacobian(), 1e-10));
+}
+
+TEST(ExtendedKalmanFilterTest, StaticDispatchMatchesDynamicFilter) {
+    using Process = AutoDiffModel<5, 5, CoordinatedTurn>;
+    using Measurement = AutoDiffModel<5, 2, RangeBearing>;
+    using Filter = ExtendedKalmanFilterT<Process, Measurement, 5, 2>;
+    const double dt = 0.1;
+    Eigen::VectorXd x0(5);
+    x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+
+    ExtendedKalmanFilter dynamic(x0, P0, Q, R);
+    dynamic.setLinearizedProcessModel(autoDiffModel<5, 5>(CoordinatedTurn{dt}));
+    dynamic.setLinearizedMeasurementModel(autoDiffModel<5, 2>(RangeBearing{}));
+    Filter filter(Process(CoordinatedTurn{dt}), Measurement(RangeBearing{}), x0, P0, Q, R);
+    KalmanFilterAdapter<Filter> adapter(filter);
+    BaseKalmanFilter& base = adapter;
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 50; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        dynamic.predict();
+        dynamic.update(z);
+        base.predict();
+        base.update(z);
+    }
+    EXPECT_TRUE(base.state().isApprox(dynamic.state(), 1e-9));
+    EXPECT_TRUE(base.covariance().isApprox(dynamic.covariance(), 1e-9));
+
+    Filter& direct = adapter.filter();
+    Filter::MeasurementVector zf(z);
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 100; ++k) {
+        direct.predict();
+        direct.update(zf);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
+
+// Negative log posterior of x given the prior (x0, P0) and z
+static double mapCost(const Eigen::VectorXd& x, const Eigen::VectorXd& x0, const Eigen::MatrixXd& P0,
+                      const Eigen::VectorXd& z, const Eigen::MatrixXd& R) {
+    Eigen::VectorXd dx = x - x0;
+    Eigen::VectorXd dz = z - RangeBearing{}(Eigen::Matrix<double, 5, 1>(x));
+    return dx.dot(P0.llt().solve(dx)) + dz.dot(R.llt().solve(dz));
+}
+
+TEST(ExtendedKalmanFilterTest, IteratedUpdateReachesLowerPosteriorCost) {
+    Eigen::VectorXd x0(5);
+    x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = 4.0 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-4 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::VectorXd z(2);
+    z << 9.0, -0.1;
+
+    ExtendedKalmanFilter single(x0, P0, Q, R);
+    single.setLinearizedMeasurementModel(autoDiffModel<5, 2>(RangeBearing{}));
+    ExtendedKalmanFilter iterated(x0, P0, Q, R);
+    iterated.setLinearizedMeasurementModel(autoDiffModel<5, 2>(RangeBearing{}));
+    iterated.setIteratedUpdate(20, 1e-10);
+    int reported = 0;
+    iterated.setIterationCallback([&reported](int iterations, double step_norm) {
+        reported = iterations;
+        EXPECT_LE(step_norm, 1e-10);
+    });
+    ExtendedKalmanFilter one_iteration(x0, P0, Q, R);
+    one_iteration.setLinearizedMeasurementModel(autoDiffModel<5, 2>(RangeBearing{}));
+    one_iteration.setIteratedUpdate(1, 0.0);
+
+    single.update(z);
+    iterated.update(z);
+    one_iteration.update(z);
+
+    EXPECT_EQ(one_iteration.state(), single.state());
+    EXPECT_EQ(one_iteration.covariance(), single.covariance());
+    EXPECT_GT(iterated.iterationCount(), 2);
+    EXPECT_LT(iterated.iterationCount(), 20);
+    EXPECT_EQ(reported, iterated.iterationCount());
+    EXPECT_LT(mapCost(iterated.state(), x0, P0, z, R), mapCost(single.state(), x0, P0, z, R));
+}
+
+TEST(ExtendedKalmanFilterTest, IteratedUpdateStopsEarlyForLinearMeasurement) {
+    Eigen::VectorXd x0(2); x0 << 0, 1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(1, 1);
+    auto h = [](const Eigen::VectorXd& x) { Eigen::VectorXd z(1); z << x(0) + 2.0 * x(1); return z; };
+    auto H = [](const Eigen::VectorXd&) { Eigen::MatrixXd J(1, 2); J << 1, 2; return J; };
+
+    ExtendedKalmanFilter plain(x0, P0, Q, R);
+    plain.setMeasurementModel(h, H);
+    ExtendedKalmanFilter iterated(x0, P0, Q, R);
+    iterated.setMeasurementModel(h, H);
+    iterated.setIteratedUpdate(10, 1e-12);
+    EXPECT_THROW(iterated.setIteratedUpdate(0, 1e-12), std::invalid_argument);
+
+    Eigen::VectorXd z(1); z << 3.0;
+    plain.update(z);
+    iterated.update(z);
+    // The second linearization reproduces the first estimate
+    EXPECT_EQ(iterated.iterationCount(), 2);
+    EXPECT_TRUE(iterated.state().isApprox(plain.state(), 1e-12));
+    EXPECT_TRUE(iterated.covariance().isApprox(plain.covariance(), 1e-12));
+}
+
+TEST(ExtendedKalmanFilterTest, LazyJacobianRefreshReusesLinearization) {
+    Eigen::VectorXd x0(2); x0 << 0, 1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(1, 1);
+    int f_jacobians = 0;
+    auto f = [](const Eigen::VectorXd& x) { Eigen::VectorXd y(2); y << x(0) + 0.1 * x(1), x(1); return y; };
+    auto F = [&f_jacobians](const Eigen::VectorXd&) {
+        ++f_jacobians;
+        Eigen::MatrixXd J(2, 2); J << 1, 0.1, 0, 1; return J;
+    };
+    auto h = [](const Eigen::VectorXd& x) { Eigen::VectorXd z(1); z << x(0); return z; };
+    auto H = [](const Eigen::VectorXd&) { Eigen::MatrixXd J(1, 2); J << 1, 0; return J; };
+
+    ExtendedKalmanFilter every_step(x0, P0, Q, R);
+    every_step.setProcessModel(f, F);
+    every_step.setMeasurementModel(h, H);
+    ExtendedKalmanFilter lazy(x0, P0, Q, R);
+    lazy.setProcessModel(f, F);
+    lazy.setMeasurementModel(h, H);
+    lazy.setJacobianRefreshPolicy({1e9, 4});
+    EXPECT_THROW(lazy.setJacobianRefreshPolicy({0.0, 0}), std::invalid_argument);
+
+    Eigen::VectorXd z(1);
+    for (int k = 0; k < 10; ++k) {
+        z << 0.1 * k;
+        every_step.predict();
+        every_step.update(z);
+        lazy.predict();
+        lazy.update(z);
+    }
+    EXPECT_EQ(every_step.processJacobianCounters().evaluated, 10);
+    EXPECT_EQ(every_step.processJacobianCounters().skipped, 0);
+    EXPECT_EQ(lazy.processJacobianCounters().evaluated, 3);
+    EXPECT_EQ(lazy.processJacobianCounters().skipped, 7);
+    EXPECT_EQ(lazy.measurementJacobianCounters().evaluated, 3);
+    EXPECT_EQ(f_jacobians, 13);
+    // Constant Jacobians: reuse changes nothing
+    EXPECT_TRUE(lazy.state().isApprox(every_step.state(), 1e-12));
+    EXPECT_TRUE(lazy.covariance().isApprox(every_step.covariance(), 1e-12));
+
+    // A state threshold alone refreshes once the state moves past it
+    ExtendedKalmanFilter moved(x0, P0, Q, R);
+    moved.setProcessModel(f, F);
+    moved.setJacobianRefreshPolicy({0.25, 1000});
+    for (int k = 0; k < 10; ++k) {
+        moved.predict(); // x(0) advances by 0.1 per step
+    }
+    EXPECT_EQ(moved.processJacobianCounters().evaluated, 4);
+    EXPECT_EQ(moved.processJacobianCounters().skipped, 6);
+}
+
+TEST(ExtendedKalmanFilterTest, IteratedUpdateRelinearizesUnderLazyRefresh) {
+    Eigen::VectorXd x0(2); x0 << 1, 0;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.01 * Eigen::MatrixXd::Identity(1, 1);
+    auto h = [](const Eigen::VectorXd& x) { Eigen::VectorXd z(1); z << x(0) * x(0) + x(1); return z; };
+    auto H = [](const Eigen::VectorXd& x) { Eigen::MatrixXd J(1, 2); J << 2 * x(0), 1; return J; };
+
+    ExtendedKalmanFilter every_step(x0, P0, Q, R);
+    every_step.setMeasurementModel(h, H);
+    every_step.setIteratedUpdate(10, 1e-12);
+    ExtendedKalmanFilter lazy(x0, P0, Q, R);
+    lazy.setMeasurementModel(h, H);
+    lazy.setIteratedUpdate(10, 1e-12);
+    lazy.setJacobianRefreshPolicy({1e9, 1000});
+
+    Eigen::VectorXd z(1); z << 4.0;
+    every_step.update(z);
+    lazy.update(z);
+    // A stale H would stop the iterations at another point
+    EXPECT_GT(lazy.iterationCount(), 2);
+    EXPECT_EQ(lazy.iterationCount(), every_step.iterationCount());
+    EXPECT_TRUE(lazy.state().isApprox(every_step.state(), 1e-12));
+    EXPECT_EQ(lazy.measurementJacobianCounters().evaluated, lazy.iterationCount());
+    EXPECT_EQ(lazy.measurementJacobianCounters().skipped, 0);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include <Eigen/Dense>
+#include <information_filter.h>
+#include <kalman_filter.h>
+
+static KalmanFilter makeKalmanFilter() {
+    double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    Eigen::VectorXd x0(4); x0 << 1, 2, 0.5, -0.5;
+    kf.init(x0);
+    return kf;
+}
+
+TEST(InformationFilterTest, MatchesKalmanFilter) {
+    KalmanFilter kf = makeKalmanFilter();
+    InformationFilter info(kf);
+    for (int k = 0; k < 20; ++k) {
+        Eigen::VectorXd z(2); z << 1 + 0.05 * k, 2 - 0.05 * k;
+        kf.predict();
+        kf.update(z);
+        info.predict();
+        info.update(z);
+    }
+    EXPECT_TRUE(info.state().isApprox(kf.state(), 1e-9));
+    EXPECT_TRUE(info.covariance().isApprox(kf.covariance(), 1e-9));
+}
+
+TEST(InformationFilterTest, ParallelSensorFusionMatchesSequentialUpdates) {
+    KalmanFilter kf = makeKalmanFilter();
+    InformationFilter info(kf);
+
+    // Thirty range-like sensors observing different combinations of the state
+    std::vector<Eigen::MatrixXd> Cs;
+    std::vector<Eigen::MatrixXd> Rs;
+    std::vector<Eigen::VectorXd> zs;
+    std::vector<int> ids;
+    for (int s = 0; s < 30; ++s) {
+        Eigen::MatrixXd C(1, 4);
+        C << std::cos(0.2 * s), std::sin(0.2 * s), 0.1 * (s % 3), 0;
+        Eigen::MatrixXd R = Eigen::MatrixXd::Constant(1, 1, 0.05 + 0.01 * s);
+        Cs.push_back(C);
+        Rs.push_back(R);
+        zs.push_back(Eigen::VectorXd::Constant(1, 1.0 + 0.1 * s));
+        ids.push_back(info.addSensor(C, R));
+    }
+
+    kf.predict();
+    info.predict();
+    for (int s = 0; s < 30; ++s) {
+        KalmanFilter sensor_kf(0.1, kf.transitionMatrix(), Cs[s], kf.processNoise(), Rs[s], kf.covariance());
+        sensor_kf.init(kf.state());
+        sensor_kf.update(zs[s]);
+        kf.init(sensor_kf.state(), sensor_kf.covariance());
+    }
+
+    const int num_threads = 3;
+    std::vector<InformationContribution> contributions(num_threads, InformationContribution(4));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            for (int s = t; s < 30; s += num_threads) {
+                info.accumulate(ids[s], zs[s], contributions[t]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& contribution : contributions) {
+        info.fuse(contribution);
+    }
+
+    EXPECT_TRUE(info.state().isApprox(kf.state(), 1e-9));
+    EXPECT_TRUE(info.covariance().isApprox(kf.covariance(), 1e-9));
+}
+
+TEST(InformationFilterTest, ConvertsBackToKalmanFilter) {
+    InformationFilter info(makeKalmanFilter());
+    info.predict();
+    Eigen::VectorXd z(2); z << 1.2, 1.8;
+    info.update(z);
+
+    KalmanFilter kf = info.toKalmanFilter();
+    EXPECT_TRUE(kf.state().isApprox(info.state()));
+    EXPECT_TRUE(kf.covariance().isApprox(info.covariance()));
+    kf.predict();
+    info.predict();
+    EXPECT_TRUE(kf.state().isApprox(info.state(), 1e-9));
+}
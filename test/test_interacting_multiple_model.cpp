@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <Eigen/Dense>
+#include <interacting_multiple_model.h>
+#include <kalman_filter.h>
+#include <thread_pool.h>
+#include "allocation_counter.h"
+
+// Constant-velocity model in one dimension with position measurements
+static std::unique_ptr<KalmanFilter> makeModel(double q) {
+    Eigen::MatrixXd A(2, 2);
+    A << 1, 1,
+         0, 1;
+    Eigen::MatrixXd C(1, 2);
+    C << 1, 0;
+    Eigen::MatrixXd Q(2, 2);
+    Q << 0.25, 0.5,
+         0.5, 1.0;
+    Eigen::MatrixXd R = 0.01 * Eigen::MatrixXd::Identity(1, 1);
+    auto kf = std::make_unique<KalmanFilter>(1.0, A, C, q * Q, R, Eigen::MatrixXd::Identity(2, 2));
+    kf->init(Eigen::VectorXd::Zero(2));
+    kf->setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    return kf;
+}
+
+static InteractingMultipleModel makeImm(const std::vector<double>& q) {
+    std::vector<std::unique_ptr<BaseKalmanFilter>> models;
+    for (double qj : q) {
+        models.push_back(makeModel(qj));
+    }
+    int M = static_cast<int>(q.size());
+    Eigen::MatrixXd transition = Eigen::MatrixXd::Constant(M, M, M > 1 ? 0.05 / (M - 1) : 0.0);
+    transition.diagonal().setConstant(M > 1 ? 0.95 : 1.0);
+    return InteractingMultipleModel(std::move(models), transition, Eigen::VectorXd::Constant(M, 1.0 / M));
+}
+
+// Stationary target that starts moving at 5 units per step at step 30
+static Eigen::VectorXd position(int k) {
+    Eigen::VectorXd z(1);
+    z << (k < 30 ? 0.0 : 5.0 * (k - 29)) + 0.05 * std::sin(1.7 * k);
+    return z;
+}
+
+TEST(InteractingMultipleModelTest, SingleModelMatchesItsFilter) {
+    auto reference = makeModel(1e-4);
+    InteractingMultipleModel imm = makeImm({1e-4});
+    for (int k = 0; k < 50; ++k) {
+        reference->predict();
+        reference->update(position(k));
+        imm.predict();
+        imm.update(position(k));
+        ASSERT_TRUE(imm.state().isApprox(reference->state(), 1e-12));
+        ASSERT_TRUE(imm.covariance().isApprox(reference->covariance(), 1e-12));
+        EXPECT_NEAR(imm.logLikelihood(), reference->logLikelihood(), 1e-12);
+    }
+    EXPECT_DOUBLE_EQ(imm.modelProbabilities()(0), 1.0);
+}
+
+TEST(InteractingMultipleModelTest, SwitchesToManeuverModel) {
+    InteractingMultipleModel imm = makeImm({1e-4, 1.0});
+    for (int k = 0; k < 30; ++k) {
+        imm.predict();
+        imm.update(position(k));
+    }
+    EXPECT_GT(imm.modelProbabilities()(0), 0.8);
+
+    for (int k = 30; k < 33; ++k) {
+        imm.predict();
+        imm.update(position(k));
+    }
+    EXPECT_GT(imm.modelProbabilities()(1), 0.8);
+    EXPECT_NEAR(imm.modelProbabilities().sum(), 1.0, 1e-12);
+    EXPECT_NEAR(imm.state()(0), position(32)(0), 1.0);
+}
+
+TEST(InteractingMultipleModelTest, ParallelModelsMatchSerial) {
+    ThreadPool pool(3);
+    InteractingMultipleModel serial = makeImm({1e-4, 1e-2, 1.0, 10.0});
+    InteractingMultipleModel parallel = makeImm({1e-4, 1e-2, 1.0, 10.0});
+    parallel.setThreadPool(&pool);
+    for (int k = 0; k < 60; ++k) {
+        serial.predict();
+        serial.update(position(k));
+        parallel.predict();
+        parallel.update(position(k));
+    }
+    EXPECT_TRUE(parallel.state().isApprox(serial.state(), 1e-12));
+    EXPECT_TRUE(parallel.covariance().isApprox(serial.covariance(), 1e-12));
+    EXPECT_TRUE(parallel.modelProbabilities().isApprox(serial.modelProbabilities(), 1e-12));
+}
+
+TEST(InteractingMultipleModelTest, StepDoesNotAllocateAfterWarmUp) {
+    InteractingMultipleModel imm = makeImm({1e-4, 1e-2, 1.0});
+    Eigen::VectorXd z(1);
+    z << 1.0;
+    imm.predict();
+    imm.update(z);
+    imm.logLikelihood();
+
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 20; ++k) {
+        z(0) = position(k)(0);
+        imm.predict();
+        imm.update(z);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <extended_kalman_filter.h>
+#include <unscented_kalman_filter.h>
+
+static KalmanFilter makeConstantVelocityFilter(double dt) {
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C(3, 4);
+    C << 1, 0, 0, 0,
+         0, 1, 0, 0,
+         1, 1, 0, 0;
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R(3, 3);
+    R << 0.2, 0.05, 0.0,
+         0.05, 0.1, 0.02,
+         0.0, 0.02, 0.3;
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    kf.init(Eigen::VectorXd::Zero(4));
+    return kf;
+}
+
+static Eigen::VectorXd measurement(int k) {
+    Eigen::VectorXd z(3);
+    z << 0.1 * k + 0.05 * std::sin(0.7 * k), -0.05 * k, 0.05 * k + 0.05 * std::cos(1.3 * k);
+    return z;
+}
+
+TEST(KalmanCorrectorTest, StrategiesAgreeWithExplicitInverse) {
+    KalmanFilter reference = makeConstantVelocityFilter(0.1);
+    for (int k = 0; k < 30; ++k) {
+        reference.predict();
+        reference.update(measurement(k));
+    }
+
+    for (GainSolver solver : {GainSolver::Inverse, GainSolver::LLT, GainSolver::LDLT}) {
+        for (CovarianceUpdate form : {CovarianceUpdate::Standard, CovarianceUpdate::Joseph, CovarianceUpdate::Symmetric}) {
+            KalmanFilter kf = makeConstantVelocityFilter(0.1);
+            kf.setUpdateStrategy({solver, form});
+            for (int k = 0; k < 30; ++k) {
+                kf.predict();
+                kf.update(measurement(k));
+            }
+            EXPECT_TRUE(kf.state().isApprox(reference.state(), 1e-9));
+            EXPECT_TRUE(kf.covariance().isApprox(reference.covariance(), 1e-9));
+        }
+    }
+}
+
+TEST(KalmanCorrectorTest, NonlinearFiltersAcceptUpdateStrategy) {
+    Eigen::VectorXd x0(2); x0 << 1, 1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd Q = 0.001 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(1, 1);
+    auto f = [](const Eigen::VectorXd& x) { Eigen::VectorXd y(2); y << x(0) + x(1), x(1); return y; };
+    auto F = [](const Eigen::VectorXd&) { Eigen::MatrixXd J(2, 2); J << 1, 1, 0, 1; return J; };
+    auto h = [](const Eigen::VectorXd& x) { Eigen::VectorXd z(1); z << std::sqrt(x(0) * x(0) + 1.0); return z; };
+    auto H = [](const Eigen::VectorXd& x) {
+        Eigen::MatrixXd J(1, 2); J << x(0) / std::sqrt(x(0) * x(0) + 1.0), 0; return J;
+    };
+    Eigen::VectorXd z(1); z << 2.5;
+
+    ExtendedKalmanFilter ekf_inverse(x0, P0, Q, R), ekf_llt(x0, P0, Q, R);
+    ekf_inverse.setProcessModel(f, F);
+    ekf_inverse.setMeasurementModel(h, H);
+    ekf_llt.setProcessModel(f, F);
+    ekf_llt.setMeasurementModel(h, H);
+    ekf_llt.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Joseph});
+    ekf_inverse.predict(); ekf_inverse.update(z);
+    ekf_llt.predict(); ekf_llt.update(z);
+    EXPECT_TRUE(ekf_llt.state().isApprox(ekf_inverse.state(), 1e-9));
+    EXPECT_TRUE(ekf_llt.covariance().isApprox(ekf_inverse.covariance(), 1e-9));
+
+    UnscentedKalmanFilter ukf_inverse(2, 1), ukf_ldlt(2, 1);
+    ukf_inverse.initialize(x0, P0);
+    ukf_inverse.setProcessModel(f, Q);
+    ukf_inverse.setMeasurementModel(h, R);
+    ukf_ldlt.initialize(x0, P0);
+    ukf_ldlt.setProcessModel(f, Q);
+    ukf_ldlt.setMeasurementModel(h, R);
+    ukf_ldlt.setUpdateStrategy({GainSolver::LDLT, CovarianceUpdate::Symmetric});
+    ukf_inverse.predict(); ukf_inverse.update(z);
+    ukf_ldlt.predict(); ukf_ldlt.update(z);
+    EXPECT_TRUE(ukf_ldlt.state().isApprox(ukf_inverse.state(), 1e-9));
+    EXPECT_TRUE(ukf_ldlt.covariance().isApprox(ukf_inverse.covariance(), 1e-9));
+}
+
+TEST(KalmanCorrectorTest, LongRunStaysSymmetricPositiveDefinite) {
+    const int steps = 200000;
+    for (UpdateStrategy strategy : {UpdateStrategy{GainSolver::LLT, CovarianceUpdate::Symmetric},
+                                    UpdateStrategy{GainSolver::LDLT, CovarianceUpdate::Joseph}}) {
+        KalmanFilter kf = makeConstantVelocityFilter(0.01);
+        kf.setUpdateStrategy(strategy);
+        Eigen::MatrixXd P_early;
+        for (int k = 0; k < steps; ++k) {
+            kf.predict();
+            kf.update(measurement(k % 1000));
+            if (k == 1000) {
+                P_early = kf.covariance();
+            }
+        }
+        const Eigen::MatrixXd& P = kf.covariance();
+        EXPECT_EQ(P, P.transpose());
+        EXPECT_EQ(P.llt().info(), Eigen::Success);
+        // The covariance of a time-invariant model converges and must not drift afterwards
+        EXPECT_TRUE(P.isApprox(P_early, 1e-8));
+    }
+}
+
+TEST(KalmanCorrectorTest, LogLikelihoodMatchesInnovationDensity) {
+    for (GainSolver solver : {GainSolver::Inverse, GainSolver::LLT, GainSolver::LDLT}) {
+        KalmanFilter kf = makeConstantVelocityFilter(0.1);
+        kf.setUpdateStrategy({solver, CovarianceUpdate::Symmetric});
+        // Nothing has been observed yet
+        EXPECT_EQ(kf.logLikelihood(), 0.0);
+        for (int k = 0; k < 10; ++k) {
+            kf.predict();
+            Eigen::MatrixXd S = kf.observationMatrix() * kf.covariance() * kf.observationMatrix().transpose() +
+                                kf.measurementNoise();
+            Eigen::VectorXd nu = measurement(k) - kf.observationMatrix() * kf.state();
+            double expected = -0.5 * (nu.dot(S.inverse() * nu) + std::log(S.determinant()) + 3 * std::log(2.0 * M_PI));
+            kf.update(measurement(k));
+            EXPECT_NEAR(kf.logLikelihood(), expected, 1e-9);
+        }
+    }
+
+    // Sequential channels factor the same density when R is diagonal
+    KalmanFilter reference = makeConstantVelocityFilter(0.1);
+    Eigen::MatrixXd R = reference.measurementNoise().diagonal().asDiagonal();
+    KalmanFilter joint(0.1, reference.transitionMatrix(), reference.observationMatrix(),
+                       reference.processNoise(), R, Eigen::MatrixXd::Identity(4, 4));
+    KalmanFilter sequential = joint;
+    joint.init(Eigen::VectorXd::Zero(4));
+    sequential.init(Eigen::VectorXd::Zero(4));
+    sequential.setSequentialMode(KalmanFilter::SequentialMode::On);
+    for (int k = 0; k < 10; ++k) {
+        joint.predict();
+        joint.update(measurement(k));
+        sequential.predict();
+        sequential.update(measurement(k));
+        EXPECT_NEAR(sequential.logLikelihood(), joint.logLikelihood(), 1e-9);
+    }
+}
+
+TEST(KalmanCorrectorTest, FactoredSolversRejectSingularInnovationCovariance) {
+    for (GainSolver solver : {GainSolver::LLT, GainSolver::LDLT}) {
+        // Zero P and R leave S = 0
+        Eigen::MatrixXd A = Eigen::MatrixXd::Identity(2, 2);
+        Eigen::MatrixXd C = Eigen::MatrixXd::Identity(1, 2);
+        KalmanFilter kf(0.1, A, C, Eigen::MatrixXd::Zero(2, 2), Eigen::MatrixXd::Zero(1, 1), Eigen::MatrixXd::Zero(2, 2));
+        kf.init(Eigen::VectorXd::Zero(2));
+        kf.setUpdateStrategy({solver, CovarianceUpdate::Symmetric});
+        EXPECT_THROW(kf.update(Eigen::VectorXd::Ones(1)), std::runtime_error);
+    }
+}
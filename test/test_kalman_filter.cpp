@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
 #include <Eigen/Dense>
 #include <kalman_filter.h>
+#include <mapped_matrix.h>
+#include "allocation_counter.h"
 
 TEST(KalmanFilterTest, LinearPrediction) {
     int n = 2, m = 1;
@@ -20,3 +26,296 @@ TEST(KalmanFilterTest, LinearPrediction) {
     EXPECT_NEAR(x_pred(1), 1.0, 1e-6);
 }
 
+
+static KalmanFilter makePositionFilter(const Eigen::MatrixXd& C, const Eigen::MatrixXd& R) {
+    double dt = 0.5;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(4, 4);
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    Eigen::VectorXd x0(4); x0 << 0, 0, 1, 1;
+    kf.init(x0);
+    return kf;
+}
+
+TEST(KalmanFilterTest, SequentialUpdateMatchesJointUpdate) {
+    Eigen::MatrixXd C(3, 4);
+    C << 1, 0, 0, 0,
+         0, 1, 0, 0,
+         1, -1, 0, 0;
+    Eigen::MatrixXd R = Eigen::Vector3d(0.1, 0.2, 0.05).asDiagonal();
+    KalmanFilter joint = makePositionFilter(C, R);
+    KalmanFilter sequential = makePositionFilter(C, R);
+    sequential.setSequentialMode(KalmanFilter::SequentialMode::Auto);
+
+    for (int k = 0; k < 20; ++k) {
+        Eigen::VectorXd y(3); y << 0.5 * k, 0.4 * k, 0.1 * k;
+        joint.predict();
+        joint.update(y);
+        sequential.predict();
+        sequential.update(y);
+    }
+    EXPECT_TRUE(sequential.state().isApprox(joint.state(), 1e-9));
+    EXPECT_TRUE(sequential.covariance().isApprox(joint.covariance(), 1e-9));
+}
+
+TEST(KalmanFilterTest, SequentialUpdateSkipsMissingChannels) {
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd R = Eigen::Vector2d(0.1, 0.2).asDiagonal();
+    KalmanFilter sequential = makePositionFilter(C, R);
+    sequential.setSequentialMode(KalmanFilter::SequentialMode::On);
+    KalmanFilter reduced = makePositionFilter(C.topRows(1), R.topLeftCorner(1, 1));
+
+    Eigen::VectorXd y(2); y << 1.5, std::numeric_limits<double>::quiet_NaN();
+    sequential.predict();
+    sequential.update(y);
+    reduced.predict();
+    reduced.update(y.head(1));
+    EXPECT_TRUE(sequential.state().isApprox(reduced.state(), 1e-12));
+    EXPECT_TRUE(sequential.covariance().isApprox(reduced.covariance(), 1e-12));
+}
+
+TEST(KalmanFilterTest, SequentialUpdateRejectsZeroVarianceChannel) {
+    // The second channel observes nothing and has no noise, so s = 0
+    Eigen::MatrixXd C = Eigen::MatrixXd::Zero(2, 4);
+    C(0, 0) = 1.0;
+    Eigen::MatrixXd R = Eigen::Vector2d(0.1, 0.0).asDiagonal();
+    KalmanFilter kf = makePositionFilter(C, R);
+    kf.setSequentialMode(KalmanFilter::SequentialMode::On);
+    EXPECT_THROW(kf.update(Eigen::Vector2d(1.0, 0.0)), std::runtime_error);
+}
+
+TEST(KalmanFilterTest, SequentialUpdateRequiresDiagonalNoise) {
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd R(2, 2);
+    R << 0.1, 0.01,
+         0.01, 0.1;
+    KalmanFilter kf = makePositionFilter(C, R);
+    EXPECT_THROW(kf.setSequentialMode(KalmanFilter::SequentialMode::On), std::invalid_argument);
+}
+
+TEST(KalmanFilterTest, SteadyStateGainMatchesConvergedFilter) {
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd R = Eigen::Vector2d(0.1, 0.2).asDiagonal();
+    KalmanFilter regular = makePositionFilter(C, R);
+    KalmanFilter steady = makePositionFilter(C, R);
+    steady.enableSteadyState();
+    ASSERT_TRUE(steady.isSteadyState());
+
+    for (int k = 0; k < 200; ++k) {
+        Eigen::VectorXd y(2); y << 0.5 * k + 0.1 * std::sin(k), 0.5 * k;
+        regular.predict();
+        regular.update(y);
+        steady.predict();
+        steady.update(y);
+    }
+    EXPECT_TRUE(steady.covariance().isApprox(regular.covariance(), 1e-9));
+    EXPECT_TRUE(steady.state().isApprox(regular.state(), 1e-9));
+}
+
+TEST(KalmanFilterTest, SteadyStateSwitchesOverAutomatically) {
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd R = Eigen::Vector2d(0.1, 0.2).asDiagonal();
+    KalmanFilter kf = makePositionFilter(C, R);
+    kf.setSteadyStateTolerance(1e-10);
+
+    Eigen::VectorXd y(2); y << 1.0, 2.0;
+    int steps = 0;
+    while (!kf.isSteadyState() && steps < 1000) {
+        kf.predict();
+        kf.update(y);
+        ++steps;
+    }
+    EXPECT_TRUE(kf.isSteadyState());
+    EXPECT_GT(steps, 1);
+
+    // A missing channel leaves the steady state
+    y(1) = std::numeric_limits<double>::quiet_NaN();
+    kf.setSequentialMode(KalmanFilter::SequentialMode::On);
+    kf.predict();
+    kf.update(y);
+    EXPECT_FALSE(kf.isSteadyState());
+    EXPECT_FALSE(kf.state().hasNaN());
+}
+
+TEST(KalmanFilterTest, SteadyStateMissingChannelWithoutSequentialMode) {
+    // Correlated R rules out the sequential update
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd R(2, 2);
+    R << 0.1, 0.02,
+         0.02, 0.2;
+    KalmanFilter kf = makePositionFilter(C, R);
+    kf.enableSteadyState();
+    Eigen::VectorXd y(2); y << 1.0, 2.0;
+    for (int k = 0; k < 5; ++k) {
+        kf.predict();
+        kf.update(y);
+    }
+    kf.predict();
+
+    // Expected: the regular update of the first channel from the steady prediction
+    KalmanFilter reduced = makePositionFilter(C.topRows(1), R.topLeftCorner(1, 1));
+    reduced.init(kf.state(), kf.covariance());
+    reduced.update(y.head(1));
+
+    y(1) = std::numeric_limits<double>::quiet_NaN();
+    kf.update(y);
+    EXPECT_FALSE(kf.isSteadyState());
+    EXPECT_TRUE(kf.state().allFinite());
+    EXPECT_TRUE(kf.covariance().allFinite());
+    EXPECT_TRUE(kf.state().isApprox(reduced.state(), 1e-12));
+    EXPECT_TRUE(kf.covariance().isApprox(reduced.covariance(), 1e-12));
+
+    // A fully missing measurement leaves the estimate unchanged
+    y(0) = std::numeric_limits<double>::quiet_NaN();
+    Eigen::VectorXd x_before = kf.state();
+    kf.update(y);
+    EXPECT_EQ(kf.state(), x_before);
+    EXPECT_TRUE(kf.covariance().allFinite());
+}
+
+static KalmanFilter makeContinuousFilter(int history_length) {
+    // One-dimensional constant velocity model driven by white acceleration noise
+    Eigen::MatrixXd Ac(2, 2); Ac << 0, 1, 0, 0;
+    Eigen::MatrixXd Qc(2, 2); Qc << 0, 0, 0, 0.5;
+    Eigen::MatrixXd C(1, 2); C << 1, 0;
+    Eigen::MatrixXd R = Eigen::MatrixXd::Constant(1, 1, 0.1);
+    KalmanFilter kf(0.1, Eigen::MatrixXd::Identity(2, 2), C, Eigen::MatrixXd::Zero(2, 2), R,
+                    Eigen::MatrixXd::Identity(2, 2));
+    kf.setContinuousModel(Ac, Qc);
+    kf.setHistoryLength(history_length);
+    kf.init(Eigen::Vector2d(0, 1), Eigen::MatrixXd::Identity(2, 2), 0.0);
+    return kf;
+}
+
+TEST(KalmanFilterTest, PredictToDiscretizesContinuousModel) {
+    KalmanFilter kf = makeContinuousFilter(0);
+    double dt = 0.3, q = 0.5;
+    kf.predictTo(dt);
+
+    Eigen::MatrixXd A(2, 2); A << 1, dt, 0, 1;
+    Eigen::MatrixXd Q(2, 2);
+    Q << q * dt * dt * dt / 3, q * dt * dt / 2,
+         q * dt * dt / 2, q * dt;
+    Eigen::MatrixXd P = A * A.transpose() + Q;
+    EXPECT_NEAR(kf.time(), dt, 1e-15);
+    EXPECT_TRUE(kf.state().isApprox(Eigen::Vector2d(dt, 1), 1e-12));
+    EXPECT_TRUE(kf.covariance().isApprox(P, 1e-12));
+    // Smoothers read the transition of the last prediction
+    EXPECT_TRUE(kf.transitionMatrix().isApprox(A, 1e-12));
+}
+
+TEST(KalmanFilterTest, RepeatedIntervalsHitDiscretizationCache) {
+    KalmanFilter kf = makeContinuousFilter(0);
+    Eigen::VectorXd y(1);
+    for (int k = 1; k <= 100; ++k) {
+        y << 0.1 * k;
+        kf.update(0.1 * k, y);
+    }
+    EXPECT_EQ(kf.discretizationCache().misses(), 1);
+    EXPECT_EQ(kf.discretizationCache().hits(), 99);
+}
+
+TEST(KalmanFilterTest, OutOfSequenceMeasurementMatchesInOrderProcessing) {
+    KalmanFilter in_order = makeContinuousFilter(16);
+    KalmanFilter delayed = makeContinuousFilter(16);
+    const double times[] = {0.1, 0.25, 0.3, 0.45, 0.6};
+    const double values[] = {0.12, 0.24, 0.31, 0.44, 0.62};
+    Eigen::VectorXd y(1);
+
+    for (int k = 0; k < 5; ++k) {
+        y << values[k];
+        in_order.update(times[k], y);
+        if (k != 1) {
+            delayed.update(times[k], y);
+        }
+    }
+    y << values[1];
+    EXPECT_TRUE(delayed.update(times[1], y));
+
+    EXPECT_DOUBLE_EQ(delayed.time(), in_order.time());
+    EXPECT_TRUE(delayed.state().isApprox(in_order.state(), 1e-12));
+    EXPECT_TRUE(delayed.covariance().isApprox(in_order.covariance(), 1e-12));
+}
+
+TEST(KalmanFilterTest, MeasurementOlderThanHistoryIsRejected) {
+    KalmanFilter kf = makeContinuousFilter(2);
+    Eigen::VectorXd y(1); y << 0.0;
+    for (int k = 1; k <= 5; ++k) {
+        kf.update(0.1 * k, y);
+    }
+    Eigen::VectorXd x = kf.state();
+    EXPECT_FALSE(kf.update(0.05, y));
+    EXPECT_EQ(kf.state(), x);
+}
+
+static Eigen::MatrixXd positionMeasurements(int steps) {
+    Eigen::MatrixXd Y(2, steps);
+    for (int k = 0; k < steps; ++k) {
+        Y.col(k) << 0.5 * k + 0.1 * std::sin(k), 0.5 * k - 0.1 * std::cos(k);
+    }
+    return Y;
+}
+
+TEST(KalmanFilterTest, BatchFilterMatchesStepwiseFiltering) {
+    Eigen::MatrixXd C(2, 4); C << 1, 0, 0, 0, 0, 1, 0, 0;
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    KalmanFilter stepwise = makePositionFilter(C, R);
+    KalmanFilter batch = makePositionFilter(C, R);
+    Eigen::MatrixXd Y = positionMeasurements(50);
+
+    Eigen::MatrixXd means(4, 50), variances(4, 50);
+    // Two consecutive blocks are equivalent to one call
+    batch.filter(Y.leftCols(20), means.leftCols(20), variances.leftCols(20));
+    batch.filter(Y.rightCols(30), means.rightCols(30), variances.rightCols(30));
+
+    for (int k = 0; k < 50; ++k) {
+        stepwise.predict();
+        stepwise.update(Y.col(k));
+        EXPECT_TRUE(means.col(k).isApprox(stepwise.state(), 1e-12));
+        EXPECT_TRUE(variances.col(k).isApprox(stepwise.covariance().diagonal(), 1e-12));
+    }
+}
+
+TEST(KalmanFilterTest, BatchFilterDoesNotAllocatePerStep) {
+    Eigen::MatrixXd C(2, 4); C << 1, 0, 0, 0, 0, 1, 0, 0;
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    KalmanFilter kf = makePositionFilter(C, R);
+    kf.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    Eigen::MatrixXd Y = positionMeasurements(1000);
+    Eigen::MatrixXd means(4, 1000);
+
+    kf.filter(Y.leftCols(1), means.leftCols(1));
+    std::size_t before = allocationCount();
+    kf.filter(Y.rightCols(999), means.rightCols(999));
+    EXPECT_EQ(allocationCount(), before);
+}
+
+TEST(KalmanFilterTest, BatchFilterReadsMappedFile) {
+    Eigen::MatrixXd C(2, 4); C << 1, 0, 0, 0, 0, 1, 0, 0;
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd Y = positionMeasurements(100);
+    std::string input = testing::TempDir() + "kalman_filter_input.bin";
+    std::string output = testing::TempDir() + "kalman_filter_output.bin";
+    MappedMatrix::create(input, 2, 100).mutableMatrix() = Y;
+
+    MappedMatrix measurements(input, 2);
+    ASSERT_EQ(measurements.cols(), 100);
+    MappedMatrix means = MappedMatrix::create(output, 4, 100);
+    KalmanFilter mapped = makePositionFilter(C, R);
+    mapped.filter(measurements.matrix(), means.mutableMatrix());
+
+    KalmanFilter in_memory = makePositionFilter(C, R);
+    Eigen::MatrixXd expected(4, 100);
+    in_memory.filter(Y, expected);
+    EXPECT_TRUE(means.matrix().isApprox(expected, 1e-12));
+
+    EXPECT_THROW(MappedMatrix::create(output, -1, 100), std::invalid_argument);
+    EXPECT_THROW(MappedMatrix::create(output, Eigen::Index(1) << 40, Eigen::Index(1) << 40), std::invalid_argument);
+
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+}
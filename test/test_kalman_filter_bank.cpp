@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <kalman_filter_bank.h>
+
+struct ConstantVelocityModel {
+    Eigen::MatrixXd A, C, Q, R, P;
+    explicit ConstantVelocityModel(double dt) : A(4, 4), C(2, 4) {
+        A << 1, 0, dt, 0,
+             0, 1, 0, dt,
+             0, 0, 1, 0,
+             0, 0, 0, 1;
+        C << 1, 0, 0, 0,
+             0, 1, 0, 0;
+        Q = 0.01 * Eigen::MatrixXd::Identity(4, 4);
+        R = Eigen::MatrixXd(2, 2);
+        R << 0.2, 0.05,
+             0.05, 0.1;
+        P = Eigen::MatrixXd::Identity(4, 4);
+    }
+};
+
+TEST(KalmanFilterBankTest, MatchesIndependentKalmanFilters) {
+    ConstantVelocityModel model(0.1);
+    const int num_filters = 300;
+    KalmanFilterBank bank(num_filters, model.A, model.C, model.Q, model.R, model.P);
+    std::vector<KalmanFilter> filters;
+    for (int i = 0; i < num_filters; ++i) {
+        Eigen::VectorXd x0(4); x0 << i, -i, 1, 0.5;
+        filters.emplace_back(0.1, model.A, model.C, model.Q, model.R, model.P);
+        filters.back().init(x0);
+        bank.init(i, x0);
+    }
+
+    Eigen::MatrixXd Y(num_filters, 2);
+    for (int k = 0; k < 20; ++k) {
+        for (int i = 0; i < num_filters; ++i) {
+            Y(i, 0) = i + 0.1 * k + 0.01 * std::sin(i + k);
+            Y(i, 1) = -i + 0.05 * k;
+        }
+        bank.predict();
+        bank.update(Y);
+        for (int i = 0; i < num_filters; ++i) {
+            filters[i].predict();
+            filters[i].update(Y.row(i).transpose());
+        }
+    }
+    for (int i = 0; i < num_filters; ++i) {
+        EXPECT_TRUE(bank.state(i).isApprox(filters[i].state(), 1e-9));
+        EXPECT_TRUE(bank.covariance(i).isApprox(filters[i].covariance(), 1e-9));
+    }
+}
+
+TEST(KalmanFilterBankTest, MaskedUpdateSkipsUnselectedFilters) {
+    ConstantVelocityModel model(1.0);
+    KalmanFilterBank bank(3, model.A, model.C, model.Q, model.R, model.P);
+    bank.predict();
+    Eigen::VectorXd x_before = bank.state(1);
+    Eigen::MatrixXd P_before = bank.covariance(1);
+
+    Eigen::MatrixXd Y = Eigen::MatrixXd::Constant(3, 2, 1.0);
+    Y.row(1).setConstant(std::numeric_limits<double>::quiet_NaN());
+    KalmanFilterBank::Mask mask(3);
+    mask << true, false, true;
+    bank.update(Y, mask);
+
+    EXPECT_EQ(bank.state(1), x_before);
+    EXPECT_EQ(bank.covariance(1), P_before);
+    EXPECT_GT(bank.state(0)(0), 0.0);
+    EXPECT_TRUE(bank.state(0).isApprox(bank.state(2)));
+}
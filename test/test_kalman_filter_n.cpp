@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <kalman_filter_n.h>
+#include <kalman_filter_adapter.h>
+#include "allocation_counter.h"
+
+using ConstantVelocityFilter = KalmanFilterN<4, 2>;
+
+static ConstantVelocityFilter makeConstantVelocityFilter(double dt) {
+    ConstantVelocityFilter::StateMatrix A;
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    ConstantVelocityFilter::MeasurementMatrix C;
+    C << 1, 0, 0, 0,
+         0, 1, 0, 0;
+    ConstantVelocityFilter::StateMatrix Q = 0.01 * ConstantVelocityFilter::StateMatrix::Identity();
+    ConstantVelocityFilter::MeasurementCovariance R = 0.1 * ConstantVelocityFilter::MeasurementCovariance::Identity();
+    ConstantVelocityFilter::StateMatrix P = ConstantVelocityFilter::StateMatrix::Identity();
+    return ConstantVelocityFilter(A, C, Q, R, P);
+}
+
+TEST(KalmanFilterNTest, MatchesDynamicKalmanFilter) {
+    double dt = 0.1;
+    ConstantVelocityFilter fixed = makeConstantVelocityFilter(dt);
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    KalmanFilter reference(dt, A, Eigen::MatrixXd::Identity(2, 4), 0.01 * Eigen::MatrixXd::Identity(4, 4),
+                           0.1 * Eigen::MatrixXd::Identity(2, 2), Eigen::MatrixXd::Identity(4, 4));
+
+    Eigen::Vector4d x0(0, 0, 1, -1);
+    fixed.init(x0);
+    reference.init(x0);
+    for (int k = 0; k < 50; ++k) {
+        Eigen::Vector2d z(0.1 * k + 0.05 * std::sin(k), -0.1 * k);
+        fixed.predict();
+        fixed.update(z);
+        reference.predict();
+        reference.update(z);
+    }
+    EXPECT_TRUE(fixed.state().isApprox(reference.state(), 1e-9));
+    EXPECT_TRUE(fixed.covariance().isApprox(reference.covariance(), 1e-9));
+}
+
+TEST(KalmanFilterNTest, PredictUpdateDoesNotAllocate) {
+    ConstantVelocityFilter filter = makeConstantVelocityFilter(0.1);
+    filter.init(Eigen::Vector4d(0, 0, 1, 1));
+    Eigen::Vector2d z(1.0, 1.0);
+
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 100; ++k) {
+        filter.predict();
+        filter.update(z);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
+
+TEST(KalmanFilterNTest, AdapterImplementsBaseKalmanFilter) {
+    ConstantVelocityFilter filter = makeConstantVelocityFilter(1.0);
+    filter.init(Eigen::Vector4d(0, 0, 1, 2));
+    KalmanFilterAdapter<ConstantVelocityFilter> adapter(filter);
+
+    BaseKalmanFilter& base = adapter;
+    base.predict();
+    EXPECT_NEAR(base.state()(0), 1.0, 1e-12);
+    EXPECT_NEAR(base.state()(1), 2.0, 1e-12);
+
+    Eigen::VectorXd z(2); z << 1.0, 2.0;
+    base.update(z);
+    EXPECT_TRUE(base.state().isApprox(adapter.filter().state()));
+    EXPECT_TRUE(base.covariance().isApprox(adapter.filter().covariance()));
+}
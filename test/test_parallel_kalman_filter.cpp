@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <parallel_kalman_filter.h>
+#include <rts_smoother.h>
+#include <thread_pool.h>
+
+static KalmanFilter makeFilter() {
+    double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C(2, 4);
+    C << 1, 0, 0, 0,
+         0, 1, 0, 0;
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.25 * Eigen::MatrixXd::Identity(2, 2);
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    kf.init(Eigen::Vector4d(0, 0, 1, -1));
+    return kf;
+}
+
+static Eigen::MatrixXd measurements(int steps) {
+    Eigen::MatrixXd Y(2, steps);
+    for (int k = 0; k < steps; ++k) {
+        Y.col(k) << 0.1 * k + std::sin(0.3 * k), -0.1 * k + std::cos(0.2 * k);
+    }
+    return Y;
+}
+
+TEST(ThreadPoolTest, RunsEveryIndexOnceAndPropagatesExceptions) {
+    ThreadPool pool(4);
+    std::atomic<int> sum{0};
+    pool.parallelFor(0, 1000, [&](int i) { sum += i; });
+    EXPECT_EQ(sum.load(), 999 * 1000 / 2);
+
+    EXPECT_THROW(pool.parallelFor(0, 10, [](int i) {
+        if (i == 7) {
+            throw std::runtime_error("failed");
+        }
+    }), std::runtime_error);
+}
+
+TEST(ParallelKalmanFilterTest, MatchesSequentialFilterAndSmoother) {
+    const int steps = 503;
+    Eigen::MatrixXd Y = measurements(steps);
+
+    KalmanFilter sequential = makeFilter();
+    RtsSmoother smoother(sequential.transitionMatrix());
+    smoother.filter(sequential, Y);
+    Eigen::MatrixXd filtered = smoother.states();
+    Eigen::MatrixXd filtered_last_covariance = smoother.covariance(steps - 1);
+    smoother.smooth();
+
+    ThreadPool pool(4);
+    KalmanFilter model = makeFilter();
+    for (int chunks : {1, 3, 7}) {
+        ParallelKalmanFilter parallel(model, pool);
+        parallel.setChunkCount(chunks);
+        parallel.filter(model.state(), model.covariance(), Y);
+        ASSERT_EQ(parallel.size(), steps);
+        EXPECT_TRUE(parallel.states().isApprox(filtered, 1e-9)) << chunks << " chunks";
+        EXPECT_TRUE(parallel.covariance(steps - 1).isApprox(filtered_last_covariance, 1e-9));
+
+        parallel.smooth();
+        EXPECT_TRUE(parallel.states().isApprox(smoother.states(), 1e-9)) << chunks << " chunks";
+        for (int k : {0, 100, 250, steps - 1}) {
+            EXPECT_TRUE(parallel.covariance(k).isApprox(smoother.covariance(k), 1e-9));
+        }
+    }
+}
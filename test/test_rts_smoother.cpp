@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+#include <Eigen/Dense>
+#include <extended_kalman_filter.h>
+#include <fixed_lag_smoother.h>
+#include <kalman_filter.h>
+#include <rts_smoother.h>
+
+static Eigen::MatrixXd transition() {
+    Eigen::MatrixXd A(2, 2);
+    A << 1, 0.1,
+         0, 1;
+    return A;
+}
+
+static KalmanFilter makeFilter() {
+    Eigen::MatrixXd C(1, 2); C << 1, 0;
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.5 * Eigen::MatrixXd::Identity(1, 1);
+    KalmanFilter kf(0.1, transition(), C, Q, R, Eigen::MatrixXd::Identity(2, 2));
+    kf.init(Eigen::Vector2d(0.0, 1.0));
+    return kf;
+}
+
+static Eigen::MatrixXd measurements(int steps) {
+    Eigen::MatrixXd Y(1, steps);
+    for (int k = 0; k < steps; ++k) {
+        Y(0, k) = 0.1 * k + 0.3 * std::sin(0.7 * k);
+    }
+    return Y;
+}
+
+TEST(RtsSmootherTest, MatchesTextbookTwoPassSmoother) {
+    const int steps = 40;
+    Eigen::MatrixXd Y = measurements(steps);
+    Eigen::MatrixXd A = transition();
+
+    // Reference: store everything, then smooth with explicit inverses
+    KalmanFilter kf = makeFilter();
+    std::vector<Eigen::VectorXd> xp, xf;
+    std::vector<Eigen::MatrixXd> Pp, Pf;
+    for (int k = 0; k < steps; ++k) {
+        kf.predict();
+        xp.push_back(kf.state());
+        Pp.push_back(kf.covariance());
+        kf.update(Y.col(k));
+        xf.push_back(kf.state());
+        Pf.push_back(kf.covariance());
+    }
+    for (int k = steps - 2; k >= 0; --k) {
+        Eigen::MatrixXd G = Pf[k] * A.transpose() * Pp[k + 1].inverse();
+        xf[k] += G * (xf[k + 1] - xp[k + 1]);
+        Pf[k] += G * (Pf[k + 1] - Pp[k + 1]) * G.transpose();
+    }
+
+    KalmanFilter filter = makeFilter();
+    RtsSmoother smoother(A);
+    smoother.filter(filter, Y);
+    smoother.smooth();
+    ASSERT_EQ(smoother.size(), steps);
+    for (int k = 0; k < steps; ++k) {
+        EXPECT_TRUE(smoother.state(k).isApprox(xf[k], 1e-10));
+        EXPECT_TRUE(smoother.covariance(k).isApprox(Pf[k], 1e-10));
+    }
+}
+
+TEST(RtsSmootherTest, ExtendedFilterMatchesLinearFilterOnLinearModel) {
+    const int steps = 30;
+    Eigen::MatrixXd Y = measurements(steps);
+    Eigen::MatrixXd A = transition();
+    Eigen::MatrixXd C(1, 2); C << 1, 0;
+
+    ExtendedKalmanFilter ekf(Eigen::Vector2d(0.0, 1.0), Eigen::MatrixXd::Identity(2, 2),
+                             0.01 * Eigen::MatrixXd::Identity(2, 2), 0.5 * Eigen::MatrixXd::Identity(1, 1));
+    ekf.setProcessModel([&](const Eigen::VectorXd& x) { return Eigen::VectorXd(A * x); },
+                        [&](const Eigen::VectorXd&) { return A; });
+    ekf.setMeasurementModel([&](const Eigen::VectorXd& x) { return Eigen::VectorXd(C * x); },
+                            [&](const Eigen::VectorXd&) { return C; });
+    RtsSmoother extended;
+    extended.filter(ekf, Y);
+    extended.smooth();
+
+    KalmanFilter kf = makeFilter();
+    RtsSmoother linear(A);
+    linear.filter(kf, Y);
+    linear.smooth();
+    EXPECT_TRUE(extended.states().isApprox(linear.states(), 1e-10));
+}
+
+TEST(FixedLagSmootherTest, MatchesRtsOverTruncatedSequence) {
+    const int steps = 25;
+    const int lag = 4;
+    Eigen::MatrixXd Y = measurements(steps);
+
+    KalmanFilter kf = makeFilter();
+    FixedLagSmoother lagged(transition(), lag);
+    EXPECT_THROW(FixedLagSmoother(transition(), -1), std::invalid_argument);
+    int emitted = 0;
+    for (int k = 0; k < steps; ++k) {
+        if (!lagged.step(kf, Y.col(k))) {
+            EXPECT_LT(k, lag);
+            continue;
+        }
+        ++emitted;
+        ASSERT_EQ(lagged.index(), k - lag);
+
+        // Smoothing over the data seen so far gives the same estimate
+        KalmanFilter reference = makeFilter();
+        RtsSmoother smoother(transition());
+        smoother.filter(reference, Y.leftCols(k + 1));
+        smoother.smooth();
+        EXPECT_TRUE(lagged.state().isApprox(smoother.state(k - lag), 1e-10));
+        EXPECT_TRUE(lagged.covariance().isApprox(smoother.covariance(k - lag), 1e-10));
+    }
+    EXPECT_EQ(emitted, steps - lag);
+}
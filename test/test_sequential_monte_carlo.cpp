@@ -4,23 +4,23 @@
 // Test construction and initial weights
 TEST(SequentialMonteCarloTest, Initialization) {
     SequentialMonteCarlo pf(100);
-    const auto& particles = pf.getParticles();
-    ASSERT_EQ(particles.size(), 100);
-    for (const auto& p : particles) {
-        EXPECT_DOUBLE_EQ(p.weight, 1.0 / 100);
-        EXPECT_EQ(p.state, Eigen::Vector3d::Zero());
+    ASSERT_EQ(pf.particleCount(), 100);
+    ASSERT_EQ(pf.stateDimension(), 3);
+    EXPECT_EQ(pf.particles(), Eigen::MatrixXd::Zero(100, 3));
+    for (Eigen::Index i = 0; i < pf.weights().size(); ++i) {
+        EXPECT_DOUBLE_EQ(pf.weights()(i), 1.0 / 100);
     }
 }
 
 // Test predict step adds noise
 TEST(SequentialMonteCarloTest, PredictAddsNoise) {
     SequentialMonteCarlo pf(10);
-    auto before = pf.getParticles();
+    Eigen::MatrixXd before = pf.particles();
     pf.predict();
-    const auto& after = pf.getParticles();
+    const Eigen::MatrixXd& after = pf.particles();
     bool changed = false;
-    for (size_t i = 0; i < before.size(); ++i) {
-        if (!before[i].state.isApprox(after[i].state)) {
+    for (Eigen::Index i = 0; i < before.rows(); ++i) {
+        if (!before.row(i).isApprox(after.row(i))) {
             changed = true;
             break;
         }
@@ -33,29 +33,64 @@ TEST(SequentialMonteCarloTest, UpdateNormalizesWeightsAndResamples) {
     SequentialMonteCarlo pf(50);
     Eigen::Vector2d z(1.0, 2.0);
     pf.update(z);
-    const auto& particles = pf.getParticles();
-    double sum = 0.0;
-    for (const auto& p : particles) {
-        sum += p.weight;
-    }
-    EXPECT_NEAR(sum, 1.0, 1e-6);
+    EXPECT_NEAR(pf.weights().sum(), 1.0, 1e-6);
 
     // After resampling, all weights should be equal
-    for (const auto& p : particles) {
-        EXPECT_NEAR(p.weight, 1.0 / 50, 1e-9);
+    for (Eigen::Index i = 0; i < pf.weights().size(); ++i) {
+        EXPECT_NEAR(pf.weights()(i), 1.0 / 50, 1e-9);
     }
 }
 
 // Test degenerate case: all weights zero
 TEST(SequentialMonteCarloTest, DegenerateWeightsReinitialized) {
     SequentialMonteCarlo pf(20);
-    auto& particles = const_cast<std::vector<Particle>&>(pf.getParticles());
-    for (auto& p : particles) {
-        p.weight = 0.0;
-    }
+    pf.setParticles(pf.particles(), Eigen::VectorXd::Zero(20));
     Eigen::Vector2d z(0.0, 0.0);
     pf.update(z);
-    for (const auto& p : pf.getParticles()) {
-        EXPECT_DOUBLE_EQ(p.weight, 1.0 / 20);
+    for (Eigen::Index i = 0; i < pf.weights().size(); ++i) {
+        EXPECT_DOUBLE_EQ(pf.weights()(i), 1.0 / 20);
     }
-}
\ No newline at end of file
+}
+
+// Test a 6-D constant velocity filter with user motion and likelihood kernels
+TEST(SequentialMonteCarloTest, GenericDimensionTracksConstantVelocity) {
+    const int n = 5000;
+    const double dt = 0.1;
+    SequentialMonteCarlo pf(n, 6);
+    EXPECT_THROW(pf.setMotionNoise(Eigen::VectorXd::Ones(3)), std::invalid_argument);
+    pf.setMotionNoise((Eigen::VectorXd(6) << 0.01, 0.01, 0.01, 0.05, 0.05, 0.05).finished());
+    pf.setMotionModel([dt](Eigen::MatrixXd& particles) {
+        particles.leftCols(3) += dt * particles.rightCols(3);
+    });
+    const double sigma = 0.1;
+    pf.setLogLikelihood([sigma](const Eigen::MatrixXd& particles, const Eigen::VectorXd& z,
+                                Eigen::VectorXd& log_likelihood) {
+        log_likelihood = -(particles.leftCols(3).rowwise() - z.transpose()).rowwise().squaredNorm()
+                         / (2.0 * sigma * sigma);
+    });
+
+    // Spread the initial velocities so the filter has to find the true one
+    Eigen::MatrixXd initial = Eigen::MatrixXd::Zero(n, 6);
+    initial.rightCols(3) = Eigen::MatrixXd::Random(n, 3);
+    pf.setParticles(initial, Eigen::VectorXd::Constant(n, 1.0 / n));
+
+    Eigen::Vector3d position = Eigen::Vector3d::Zero();
+    const Eigen::Vector3d velocity(0.5, -0.3, 0.2);
+    for (int k = 0; k < 40; ++k) {
+        position += dt * velocity;
+        pf.predict();
+        pf.update(position);
+    }
+    Eigen::VectorXd mean = pf.mean();
+    EXPECT_TRUE(mean.head(3).isApprox(position, 0.05)) << mean.transpose();
+    EXPECT_LT((mean.tail(3) - velocity).norm(), 0.1) << mean.transpose();
+
+    SequentialMonteCarlo planar(10, 2);
+    EXPECT_THROW(planar.update(Eigen::VectorXd::Zero(3)), std::invalid_argument);
+    EXPECT_THROW(planar.setMeasurementNoise(0.0), std::invalid_argument);
+    EXPECT_THROW(planar.setMeasurementNoise(-1.0), std::invalid_argument);
+    // A kernel that writes one entry per measurement instead of per particle
+    planar.setLogLikelihood([](const Eigen::MatrixXd&, const Eigen::VectorXd& z,
+                               Eigen::VectorXd& log_likelihood) { log_likelihood = -z; });
+    EXPECT_THROW(planar.update(Eigen::VectorXd::Zero(2)), std::invalid_argument);
+}
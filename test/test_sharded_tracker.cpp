@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <Eigen/Dense>
+#include <kalman_filter.h>
+#include <mpsc_queue.h>
+#include <sharded_tracker.h>
+
+// Records the first component of every measurement it is updated with
+class RecordingFilter : public BaseKalmanFilter {
+public:
+    void predict() override {}
+    void update(const Eigen::VectorXd& z) override {
+        values.push_back(z(0));
+        x_ = z;
+    }
+    const Eigen::VectorXd& state() const override { return x_; }
+    const Eigen::MatrixXd& covariance() const override { return P_; }
+
+    std::vector<double> values;
+
+private:
+    Eigen::VectorXd x_ = Eigen::VectorXd::Zero(1);
+    Eigen::MatrixXd P_ = Eigen::MatrixXd::Identity(1, 1);
+};
+
+TEST(MpscQueueTest, IsBoundedAndFifo) {
+    MpscQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        EXPECT_TRUE(queue.push(value));
+    }
+    int extra = 4;
+    EXPECT_FALSE(queue.push(extra));
+    for (int i = 0; i < 4; ++i) {
+        int value = -1;
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(ShardedTrackerTest, KeepsPerTrackOrderAcrossProducers) {
+    const int producers = 4;
+    const int tracks_per_producer = 8;
+    const int measurements = 500;
+    std::vector<RecordingFilter*> filters(producers * tracks_per_producer, nullptr);
+    ShardedTracker tracker(3, [&](long id, const Eigen::VectorXd&) {
+        auto filter = std::make_unique<RecordingFilter>();
+        filters[id] = filter.get();
+        return std::unique_ptr<BaseKalmanFilter>(std::move(filter));
+    }, 64, 16);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            Eigen::VectorXd y(1);
+            for (int k = 0; k < measurements; ++k) {
+                for (int t = 0; t < tracks_per_producer; ++t) {
+                    y(0) = k;
+                    tracker.submit(p * tracks_per_producer + t, y);
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    tracker.flush();
+
+    EXPECT_EQ(tracker.trackCount(), filters.size());
+    EXPECT_EQ(tracker.errors(), 0u);
+    std::uint64_t recorded = 0;
+    for (int s = 0; s < tracker.shardCount(); ++s) {
+        recorded += tracker.latency(s).count();
+        EXPECT_LE(tracker.latency(s).quantile(0.5), tracker.latency(s).quantile(0.99));
+    }
+    EXPECT_EQ(recorded, static_cast<std::uint64_t>(producers * tracks_per_producer * measurements));
+    for (RecordingFilter* filter : filters) {
+        ASSERT_NE(filter, nullptr);
+        ASSERT_EQ(filter->values.size(), static_cast<std::size_t>(measurements));
+        for (int k = 0; k < measurements; ++k) {
+            EXPECT_EQ(filter->values[k], k);
+        }
+    }
+}
+
+TEST(ShardedTrackerTest, MatchesSequentialKalmanFilters) {
+    Eigen::MatrixXd A(2, 2); A << 1, 0.1, 0, 1;
+    Eigen::MatrixXd C(1, 2); C << 1, 0;
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(1, 1);
+    auto make = [&](const Eigen::VectorXd& y) {
+        auto kf = std::make_unique<KalmanFilter>(0.1, A, C, Q, R, Eigen::MatrixXd::Identity(2, 2));
+        kf->init(Eigen::Vector2d(y(0), 0.0));
+        return kf;
+    };
+    ShardedTracker tracker(2, [&](long, const Eigen::VectorXd& y) {
+        return std::unique_ptr<BaseKalmanFilter>(make(y));
+    });
+
+    std::vector<std::unique_ptr<KalmanFilter>> reference;
+    Eigen::VectorXd y(1);
+    for (int k = 0; k < 50; ++k) {
+        for (long id = 0; id < 10; ++id) {
+            y(0) = 0.5 * k + id;
+            if (k == 0) {
+                reference.push_back(make(y));
+            }
+            reference[id]->predict();
+            reference[id]->update(y);
+            tracker.submit(id, y);
+        }
+    }
+    tracker.flush();
+
+    Eigen::VectorXd x;
+    Eigen::MatrixXd P;
+    for (long id = 0; id < 10; ++id) {
+        ASSERT_TRUE(tracker.estimate(id, x, P));
+        EXPECT_TRUE(x.isApprox(reference[id]->state(), 1e-12));
+        EXPECT_TRUE(P.isApprox(reference[id]->covariance(), 1e-12));
+    }
+    EXPECT_FALSE(tracker.estimate(99, x, P));
+}
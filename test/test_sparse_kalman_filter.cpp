@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <kalman_filter.h>
+#include <sparse_kalman_filter.h>
+
+// Independent 1D constant velocity tracks, each a 2x2 block of the state
+struct BlockModel {
+    Eigen::MatrixXd A, C, Q, R, P;
+    explicit BlockModel(int tracks) {
+        int n = 2 * tracks;
+        A = Eigen::MatrixXd::Identity(n, n);
+        Q = 0.01 * Eigen::MatrixXd::Identity(n, n);
+        P = Eigen::MatrixXd::Identity(n, n);
+        C = Eigen::MatrixXd::Zero(tracks, n);
+        for (int k = 0; k < tracks; ++k) {
+            A(2 * k, 2 * k + 1) = 0.1;
+            C(k, 2 * k) = 1.0;
+        }
+        R = 0.2 * Eigen::MatrixXd::Identity(tracks, tracks);
+    }
+};
+
+static SparseKalmanFilter::SparseMatrix sparse(const Eigen::MatrixXd& M) {
+    return M.sparseView();
+}
+
+TEST(SparseKalmanFilterTest, MatchesDenseFilterForUncoupledBlocks) {
+    const int tracks = 10;
+    BlockModel model(tracks);
+    KalmanFilter dense(0.1, model.A, model.C, model.Q, model.R, model.P);
+    SparseKalmanFilter filter(sparse(model.A), sparse(model.C), sparse(model.Q), sparse(model.R), sparse(model.P));
+    for (int k = 0; k < tracks; ++k) {
+        filter.trackCovarianceBlock(2 * k, 2 * k, 2, 2);
+    }
+    Eigen::VectorXd x0 = Eigen::VectorXd::LinSpaced(2 * tracks, 0.0, 1.0);
+    dense.init(x0);
+    filter.init(x0);
+
+    for (int step = 0; step < 10; ++step) {
+        Eigen::VectorXd y = Eigen::VectorXd::LinSpaced(tracks, 0.1 * step, 1.0 + 0.1 * step);
+        dense.predict();
+        dense.update(y);
+        filter.predict();
+        filter.update(y);
+    }
+    EXPECT_TRUE(filter.state().isApprox(dense.state(), 1e-10));
+    EXPECT_TRUE(Eigen::MatrixXd(filter.covariance()).isApprox(dense.covariance(), 1e-10));
+    // Only the 2x2 blocks are stored
+    EXPECT_EQ(filter.covariance().nonZeros(), 4 * tracks);
+}
+
+TEST(SparseKalmanFilterTest, FullyTrackedCovarianceMatchesDenseFilter) {
+    BlockModel model(3);
+    // Couple the tracks through the measurement so cross covariances appear
+    model.C(0, 2) = 0.5;
+    model.C(1, 4) = -0.3;
+    KalmanFilter dense(0.1, model.A, model.C, model.Q, model.R, model.P);
+    SparseKalmanFilter filter(sparse(model.A), sparse(model.C), sparse(model.Q), sparse(model.R), sparse(model.P));
+    filter.trackCovarianceBlock(0, 0, 6, 6);
+    Eigen::VectorXd x0 = Eigen::VectorXd::Ones(6);
+    dense.init(x0);
+    filter.init(x0);
+
+    for (int step = 0; step < 5; ++step) {
+        Eigen::VectorXd y = Eigen::Vector3d(step, 1.0, -0.5 * step);
+        dense.predict();
+        dense.update(y);
+        filter.predict();
+        filter.update(y);
+    }
+    EXPECT_TRUE(filter.state().isApprox(dense.state(), 1e-10));
+    EXPECT_TRUE(filter.covarianceBlock(0, 0, 6, 6).isApprox(dense.covariance(), 1e-10));
+}
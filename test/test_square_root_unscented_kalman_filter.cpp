@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <Eigen/Dense>
+#include <square_root_unscented_kalman_filter.h>
+#include <unscented_kalman_filter.h>
+
+// Coordinated turn [x, y, speed, heading, turn rate]
+static Eigen::VectorXd coordinatedTurn(const Eigen::VectorXd& s) {
+    const double dt = 0.1;
+    Eigen::VectorXd next(5);
+    next << s(0) + dt * s(2) * std::cos(s(3)),
+            s(1) + dt * s(2) * std::sin(s(3)),
+            s(2),
+            s(3) + dt * s(4),
+            s(4);
+    return next;
+}
+
+static Eigen::VectorXd rangeBearing(const Eigen::VectorXd& s) {
+    Eigen::VectorXd z(2);
+    z << std::hypot(s(0), s(1)), std::atan2(s(1), s(0));
+    return z;
+}
+
+TEST(SquareRootUnscentedKalmanFilterTest, MatchesUnscentedKalmanFilter) {
+    Eigen::VectorXd x0(5); x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    P0(0, 1) = P0(1, 0) = 0.3;
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+
+    UnscentedKalmanFilter ukf(5, 2);
+    ukf.initialize(x0, P0);
+    ukf.setProcessModel(coordinatedTurn, Q);
+    ukf.setMeasurementModel(rangeBearing, R);
+    SquareRootUnscentedKalmanFilter srukf(5, 2);
+    srukf.initialize(x0, P0);
+    srukf.setProcessModel(coordinatedTurn, Q);
+    srukf.setMeasurementModel(rangeBearing, R);
+    // Before any update: zero innovation under unit covariance
+    EXPECT_DOUBLE_EQ(srukf.logLikelihood(), -std::log(2.0 * M_PI));
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 30; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        ukf.predict();
+        ukf.update(z);
+        srukf.predict();
+        srukf.update(z);
+    }
+    EXPECT_TRUE(srukf.state().isApprox(ukf.state(), 1e-6));
+    EXPECT_TRUE(srukf.covariance().isApprox(ukf.covariance(), 1e-6));
+    EXPECT_NEAR(srukf.logLikelihood(), ukf.logLikelihood(), 1e-6);
+
+    const Eigen::MatrixXd& S = srukf.squareRootCovariance();
+    EXPECT_TRUE(S.isLowerTriangular());
+    EXPECT_TRUE((S.diagonal().array() > 0.0).all());
+    EXPECT_THROW(srukf.initialize(x0, -P0), std::invalid_argument);
+}
+
+TEST(SquareRootUnscentedKalmanFilterTest, StaysPositiveDefiniteUnderPreciseMeasurements) {
+    // Constant velocity with position fixes twelve orders of magnitude more
+    // precise than the prior: forming P - K * S * K' cancels away every
+    // significant digit, while the factor stays well defined
+    const double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    auto f = [&A](const Eigen::VectorXd& x) { return Eigen::VectorXd(A * x); };
+    auto h = [](const Eigen::VectorXd& x) { return Eigen::VectorXd(x.head(2)); };
+    Eigen::MatrixXd Q = 1e-12 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 1e-12 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::VectorXd x0 = Eigen::VectorXd::Zero(4);
+    Eigen::MatrixXd P0 = 1e6 * Eigen::MatrixXd::Identity(4, 4);
+
+    UnscentedKalmanFilter ukf(4, 2);
+    ukf.initialize(x0, P0);
+    ukf.setProcessModel(f, Q);
+    ukf.setMeasurementModel(h, R);
+    SquareRootUnscentedKalmanFilter srukf(4, 2);
+    srukf.initialize(x0, P0);
+    srukf.setProcessModel(f, Q);
+    srukf.setMeasurementModel(h, R);
+
+    Eigen::VectorXd z(2);
+    auto run_ukf = [&] {
+        for (int k = 0; k < 10; ++k) {
+            z << 0.1 * k, -0.2 * k;
+            ukf.predict();
+            ukf.update(z);
+        }
+    };
+    EXPECT_THROW(run_ukf(), std::runtime_error);
+    for (int k = 0; k < 200; ++k) {
+        z << 0.1 * k, -0.2 * k;
+        srukf.predict();
+        srukf.update(z);
+    }
+    Eigen::VectorXd expected(4);
+    expected << 19.9, -39.8, 1.0, -2.0;
+    EXPECT_TRUE(srukf.state().isApprox(expected, 1e-6));
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(srukf.covariance());
+    EXPECT_GT(eigen.eigenvalues().minCoeff(), 0.0);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <Eigen/Dense>
+#include <track_manager.h>
+
+// 2D constant velocity targets observed in position
+static TrackManager makeManager() {
+    double dt = 0.1;
+    Eigen::MatrixXd A = Eigen::MatrixXd::Identity(4, 4);
+    A(0, 2) = dt;
+    A(1, 3) = dt;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 0.01 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.01 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::MatrixXd P = Eigen::Vector4d(0.1, 0.1, 1.0, 1.0).asDiagonal();
+    return TrackManager(A, C, Q, R, P);
+}
+
+// Targets on a 10 x 10 lattice, 5 units apart, moving with unit speed in x
+static Eigen::MatrixXd latticeDetections(int frame) {
+    Eigen::MatrixXd detections(100, 2);
+    for (int i = 0; i < 100; ++i) {
+        detections(i, 0) = 5.0 * (i % 10) + 0.1 * frame;
+        detections(i, 1) = 5.0 * (i / 10);
+    }
+    return detections;
+}
+
+TEST(TrackManagerTest, FollowsSeparatedTargetsWithStableIds) {
+    TrackManager manager = makeManager();
+    manager.step(latticeDetections(0));
+    ASSERT_EQ(manager.tracks().size(), 100u);
+    std::vector<long> first_ids = manager.detectionTracks();
+
+    for (int frame = 1; frame < 20; ++frame) {
+        manager.step(latticeDetections(frame));
+        // Gating only pairs each track with its own detection
+        EXPECT_EQ(manager.gatedPairs(), 100);
+    }
+    EXPECT_EQ(manager.tracks().size(), 100u);
+    EXPECT_EQ(manager.detectionTracks(), first_ids);
+    for (const Track& track : manager.tracks()) {
+        EXPECT_TRUE(manager.confirmed(track));
+        EXPECT_NEAR(manager.state(track)(2), 1.0, 0.1);
+        EXPECT_NEAR(manager.state(track)(3), 0.0, 0.1);
+    }
+}
+
+TEST(TrackManagerTest, AssignmentResolvesCompetingDetections) {
+    TrackManager manager = makeManager();
+    Eigen::MatrixXd detections(2, 2);
+    detections << 0.0, 0.0,
+                  0.3, 0.0;
+    for (int frame = 0; frame < 5; ++frame) {
+        manager.step(detections);
+    }
+    ASSERT_EQ(manager.tracks().size(), 2u);
+
+    // Both detections fall inside both gates; the optimal assignment keeps
+    // each track on the detection nearest to it
+    std::vector<long> before = manager.detectionTracks();
+    Eigen::MatrixXd shifted(2, 2);
+    shifted << 0.25, 0.0,
+               0.05, 0.0;
+    manager.step(shifted);
+    EXPECT_GT(manager.gatedPairs(), 2);
+    EXPECT_EQ(manager.detectionTracks()[1], before[0]);
+    EXPECT_EQ(manager.detectionTracks()[0], before[1]);
+}
+
+TEST(TrackManagerTest, TracksAreBornAndDie) {
+    TrackManager manager = makeManager();
+    Eigen::MatrixXd target(1, 2);
+    target << 0.0, 0.0;
+    for (int frame = 0; frame < 5; ++frame) {
+        manager.step(target);
+    }
+    ASSERT_EQ(manager.tracks().size(), 1u);
+    long id = manager.tracks()[0].id;
+
+    // A single clutter detection starts a tentative track that dies at its first miss
+    Eigen::MatrixXd with_clutter(2, 2);
+    with_clutter << 0.0, 0.0,
+                    20.0, 20.0;
+    manager.step(with_clutter);
+    EXPECT_EQ(manager.tracks().size(), 2u);
+    manager.step(target);
+    ASSERT_EQ(manager.tracks().size(), 1u);
+    EXPECT_EQ(manager.tracks()[0].id, id);
+
+    // The confirmed track survives max_misses empty frames, then dies
+    Eigen::MatrixXd none(0, 2);
+    for (int frame = 0; frame < TrackManagerConfig().max_misses; ++frame) {
+        manager.step(none);
+    }
+    EXPECT_EQ(manager.tracks().size(), 1u);
+    manager.step(none);
+    EXPECT_TRUE(manager.tracks().empty());
+}
@@ -1,6 +1,14 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <Eigen/Dense>
+#include <kalman_filter.h>
 #include <unscented_kalman_filter.h>
+#include <unscented_kalman_filter_t.h>
+#include "allocation_counter.h"
 
 TEST(UnscentedKalmanFilterTest, NonlinearPrediction) {
     int n = 2, m = 1;
@@ -30,4 +38,310 @@ TEST(UnscentedKalmanFilterTest, NonlinearPrediction) {
     Eigen::VectorXd x_pred = ukf.state();
     EXPECT_NEAR(x_pred(0), 1.0, 1e-6);
     EXPECT_NEAR(x_pred(1), 1.0, 1e-6);
-}
\ No newline at end of file
+}
+
+// Constant velocity in the plane, linear so the unscented transform is exact
+struct ConstantVelocity {
+    double dt;
+    void operator()(const Eigen::Vector4d& x, Eigen::Vector4d& fx) const {
+        fx << x(0) + dt * x(2), x(1) + dt * x(3), x(2), x(3);
+    }
+};
+
+struct PositionSensor {
+    void operator()(const Eigen::Vector4d& x, Eigen::Vector2d& z) const {
+        z = x.head<2>();
+    }
+};
+
+TEST(UnscentedKalmanFilterTest, StaticDispatchIsExactForLinearModels) {
+    using Filter = UnscentedKalmanFilterT<ConstantVelocity, PositionSensor, 4, 2>;
+    const double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::Vector4d x0(0, 0, 1, -1);
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    kf.init(x0);
+    // alpha = 1 keeps the weights well conditioned for the comparison
+    Filter ukf(ConstantVelocity{dt}, PositionSensor{}, x0, Eigen::Matrix4d::Identity(),
+               Q, R, 1.0, 2.0, 0.0);
+
+    Eigen::Vector2d z;
+    for (int k = 0; k < 30; ++k) {
+        z << 0.1 * k + 0.05 * std::sin(k), -0.1 * k;
+        kf.predict();
+        kf.update(z);
+        ukf.predict();
+        ukf.update(z);
+    }
+    EXPECT_TRUE(ukf.state().isApprox(kf.state(), 1e-9));
+    EXPECT_TRUE(ukf.covariance().isApprox(kf.covariance(), 1e-9));
+
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 100; ++k) {
+        ukf.predict();
+        ukf.update(z);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
+
+TEST(UnscentedKalmanFilterTest, InPlaceModelsMatchAndDoNotAllocate) {
+    const double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::VectorXd x0(4); x0 << 0, 0, 1, -1;
+    KalmanFilter kf(dt, A, C, Q, R, Eigen::MatrixXd::Identity(4, 4));
+    kf.init(x0);
+
+    UnscentedKalmanFilter returning(4, 2);
+    returning.initialize(x0, Eigen::MatrixXd::Identity(4, 4));
+    returning.setProcessModel([&A](const Eigen::VectorXd& x) { return Eigen::VectorXd(A * x); }, Q);
+    returning.setMeasurementModel([](const Eigen::VectorXd& x) { return Eigen::VectorXd(x.head(2)); }, R);
+    UnscentedKalmanFilter in_place(4, 2);
+    in_place.initialize(x0, Eigen::MatrixXd::Identity(4, 4));
+    in_place.setInPlaceProcessModel([&A](const Eigen::VectorXd& x, Eigen::VectorXd& fx) { fx.noalias() = A * x; }, Q);
+    in_place.setInPlaceMeasurementModel([](const Eigen::VectorXd& x, Eigen::VectorXd& z) { z = x.head(2); }, R);
+    in_place.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 30; ++k) {
+        z << 0.1 * k + 0.05 * std::sin(k), -0.1 * k;
+        kf.predict();
+        kf.update(z);
+        returning.predict();
+        returning.update(z);
+        in_place.predict();
+        in_place.update(z);
+    }
+    // Sigma points drawn from the predicted estimate make the update exact
+    // for a linear sensor
+    EXPECT_TRUE(returning.state().isApprox(kf.state(), 1e-6));
+    EXPECT_TRUE(returning.covariance().isApprox(kf.covariance(), 1e-6));
+    EXPECT_TRUE(in_place.state().isApprox(returning.state(), 1e-9));
+    EXPECT_TRUE(in_place.covariance().isApprox(returning.covariance(), 1e-9));
+
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 100; ++k) {
+        in_place.predict();
+        in_place.update(z);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
+
+// Coordinated turn [x, y, speed, heading, turn rate] on one point and on
+// all sigma points at once
+static void coordinatedTurn(const Eigen::VectorXd& s, Eigen::VectorXd& fx) {
+    const double dt = 0.1;
+    fx << s(0) + dt * s(2) * std::cos(s(3)),
+          s(1) + dt * s(2) * std::sin(s(3)),
+          s(2),
+          s(3) + dt * s(4),
+          s(4);
+}
+
+static void coordinatedTurnBatch(const Eigen::MatrixXd& S, Eigen::MatrixXd& out) {
+    const double dt = 0.1;
+    out = S;
+    for (Eigen::Index i = 0; i < S.cols(); ++i) {
+        out(0, i) += dt * S(2, i) * std::cos(S(3, i));
+        out(1, i) += dt * S(2, i) * std::sin(S(3, i));
+    }
+    out.row(3) += dt * S.row(4);
+}
+
+TEST(UnscentedKalmanFilterTest, BatchModelsMatchPerPointModels) {
+    Eigen::VectorXd x0(5); x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+    auto range_bearing = [](const Eigen::VectorXd& s, Eigen::VectorXd& z) {
+        z << std::hypot(s(0), s(1)), std::atan2(s(1), s(0));
+    };
+    auto range_bearing_batch = [](const Eigen::MatrixXd& S, Eigen::MatrixXd& Z) {
+        for (Eigen::Index i = 0; i < S.cols(); ++i) {
+            Z(0, i) = std::hypot(S(0, i), S(1, i));
+            Z(1, i) = std::atan2(S(1, i), S(0, i));
+        }
+    };
+
+    UnscentedKalmanFilter per_point(5, 2);
+    per_point.initialize(x0, P0);
+    per_point.setInPlaceProcessModel(coordinatedTurn, Q);
+    per_point.setInPlaceMeasurementModel(range_bearing, R);
+    UnscentedKalmanFilter batch(5, 2);
+    batch.initialize(x0, P0);
+    batch.setBatchProcessModel(coordinatedTurnBatch, Q);
+    batch.setBatchMeasurementModel(range_bearing_batch, R);
+    batch.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+    per_point.setUpdateStrategy({GainSolver::LLT, CovarianceUpdate::Symmetric});
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 20; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        per_point.predict();
+        per_point.update(z);
+        batch.predict();
+        batch.update(z);
+    }
+    EXPECT_TRUE(batch.state().isApprox(per_point.state(), 1e-12));
+    EXPECT_TRUE(batch.covariance().isApprox(per_point.covariance(), 1e-12));
+
+    std::size_t before = allocationCount();
+    for (int k = 0; k < 100; ++k) {
+        batch.predict();
+        batch.update(z);
+    }
+    EXPECT_EQ(allocationCount(), before);
+}
+
+TEST(UnscentedKalmanFilterTest, SigmaPointSchemesAreExactForLinearModels) {
+    const double dt = 0.1;
+    Eigen::MatrixXd A(4, 4);
+    A << 1, 0, dt, 0,
+         0, 1, 0, dt,
+         0, 0, 1, 0,
+         0, 0, 0, 1;
+    Eigen::MatrixXd C = Eigen::MatrixXd::Identity(2, 4);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(4, 4);
+    Eigen::MatrixXd R = 0.1 * Eigen::MatrixXd::Identity(2, 2);
+    Eigen::VectorXd x0(4); x0 << 0, 0, 1, -1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(4, 4);
+    P0(0, 2) = P0(2, 0) = 0.5;
+
+    const SigmaPointScheme schemes[] = {SigmaPointScheme::SphericalSimplex,
+                                        SigmaPointScheme::FifthDegreeCubature};
+    const int counts[] = {6, 33};
+    for (int s = 0; s < 2; ++s) {
+        KalmanFilter kf(dt, A, C, Q, R, P0);
+        kf.init(x0);
+        int evaluations = 0;
+        UnscentedKalmanFilter ukf(4, 2, schemes[s]);
+        EXPECT_EQ(ukf.sigmaPointCount(), counts[s]);
+        ukf.initialize(x0, P0);
+        ukf.setProcessModel([&A, &evaluations](const Eigen::VectorXd& x) {
+            ++evaluations;
+            return Eigen::VectorXd(A * x);
+        }, Q);
+        ukf.setMeasurementModel([](const Eigen::VectorXd& x) { return Eigen::VectorXd(x.head(2)); }, R);
+
+        Eigen::VectorXd z(2);
+        for (int k = 0; k < 30; ++k) {
+            z << 0.1 * k + 0.05 * std::sin(k), -0.1 * k;
+            kf.predict();
+            kf.update(z);
+            ukf.predict();
+            ukf.update(z);
+        }
+        EXPECT_EQ(evaluations, 30 * counts[s]);
+        EXPECT_TRUE(ukf.state().isApprox(kf.state(), 1e-10));
+        EXPECT_TRUE(ukf.covariance().isApprox(kf.covariance(), 1e-10));
+    }
+}
+
+TEST(UnscentedKalmanFilterTest, FifthDegreeCubatureCapturesHigherMoments) {
+    // E[sin(x)] = sin(mu) exp(-sigma^2 / 2) and E[cos(x)] = cos(mu) exp(-sigma^2 / 2)
+    const double variance = 0.5;
+    Eigen::VectorXd x0(2); x0 << 0.8, -0.4;
+    Eigen::MatrixXd P0 = variance * Eigen::MatrixXd::Identity(2, 2);
+    auto f = [](const Eigen::VectorXd& x) {
+        Eigen::VectorXd y(2);
+        y << std::sin(x(0)), std::cos(x(1));
+        return y;
+    };
+    Eigen::VectorXd expected(2);
+    expected << std::sin(0.8), std::cos(-0.4);
+    expected *= std::exp(-variance / 2);
+
+    double error[2];
+    const SigmaPointScheme schemes[] = {SigmaPointScheme::Scaled, SigmaPointScheme::FifthDegreeCubature};
+    for (int s = 0; s < 2; ++s) {
+        UnscentedKalmanFilter ukf(2, 1, schemes[s]);
+        ukf.initialize(x0, P0);
+        ukf.setProcessModel(f, Eigen::MatrixXd::Zero(2, 2));
+        ukf.predict();
+        error[s] = (ukf.state() - expected).norm();
+    }
+    EXPECT_LT(error[1], 1e-2);
+    EXPECT_LT(error[1], 0.1 * error[0]);
+}
+
+TEST(UnscentedKalmanFilterTest, ParallelSigmaPointsAreBitIdentical) {
+    Eigen::VectorXd x0(5); x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    Eigen::MatrixXd P0 = Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd Q = 1e-3 * Eigen::MatrixXd::Identity(5, 5);
+    Eigen::MatrixXd R = 1e-2 * Eigen::MatrixXd::Identity(2, 2);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    // Stands in for an expensive model such as an ODE solve
+    auto slow_turn = [&](const Eigen::VectorXd& s, Eigen::VectorXd& fx) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        coordinatedTurn(s, fx);
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    };
+    auto range_bearing = [](const Eigen::VectorXd& s) {
+        Eigen::VectorXd z(2);
+        z << std::hypot(s(0), s(1)), std::atan2(s(1), s(0));
+        return z;
+    };
+
+    UnscentedKalmanFilter serial(5, 2);
+    serial.initialize(x0, P0);
+    serial.setInPlaceProcessModel(slow_turn, Q);
+    serial.setMeasurementModel(range_bearing, R);
+    ThreadPool pool(4);
+    UnscentedKalmanFilter parallel(5, 2);
+    parallel.initialize(x0, P0);
+    parallel.setInPlaceProcessModel(slow_turn, Q);
+    parallel.setMeasurementModel(range_bearing, R);
+    parallel.setThreadPool(&pool, 0.0);
+
+    Eigen::VectorXd z(2);
+    for (int k = 0; k < 5; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        serial.predict();
+        serial.update(z);
+    }
+    threads.clear();
+    for (int k = 0; k < 5; ++k) {
+        z << std::sqrt(116.0) + 0.3 * k, -0.38 + 0.01 * k;
+        parallel.predict();
+        parallel.update(z);
+    }
+    EXPECT_GT(threads.size(), 1u);
+    EXPECT_EQ(parallel.state(), serial.state());
+    EXPECT_EQ(parallel.covariance(), serial.covariance());
+}
+
+TEST(UnscentedKalmanFilterTest, CheapModelsStayOnCallingThread) {
+    Eigen::VectorXd x0(5); x0 << 10.0, -4.0, 3.0, 0.7, 0.1;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    auto turn = [&mutex, &threads](const Eigen::VectorXd& s, Eigen::VectorXd& fx) {
+        coordinatedTurn(s, fx);
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    };
+    ThreadPool pool(4);
+    UnscentedKalmanFilter ukf(5, 2);
+    ukf.initialize(x0, Eigen::MatrixXd::Identity(5, 5));
+    ukf.setInPlaceProcessModel(turn, 1e-3 * Eigen::MatrixXd::Identity(5, 5));
+    ukf.setThreadPool(&pool);
+    for (int k = 0; k < 20; ++k) {
+        ukf.predict();
+    }
+    ASSERT_EQ(threads.size(), 1u);
+    EXPECT_EQ(*threads.begin(), std::this_thread::get_id());
+}